@@ -0,0 +1,73 @@
+#include "ds/ll.h"
+#include "ds/uba.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Measures the per-call cost of the hot accessors. Build once as is and once
+ * with -DENABLE_INLINE=OFF (and/or -DENABLE_IPO=ON) to compare.
+ *
+ * usage: access_bench [entries] [rounds]
+ * */
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return *(int *)k1 < *(int *)k2 ? -1 : *(int *)k1 > *(int *)k2;
+}
+
+void *entry_key(void *entry) {
+    return entry;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : 10;
+    uintptr_t sum = 0;
+    double start;
+
+    uba_t U = uba_new(n, false, NULL);
+    for (size_t i = 0; i < n; i++)
+        uba_push(U, (void *)(uintptr_t)i);
+
+    start = now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < uba_size(U); i++)
+            sum += (uintptr_t)uba_get(U, i);
+    }
+    printf("uba_get/uba_size: %.2f ns/op\n",
+           (now() - start) * 1e9 / (n * rounds));
+
+    start = now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < n; i++)
+            sum += uba_limit(U) > i;
+    }
+    printf("uba_limit:        %.2f ns/op\n",
+           (now() - start) * 1e9 / (n * rounds));
+
+    /* A small list keeps ll_valid cheap for the out-of-line build */
+    int k = 0;
+    ll_t L = ll_new(&key_cmp, &entry_key, NULL);
+    for (int i = 0; i < 16; i++)
+        ll_insert(L, &k);
+
+    start = now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < n; i++)
+            sum += ll_size(L) + !ll_empty(L);
+    }
+    printf("ll_size/ll_empty: %.2f ns/op\n",
+           (now() - start) * 1e9 / (n * rounds));
+
+    ll_free(L);
+    uba_free(U);
+
+    /* Keep the loops from being optimized away */
+    return sum == 42;
+}
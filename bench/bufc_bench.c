@@ -0,0 +1,146 @@
+#include "ds/bufc.h"
+#include "ds/ll.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Send messages of one small header and several body chunks over a local
+ * socketpair, either gathered straight from the chunks with bufc_writev or
+ * collected in an ll and copied into one buffer before write. A second
+ * thread drains the other end.
+ *
+ * usage: bufc_bench [messages] [chunks per message] [chunk bytes]
+ * */
+
+struct chunk {
+    void *data;
+    size_t len;
+};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return k1 != k2;
+}
+
+void *entry_key(void *entry) {
+    return entry;
+}
+
+static void *drain(void *arg) {
+    int fd = *(int *)arg;
+    char buf[65536];
+
+    while (read(fd, buf, sizeof(buf)) > 0)
+        ;
+    return NULL;
+}
+
+static void write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n <= 0)
+            abort();
+        buf += n;
+        len -= n;
+    }
+}
+
+struct copy_ctx {
+    char *buf;
+    size_t len;
+};
+
+static enum ll_traversalAction length_proc(void *entry, void *context) {
+    ((struct copy_ctx *)context)->len += ((struct chunk *)entry)->len;
+    return LL_TRAVERSAL_CONTINUE;
+}
+
+static enum ll_traversalAction copy_proc(void *entry, void *context) {
+    struct copy_ctx *C = context;
+    struct chunk *K = entry;
+
+    memcpy(C->buf + C->len, K->data, K->len);
+    C->len += K->len;
+    return LL_TRAVERSAL_CONTINUE;
+}
+
+static double run(bool gather, size_t msgs, struct chunk *body, size_t nchunks) {
+    static char header[64] = "POST /upload HTTP/1.1\r\n";
+    int fds[2];
+    pthread_t reader;
+
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    pthread_create(&reader, NULL, &drain, &fds[1]);
+
+    double start = now();
+    for (size_t m = 0; m < msgs; m++) {
+        if (gather) {
+            bufc_t B = bufc_new();
+            bufc_append_copy(B, header, sizeof(header));
+            for (size_t i = 0; i < nchunks; i++)
+                bufc_append(B, body[i].data, body[i].len, NULL);
+
+            while (bufc_len(B) > 0)
+                if (bufc_writev(B, fds[0]) <= 0)
+                    abort();
+            bufc_free(B);
+        } else {
+            ll_t L = ll_new(&key_cmp, &entry_key, NULL);
+            struct chunk head = { header, sizeof(header) };
+            ll_insert_tail(L, &head);
+            for (size_t i = 0; i < nchunks; i++)
+                ll_insert_tail(L, &body[i]);
+
+            struct copy_ctx C = { NULL, 0 };
+            ll_traverse(L, &length_proc, &C);
+            C.buf = malloc(C.len);
+            C.len = 0;
+            ll_traverse(L, &copy_proc, &C);
+
+            write_all(fds[0], C.buf, C.len);
+            free(C.buf);
+            ll_free(L);
+        }
+    }
+    double t = now() - start;
+
+    close(fds[0]);
+    pthread_join(reader, NULL);
+    close(fds[1]);
+    return t;
+}
+
+int main(int argc, char **argv) {
+    size_t msgs = argc > 1 ? strtoul(argv[1], NULL, 10) : 20000;
+    size_t nchunks = argc > 2 ? strtoul(argv[2], NULL, 10) : 16;
+    size_t chunk = argc > 3 ? strtoul(argv[3], NULL, 10) : 4096;
+    struct chunk *body = malloc(nchunks * sizeof(*body));
+
+    for (size_t i = 0; i < nchunks; i++) {
+        body[i].data = malloc(chunk);
+        body[i].len = chunk;
+        memset(body[i].data, 'a' + i % 26, chunk);
+    }
+
+    double mb = msgs * (64 + nchunks * chunk) / 1e6;
+    printf("%zu messages of 64 + %zu x %zu bytes\n", msgs, nchunks, chunk);
+
+    double t = run(false, msgs, body, nchunks);
+    printf("ll + copy + write  %8.2f ms  %8.1f MB/s\n", t * 1e3, mb / t);
+    t = run(true, msgs, body, nchunks);
+    printf("bufc_writev        %8.2f ms  %8.1f MB/s\n", t * 1e3, mb / t);
+
+    for (size_t i = 0; i < nchunks; i++)
+        free(body[i].data);
+    free(body);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include "ds/cmap.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Throughput of a mixed workload (90% cmap_get, 5% insert, 5% delete) from 1
+ * to N threads, once with a single shard (one global lock, the pattern cmap
+ * replaces) and once with the default sharding.
+ *
+ * usage: cmap_bench [max threads] [ops per thread]
+ * */
+
+#define KEYS (1 << 16)
+
+static int keys[KEYS];
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+uint64_t key_hash(void *key) {
+    return *(int *)key;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return *(int *)k1 < *(int *)k2 ? -1 : *(int *)k1 > *(int *)k2;
+}
+
+void *entry_key(void *entry) {
+    return entry;
+}
+
+struct worker {
+    cmap_t M;
+    unsigned seed;
+    long ops;
+    size_t hits;
+};
+
+static void *worker_run(void *arg) {
+    struct worker *W = arg;
+    uint64_t x = W->seed * 0x9e3779b97f4a7c15ull + 1;
+
+    for (long i = 0; i < W->ops; i++) {
+        /* xorshift64 */
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        int *k = &keys[x % KEYS];
+        unsigned op = (x >> 32) % 100;
+
+        if (op < 90)
+            W->hits += cmap_get(W->M, k) != NULL;
+        else if (op < 95)
+            cmap_insert(W->M, k);
+        else
+            cmap_del(W->M, k);
+    }
+    return NULL;
+}
+
+static double run(size_t nshards, int nthreads, long ops) {
+    cmap_t M = cmap_new(nshards, &key_hash, &key_cmp, &entry_key, NULL);
+    pthread_t threads[nthreads];
+    struct worker workers[nthreads];
+
+    for (int k = 0; k < KEYS; k += 2)
+        cmap_insert(M, &keys[k]);
+
+    double start = now();
+    for (int i = 0; i < nthreads; i++) {
+        workers[i] = (struct worker){ M, i + 1, ops, 0 };
+        pthread_create(&threads[i], NULL, &worker_run, &workers[i]);
+    }
+    for (int i = 0; i < nthreads; i++)
+        pthread_join(threads[i], NULL);
+    double elapsed = now() - start;
+
+    cmap_free(M);
+    return nthreads * ops / elapsed / 1e6;
+}
+
+int main(int argc, char **argv) {
+    int max = argc > 1 ? atoi(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+    long ops = argc > 2 ? atol(argv[2]) : 1000000;
+
+    for (int k = 0; k < KEYS; k++)
+        keys[k] = k;
+
+    printf("threads  1 shard (Mops/s)  %d shards (Mops/s)\n", CMAP_DEFAULT_SHARDS);
+    for (int t = 1; t <= max; t *= 2)
+        printf("%7d  %16.2f  %18.2f\n", t, run(1, t, ops), run(0, t, ops));
+
+    return 0;
+}
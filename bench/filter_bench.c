@@ -0,0 +1,117 @@
+#include "ds/filter.h"
+#include "ds/ll.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Reports false-positive rates and throughput of the filters, and the cost
+ * of ll_get misses with and without a filter on the list.
+ *
+ * usage: filter_bench [keys] [list entries]
+ * */
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return *(int *)k1 < *(int *)k2 ? -1 : *(int *)k1 > *(int *)k2;
+}
+
+void *entry_key(void *entry) {
+    return entry;
+}
+
+uint64_t key_hash(void *key) {
+    return *(int *)key;
+}
+
+static void bloom_bench(size_t n, size_t bits_per_key) {
+    bloom_t B = bloom_new(n, bits_per_key);
+    size_t hits = 0;
+    double start = now();
+
+    for (uint64_t k = 0; k < n; k++)
+        bloom_add(B, k);
+    double add = now() - start;
+
+    start = now();
+    for (uint64_t k = n; k < 2 * n; k++)
+        hits += bloom_test(B, k);
+    double test = now() - start;
+
+    printf("bloom  %2zu bits/key: fpr %6.3f%%  add %5.1f ns  test %5.1f ns\n",
+           bits_per_key, hits * 100.0 / n, add * 1e9 / n, test * 1e9 / n);
+    bloom_free(B);
+}
+
+static void cuckoo_bench(size_t n) {
+    cuckoo_t C = cuckoo_new(n);
+    size_t hits = 0;
+    double start = now();
+
+    for (uint64_t k = 0; k < n; k++)
+        cuckoo_add(C, k);
+    double add = now() - start;
+
+    start = now();
+    for (uint64_t k = n; k < 2 * n; k++)
+        hits += cuckoo_test(C, k);
+    double test = now() - start;
+
+    start = now();
+    for (uint64_t k = 0; k < n; k++)
+        cuckoo_del(C, k);
+    double del = now() - start;
+
+    printf("cuckoo 16-bit fp:    fpr %6.3f%%  add %5.1f ns  test %5.1f ns"
+           "  del %5.1f ns\n",
+           hits * 100.0 / n, add * 1e9 / n, test * 1e9 / n, del * 1e9 / n);
+    cuckoo_free(C);
+}
+
+static void ll_bench(int n) {
+    int *keys = malloc(sizeof(int) * n);
+    ll_t L = ll_new(&key_cmp, &entry_key, NULL);
+    size_t found = 0;
+    int lookups = 2000;
+
+    for (int i = 0; i < n; i++) {
+        keys[i] = i;
+        ll_insert(L, &keys[i]);
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        double start = now();
+        for (int i = 0; i < lookups; i++) {
+            /* 90% misses */
+            int k = i % 10 ? n + i : i % n;
+            found += ll_get(L, &k) != NULL;
+        }
+        printf("ll_get, %d entries, 90%% misses, %s: %8.1f ns/lookup\n",
+               n, pass ? "filter   " : "no filter", (now() - start) * 1e9 / lookups);
+
+        ll_set_filter(L, &key_hash);
+    }
+
+    ll_free(L);
+    free(keys);
+    if (found == 0)
+        puts("");
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    int list = argc > 2 ? atoi(argv[2]) : 10000;
+
+    bloom_bench(n, 8);
+    bloom_bench(n, 12);
+    bloom_bench(n, 16);
+    cuckoo_bench(n);
+    ll_bench(list);
+
+    return 0;
+}
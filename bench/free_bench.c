@@ -0,0 +1,110 @@
+#include "ds/ll.h"
+#include "ds/reclaim.h"
+#include "ds/uba.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Caller-side cost of dropping a large container: the blocking free, the
+ * async free (plus the time until the reclaimer is done) and the longest
+ * single step of the incremental free.
+ *
+ * usage: free_bench [entries] [step budget]
+ * */
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return *(int *)k1 < *(int *)k2 ? -1 : *(int *)k1 > *(int *)k2;
+}
+
+void *entry_key(void *entry) {
+    return entry;
+}
+
+static void *mkint(int i) {
+    int *tmp = malloc(sizeof(int));
+    *tmp = i;
+    return tmp;
+}
+
+static uba_t uba_build(size_t n) {
+    uba_t U = uba_new(n, false, &free);
+    for (size_t i = 0; i < n; i++)
+        uba_push(U, mkint(i));
+    return U;
+}
+
+static ll_t ll_build(size_t n) {
+    ll_t L = ll_new(&key_cmp, &entry_key, &free);
+    for (size_t i = 0; i < n; i++)
+        ll_insert(L, mkint(i));
+    return L;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    size_t budget = argc > 2 ? strtoul(argv[2], NULL, 10) : 4096;
+    double start, t;
+
+    printf("%zu entries, step budget %zu\n", n, budget);
+
+    uba_t U = uba_build(n);
+    start = now();
+    uba_free(U);
+    printf("uba_free        %9.3f ms\n", (now() - start) * 1e3);
+
+    U = uba_build(n);
+    start = now();
+    uba_free_async(U);
+    t = now() - start;
+    reclaim_drain();
+    printf("uba_free_async  %9.3f ms  (drained after %.1f ms)\n",
+           t * 1e3, (now() - start) * 1e3);
+
+    U = uba_build(n);
+    double worst = 0;
+    size_t steps = 0;
+    bool done;
+    do {
+        start = now();
+        done = uba_free_step(U, budget);
+        t = now() - start;
+        worst = t > worst ? t : worst;
+        steps++;
+    } while (!done);
+    printf("uba_free_step   %9.3f ms worst step over %zu steps\n",
+           worst * 1e3, steps);
+
+    ll_t L = ll_build(n);
+    start = now();
+    ll_free(L);
+    printf("ll_free         %9.3f ms\n", (now() - start) * 1e3);
+
+    L = ll_build(n);
+    start = now();
+    ll_free_async(L);
+    t = now() - start;
+    reclaim_drain();
+    printf("ll_free_async   %9.3f ms  (drained after %.1f ms)\n",
+           t * 1e3, (now() - start) * 1e3);
+
+    L = ll_build(n);
+    worst = 0;
+    steps = 0;
+    do {
+        start = now();
+        done = ll_free_step(L, budget);
+        t = now() - start;
+        worst = t > worst ? t : worst;
+        steps++;
+    } while (!done);
+    printf("ll_free_step    %9.3f ms worst step over %zu steps\n",
+           worst * 1e3, steps);
+
+    return 0;
+}
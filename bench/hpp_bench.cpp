@@ -0,0 +1,122 @@
+#include "ds/ll.hpp"
+#include "ds/uba.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <time.h>
+#include <vector>
+
+/* The C++ wrappers against the standard containers holding the same
+ * pointers: appends, a full walk and a sort (or a key lookup for the lists).
+ * ds::uba should match std::vector, and ds::ll std::list.
+ *
+ * usage: hpp_bench [entries] [rounds]
+ * */
+
+struct Item {
+    uint64_t key;
+};
+
+using by_key = ds::member_key<Item, uint64_t, &Item::key>;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool key_less(const Item *a, const Item *b) {
+    return a->key < b->key;
+}
+
+template <typename C>
+static void run_array(const char *name, std::vector<Item> &items, int rounds) {
+    double push = 0, walk = 0, sort = 0;
+    uint64_t sum = 0;
+
+    for (int r = 0; r < rounds; r++) {
+        C c;
+        double t0 = now();
+        for (Item &it : items)
+            c.push_back(&it);
+        double t1 = now();
+        for (Item *e : c)
+            sum += e->key;
+        double t2 = now();
+        std::sort(c.begin(), c.end(), &key_less);
+        double t3 = now();
+
+        push += t1 - t0;
+        walk += t2 - t1;
+        sort += t3 - t2;
+        sum += c[c.size() / 2]->key;
+    }
+
+    size_t ops = items.size() * rounds;
+    printf("%-12s push %6.2f ns  walk %6.2f ns  sort %8.2f ns  (per entry, %llu)\n",
+           name, push * 1e9 / ops, walk * 1e9 / ops, sort * 1e9 / ops,
+           (unsigned long long)sum % 10);
+}
+
+static Item *list_find(std::list<Item *> &l, uint64_t key) {
+    auto it = std::find_if(l.begin(), l.end(), [key](Item *e) { return e->key == key; });
+    return it == l.end() ? nullptr : *it;
+}
+
+static Item *list_find(ds::ll<Item, by_key> &l, uint64_t key) {
+    return l.get(key);
+}
+
+template <typename C>
+static void run_list(const char *name, std::vector<Item> &items, int rounds, size_t finds) {
+    double push = 0, walk = 0, find = 0;
+    uint64_t sum = 0, seed = 50;
+
+    for (int r = 0; r < rounds; r++) {
+        C c;
+        double t0 = now();
+        for (Item &it : items)
+            c.push_back(&it);
+        double t1 = now();
+        for (Item *e : c)
+            sum += e->key;
+        double t2 = now();
+        for (size_t i = 0; i < finds; i++) {
+            seed = seed * 6364136223846793005u + 1442695040888963407u;
+            Item *e = list_find(c, (seed >> 33) % items.size());
+            sum += e ? e->key : 0;
+        }
+        double t3 = now();
+
+        push += t1 - t0;
+        walk += t2 - t1;
+        find += t3 - t2;
+    }
+
+    size_t ops = items.size() * rounds;
+    printf("%-12s push %6.2f ns  walk %6.2f ns  find %8.2f us  (per entry/find, %llu)\n",
+           name, push * 1e9 / ops, walk * 1e9 / ops, find * 1e6 / (finds * rounds),
+           (unsigned long long)sum % 10);
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 5;
+    std::vector<Item> items(n ? n : 1);
+    uint64_t seed = 50;
+
+    for (size_t i = 0; i < items.size(); i++) {
+        seed = seed * 6364136223846793005u + 1442695040888963407u;
+        items[i].key = i;
+        std::swap(items[i].key, items[(seed >> 33) % (i + 1)].key);
+    }
+
+    printf("%zu entries, %d rounds\n", items.size(), rounds);
+    run_array<std::vector<Item *>>("std::vector", items, rounds);
+    run_array<ds::uba<Item>>("ds::uba", items, rounds);
+    run_list<std::list<Item *>>("std::list", items, rounds, 100);
+    run_list<ds::ll<Item, by_key>>("ds::ll", items, rounds, 100);
+    return 0;
+}
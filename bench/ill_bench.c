@@ -0,0 +1,98 @@
+#include "ds/ill.h"
+#include "ds/ll.h"
+#include <malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Heap footprint and speed of ll against the index-linked ill for the same
+ * list of pointer-sized entries: build, traverse, copy and tear down.
+ *
+ * usage: ill_bench [entries]
+ * */
+
+#define ENTRY(i) ((void *)(uintptr_t)(i))
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t heap_bytes(void) {
+    struct mallinfo2 m = mallinfo2();
+    return m.uordblks + m.hblkhd;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return (uintptr_t)k1 < (uintptr_t)k2 ? -1 : (uintptr_t)k1 > (uintptr_t)k2;
+}
+
+void *entry_key(void *entry) {
+    return entry;
+}
+
+enum ll_traversalAction sum_proc(void *entry, void *context) {
+    *(uintptr_t *)context += (uintptr_t)entry;
+    return LL_TRAVERSAL_CONTINUE;
+}
+
+enum ll_traversalAction copy_proc(void *entry, void *context) {
+    ll_insert_tail(context, entry);
+    return LL_TRAVERSAL_CONTINUE;
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    uintptr_t sum = 0;
+    double start;
+
+    printf("%zu entries\n", n);
+
+    size_t base = heap_bytes();
+    start = now();
+    ll_t L = ll_new(&key_cmp, &entry_key, NULL);
+    for (size_t i = 1; i <= n; i++)
+        ll_insert_tail(L, ENTRY(i));
+    printf("ll   build    %8.2f ms  %6.1f bytes/entry\n",
+           (now() - start) * 1e3, (double)(heap_bytes() - base) / n);
+
+    base = heap_bytes();
+    start = now();
+    ill_t I = ill_new(&key_cmp, &entry_key, NULL);
+    for (size_t i = 1; i <= n; i++)
+        ill_insert_tail(I, ENTRY(i));
+    printf("ill  build    %8.2f ms  %6.1f bytes/entry\n",
+           (now() - start) * 1e3, (double)(heap_bytes() - base) / n);
+
+    start = now();
+    ll_traverse(L, &sum_proc, &sum);
+    printf("ll   traverse %8.2f ms\n", (now() - start) * 1e3);
+    start = now();
+    ill_traverse(I, &sum_proc, &sum);
+    printf("ill  traverse %8.2f ms\n", (now() - start) * 1e3);
+
+    start = now();
+    ll_t LC = ll_new(&key_cmp, &entry_key, NULL);
+    ll_traverse(L, &copy_proc, LC);
+    printf("ll   copy     %8.2f ms\n", (now() - start) * 1e3);
+    start = now();
+    ill_t IC = ill_copy(I, NULL);
+    printf("ill  copy     %8.2f ms\n", (now() - start) * 1e3);
+
+    start = now();
+    while (!ll_empty(LC))
+        ll_del_head(LC);
+    ll_free(LC);
+    printf("ll   drain    %8.2f ms\n", (now() - start) * 1e3);
+    start = now();
+    while (!ill_empty(IC))
+        ill_del_head(IC);
+    ill_free(IC);
+    printf("ill  drain    %8.2f ms\n", (now() - start) * 1e3);
+
+    ll_free(L);
+    ill_free(I);
+    return sum == 0;
+}
@@ -0,0 +1,89 @@
+#include "ds/ll.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Traversal and lookup cost on a list whose nodes were scattered over the heap
+ * by churn, before and after ll_compact
+ *
+ * usage: ll_compact_bench [entries] [rounds]
+ * */
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return *(int *)k1 < *(int *)k2 ? -1 : *(int *)k1 > *(int *)k2;
+}
+
+void *entry_key(void *entry) {
+    return entry;
+}
+
+enum ll_traversalAction sum_proc(void *entry, void *context) {
+    *(long *)context += *(int *)entry;
+    return LL_TRAVERSAL_CONTINUE;
+}
+
+static void measure(ll_t L, const char *label, int n, int rounds) {
+    long sum = 0;
+    double start = now();
+
+    for (int r = 0; r < rounds; r++)
+        ll_traverse(L, &sum_proc, &sum);
+    double traverse = (now() - start) * 1e9 / ((double)n * rounds);
+
+    /* Absent key: a full walk through key_cmp */
+    int missing = -1;
+    start = now();
+    for (int r = 0; r < rounds; r++)
+        sum += ll_get(L, &missing) != NULL;
+    double get = (now() - start) * 1e9 / ((double)n * rounds);
+
+    printf("%-12s traverse %6.2f ns/node  ll_get miss %6.2f ns/node  (%ld)\n",
+           label, traverse, get, sum % 10);
+}
+
+enum ll_traversalAction drop_half(void *entry, void *context) {
+    (void)entry;
+    (void)context;
+    return rand() % 2 ? LL_TRAVERSAL_DELETE : LL_TRAVERSAL_CONTINUE;
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 10;
+    int *keys = malloc(sizeof(int) * n);
+    ll_t L = ll_new(&key_cmp, &entry_key, NULL);
+
+    for (int i = 0; i < n; i++) {
+        keys[i] = i;
+        ll_insert_tail(L, &keys[i]);
+    }
+
+    /* Churn: drop a random half, then refill at both ends so the new nodes
+     * land in the freed holes out of list order */
+    srand(6);
+    for (int churn = 0; churn < 8; churn++) {
+        ll_traverse(L, &drop_half, NULL);
+        while ((int)ll_size(L) < n) {
+            int *e = &keys[rand() % n];
+            if (rand() % 2)
+                ll_insert(L, e);
+            else
+                ll_insert_tail(L, e);
+        }
+    }
+
+    measure(L, "fragmented", n, rounds);
+    ll_compact(L);
+    measure(L, "compacted", n, rounds);
+
+    ll_free(L);
+    free(keys);
+    return 0;
+}
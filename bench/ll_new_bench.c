@@ -0,0 +1,59 @@
+#include "ds/ll.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Cost of creating, filling and destroying many small lists, on the heap with
+ * ll_new/ll_free and in caller storage with ll_init/ll_fini.
+ *
+ * usage: ll_new_bench [lists] [entries per list]
+ * */
+
+#define ENTRY(i) ((void *)(uintptr_t)(i))
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return (uintptr_t)k1 < (uintptr_t)k2 ? -1 : (uintptr_t)k1 > (uintptr_t)k2;
+}
+
+void *entry_key(void *entry) {
+    return entry;
+}
+
+int main(int argc, char **argv) {
+    size_t lists = argc > 1 ? strtoul(argv[1], NULL, 10) : 5000000;
+    size_t n = argc > 2 ? strtoul(argv[2], NULL, 10) : 2;
+    size_t found = 0;
+    double start;
+
+    printf("%zu lists of %zu entries\n", lists, n);
+
+    start = now();
+    for (size_t i = 0; i < lists; i++) {
+        ll_t L = ll_new(&key_cmp, &entry_key, NULL);
+        for (size_t j = 1; j <= n; j++)
+            ll_insert(L, ENTRY(j));
+        found += ll_get(L, ENTRY(1)) != NULL;
+        ll_free(L);
+    }
+    printf("ll_new/ll_free   %7.1f ns/list\n", (now() - start) * 1e9 / lists);
+
+    struct ll_Header H;
+    start = now();
+    for (size_t i = 0; i < lists; i++) {
+        ll_init(&H, &key_cmp, &entry_key, NULL);
+        for (size_t j = 1; j <= n; j++)
+            ll_insert(&H, ENTRY(j));
+        found += ll_get(&H, ENTRY(1)) != NULL;
+        ll_fini(&H);
+    }
+    printf("ll_init/ll_fini  %7.1f ns/list\n", (now() - start) * 1e9 / lists);
+
+    return found == SIZE_MAX;
+}
@@ -0,0 +1,104 @@
+#include "ds/ll.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* ll_get on Zipf-distributed keys under each ll_set_reorg policy. The list
+ * starts in random key order, so without reorganization a lookup walks half
+ * the list on average regardless of skew.
+ *
+ * usage: ll_reorg_bench [entries] [lookups] [zipf exponent]
+ * */
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return *(int *)k1 < *(int *)k2 ? -1 : *(int *)k1 > *(int *)k2;
+}
+
+void *entry_key(void *entry) {
+    return entry;
+}
+
+/* Draw ranks 0..n-1 with P(rank) proportional to 1 / (rank + 1)^s by binary
+ * search over the cumulative distribution */
+static int zipf_draw(const double *cdf, int n) {
+    double u = (double)rand() / ((double)RAND_MAX + 1);
+    int lo = 0, hi = n - 1;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (cdf[mid] < u)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+int main(int argc, char **argv) {
+    int n = argc > 1 ? atoi(argv[1]) : 10000;
+    int lookups = argc > 2 ? atoi(argv[2]) : 1000000;
+    double s = argc > 3 ? atof(argv[3]) : 1.0;
+
+    static const char *names[] = {
+        "none", "move-to-front", "transpose", "count",
+    };
+    int *keys = malloc(sizeof(int) * n);
+    int *order = malloc(sizeof(int) * n);
+    int *draws = malloc(sizeof(int) * lookups);
+    double *cdf = malloc(sizeof(double) * n);
+
+    /* Key k has popularity rank k */
+    double total = 0;
+    for (int k = 0; k < n; k++) {
+        keys[k] = k;
+        order[k] = k;
+        total += 1 / pow(k + 1, s);
+        cdf[k] = total;
+    }
+    for (int k = 0; k < n; k++)
+        cdf[k] /= total;
+
+    srand(7);
+    for (int i = n - 1; i > 0; i--) {
+        int j = rand() % (i + 1), tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    for (int i = 0; i < lookups; i++)
+        draws[i] = zipf_draw(cdf, n);
+
+    printf("%d entries, %d lookups, zipf s=%.2f\n", n, lookups, s);
+    for (int reorg = LL_REORG_NONE; reorg <= LL_REORG_COUNT; reorg++) {
+        ll_t L = ll_new(&key_cmp, &entry_key, NULL);
+        ll_set_reorg(L, reorg);
+        for (int i = 0; i < n; i++)
+            ll_insert_tail(L, &keys[order[i]]);
+
+        size_t found = 0;
+        double start = now();
+        for (int i = 0; i < lookups; i++)
+            found += ll_get(L, &keys[draws[i]]) != NULL;
+        double elapsed = now() - start;
+
+        printf("%-14s %8.1f ns/lookup", names[reorg], elapsed * 1e9 / lookups);
+#ifdef DS_STATS
+        printf("  %8.1f nodes/lookup",
+               (double)ll_stats(L).nodes_visited / lookups);
+#endif
+        printf("%s\n", found == (size_t)lookups ? "" : "  (missed keys!)");
+        ll_free(L);
+    }
+
+    free(cdf);
+    free(draws);
+    free(order);
+    free(keys);
+    return 0;
+}
@@ -0,0 +1,210 @@
+#define _GNU_SOURCE     /* pthread_setaffinity_np */
+#include "ds/ring.h"
+#include "ds/uba.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Producer/consumer throughput and round-trip latency between two threads
+ * pinned to different CPUs (the same one if there is only one). Compares the
+ * ring at several batch sizes with a mutex-protected uba used as a queue.
+ *
+ * usage: ring_bench [entries] [capacity]
+ * */
+
+#define ENTRY(i) ((void *)(uintptr_t)(i))
+#define ROUND_TRIPS 100000
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void pin(int cpu) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu % (cpus > 0 ? cpus : 1), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+/******************************************************************************/
+/*                                 Throughput                                 */
+/******************************************************************************/
+
+struct stage {
+    ring_t R;
+    size_t n;
+    size_t batch;
+
+    /* Baseline queue */
+    uba_t U;
+    size_t cap;
+    pthread_mutex_t lock;
+};
+
+static void *ring_consume(void *arg) {
+    struct stage *S = arg;
+    void *out[256];
+    size_t seen = 0, got;
+
+    pin(1);
+    while ((got = ring_pop_wait(S->R, out, S->batch)))
+        seen += got;
+    if (seen != S->n)
+        abort();
+    return NULL;
+}
+
+static double ring_throughput(size_t n, size_t cap, size_t batch) {
+    struct stage S = { .R = ring_new(cap, NULL), .n = n, .batch = batch };
+    void *in[256];
+    pthread_t consumer;
+
+    pthread_create(&consumer, NULL, &ring_consume, &S);
+    pin(0);
+
+    double start = now();
+    for (size_t i = 1; i <= n; i += batch) {
+        size_t m = n - i + 1 < batch ? n - i + 1 : batch;
+        for (size_t j = 0; j < m; j++)
+            in[j] = ENTRY(i + j);
+
+        size_t done = 0;
+        while ((done += ring_push_n(S.R, in + done, m - done)) < m)
+            sched_yield();
+    }
+    ring_close(S.R);
+    pthread_join(consumer, NULL);
+    double t = now() - start;
+
+    ring_free(S.R);
+    return n / t;
+}
+
+static void *uba_consume(void *arg) {
+    struct stage *S = arg;
+    size_t seen = 0;
+
+    pin(1);
+    while (seen < S->n) {
+        pthread_mutex_lock(&S->lock);
+        bool got = !uba_empty(S->U);
+        if (got)
+            uba_take(S->U, 0);
+        pthread_mutex_unlock(&S->lock);
+
+        if (got)
+            seen++;
+        else
+            sched_yield();
+    }
+    return NULL;
+}
+
+static double uba_throughput(size_t n, size_t cap) {
+    struct stage S = { .U = uba_new(cap + 1, false, NULL), .n = n, .cap = cap };
+    pthread_t consumer;
+
+    pthread_mutex_init(&S.lock, NULL);
+    pthread_create(&consumer, NULL, &uba_consume, &S);
+    pin(0);
+
+    double start = now();
+    for (size_t i = 1; i <= n;) {
+        pthread_mutex_lock(&S.lock);
+        bool room = uba_size(S.U) < S.cap;
+        if (room)
+            uba_push(S.U, ENTRY(i));
+        pthread_mutex_unlock(&S.lock);
+
+        if (room)
+            i++;
+        else
+            sched_yield();
+    }
+    pthread_join(consumer, NULL);
+    double t = now() - start;
+
+    pthread_mutex_destroy(&S.lock);
+    uba_free(S.U);
+    return n / t;
+}
+
+/******************************************************************************/
+/*                                  Latency                                   */
+/******************************************************************************/
+
+struct pingpong {
+    ring_t ping;
+    ring_t pong;
+};
+
+static void *echo(void *arg) {
+    struct pingpong *P = arg;
+    void *entry;
+
+    pin(1);
+    while (ring_pop_wait(P->ping, &entry, 1))
+        while (!ring_push(P->pong, entry))
+            ;
+    return NULL;
+}
+
+static void latency(void) {
+    struct pingpong P = { ring_new(64, NULL), ring_new(64, NULL) };
+    double *rtt = malloc(ROUND_TRIPS * sizeof(double));
+    pthread_t peer;
+    void *entry;
+
+    pthread_create(&peer, NULL, &echo, &P);
+    pin(0);
+
+    for (size_t i = 0; i < ROUND_TRIPS; i++) {
+        double start = now();
+        ring_push(P.ping, ENTRY(i + 1));
+        ring_pop_wait(P.pong, &entry, 1);
+        rtt[i] = now() - start;
+    }
+    ring_close(P.ping);
+    pthread_join(peer, NULL);
+
+    qsort(rtt, ROUND_TRIPS, sizeof(double), &cmp_double);
+    printf("round trip      p50 %8.0f ns  p99 %8.0f ns  max %8.0f ns\n",
+           rtt[ROUND_TRIPS / 2] * 1e9, rtt[ROUND_TRIPS * 99 / 100] * 1e9,
+           rtt[ROUND_TRIPS - 1] * 1e9);
+
+    free(rtt);
+    ring_free(P.ping);
+    ring_free(P.pong);
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    size_t cap = argc > 2 ? strtoul(argv[2], NULL, 10) : 1024;
+    size_t batches[] = { 1, 8, 64, 256 };
+
+    printf("%zu entries, capacity %zu, %ld cpus\n",
+           n, cap, sysconf(_SC_NPROCESSORS_ONLN));
+
+    /* The shifting uba_take(U, 0) makes the baseline O(depth) per pop */
+    printf("mutex + uba     %8.2f M entries/s\n",
+           uba_throughput(n / 10, cap) / 1e6);
+    for (size_t b = 0; b < sizeof(batches) / sizeof(*batches); b++)
+        printf("ring batch %-4zu %8.2f M entries/s\n",
+               batches[b], ring_throughput(n, cap, batches[b]) / 1e6);
+
+    latency();
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "ds/seq.h"
+#include "ds/ll.h"
+#include "ds/uba.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* A sequence whose workload changes: phases of random index reads alternate
+ * with phases of random middle inserts and removes. Runs on uba, on ll and
+ * on seq, which should follow each phase to the layout that suits it.
+ *
+ * usage: seq_bench [size] [operations per phase] [phases]
+ * */
+
+#define ENTRY(i) ((void *)(uintptr_t)(i))
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return k1 != k2;
+}
+
+void *entry_key(void *entry) {
+    return entry;
+}
+
+enum kind { KIND_UBA, KIND_LL, KIND_SEQ };
+
+static const char *names[] = { "uba", "ll", "seq" };
+
+static double run(enum kind kind, size_t n, size_t ops, int phases) {
+    uba_t U = NULL;
+    ll_t L = NULL;
+    seq_t S = NULL;
+    uintptr_t sum = 0;
+    uint64_t seed = 49;
+
+    if (kind == KIND_UBA)
+        U = uba_new(n + 1, false, NULL);
+    else if (kind == KIND_LL)
+        L = ll_new(&key_cmp, &entry_key, NULL);
+    else
+        S = seq_new(NULL);
+
+    for (size_t i = 1; i <= n; i++) {
+        if (U)
+            uba_push(U, ENTRY(i));
+        else if (L)
+            ll_insert_tail(L, ENTRY(i));
+        else
+            seq_push(S, ENTRY(i));
+    }
+
+    printf("%-4s", names[kind]);
+    double total = 0;
+    for (int p = 0; p < phases; p++) {
+        bool reads = p % 2 == 0;
+        double start = now();
+
+        for (size_t i = 0; i < ops; i++) {
+            seed = seed * 6364136223846793005u + 1442695040888963407u;
+            size_t index = 1 + (seed >> 33) % (n - 2);
+
+            if (reads) {
+                if (U)
+                    sum += (uintptr_t)uba_get(U, index);
+                else if (L)
+                    sum += (uintptr_t)ll_at(L, (int)index);
+                else
+                    sum += (uintptr_t)seq_get(S, index);
+            } else if (i % 2 == 0) {
+                if (U)
+                    uba_insert(U, index, ENTRY(i + 1));
+                else if (L)
+                    ll_insert_at(L, ENTRY(i + 1), (int)index);
+                else
+                    seq_insert(S, index, ENTRY(i + 1));
+            } else {
+                if (U)
+                    uba_remove(U, index);
+                else if (L)
+                    ll_del_at(L, (int)index);
+                else
+                    seq_remove(S, index);
+            }
+        }
+
+        double t = now() - start;
+        total += t;
+        printf("  %s %8.1f ns/op", reads ? "read" : "edit", t * 1e9 / ops);
+    }
+    printf("  total %8.1f ms\n", total * 1e3);
+
+    if (S) {
+        struct seq_Stats st = seq_stats(S);
+        printf("     seq conversions: %zu to chunked, %zu to array (0 without DS_STATS)\n",
+               st.to_chunked, st.to_array);
+        seq_free(S);
+    }
+    if (U)
+        uba_free(U);
+    if (L)
+        ll_free(L);
+    return total + (sum == 0);
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+    size_t ops = argc > 2 ? strtoul(argv[2], NULL, 10) : 20000;
+    int phases = argc > 3 ? atoi(argv[3]) : 4;
+
+    if (n < 3)
+        n = 3;
+    printf("%zu entries, %d phases of %zu operations\n", n, phases, ops);
+    run(KIND_UBA, n, ops, phases);
+    run(KIND_LL, n, ops, phases);
+    run(KIND_SEQ, n, ops, phases);
+    return 0;
+}
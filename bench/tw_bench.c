@@ -0,0 +1,158 @@
+#include "ds/tw.h"
+#include "ds/ll.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Connection timeouts: arm many timers with random delays, rearm every one
+ * of them once (traffic pushing the timeout back), cancel a tenth, then
+ * advance one tick at a time until all have fired. Runs on tw with the given
+ * number of timers, and on a sorted ll, where arming is an O(n) insert, with
+ * at most the given ll count.
+ *
+ * usage: tw_bench [timers] [ll timers] [max delay in ticks]
+ * */
+
+struct conn {
+    struct tw_Timer timer;
+    uint64_t expires;
+};
+
+static size_t expired;
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void on_expire(void *entry, struct tw_Timer *T) {
+    (void)entry, (void)T;
+    expired++;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return k1 != k2;
+}
+
+void *entry_key(void *entry) {
+    return entry;
+}
+
+struct find_ctx {
+    uint64_t expires;
+    int index;
+};
+
+static enum ll_traversalAction find_proc(void *entry, void *context) {
+    struct find_ctx *F = context;
+
+    if (((struct conn *)entry)->expires > F->expires)
+        return LL_TRAVERSAL_STOP;
+    F->index++;
+    return LL_TRAVERSAL_CONTINUE;
+}
+
+/* Insert C into L, kept sorted by expiry */
+static void ll_arm(ll_t L, struct conn *C, uint64_t expires) {
+    struct find_ctx F = { expires, 0 };
+
+    C->expires = expires;
+    ll_traverse(L, &find_proc, &F);
+    if ((size_t)F.index == ll_size(L))
+        ll_insert_tail(L, C);
+    else
+        ll_insert_at(L, C, F.index);
+}
+
+static void report(const char *name, size_t n, double arm, double rearm,
+                   double cancel, double run, uint64_t ticks) {
+    printf("%s: %zu timers\n", name, n);
+    printf("  schedule    %10.1f ns/timer\n", arm * 1e9 / n);
+    printf("  reschedule  %10.1f ns/timer\n", rearm * 1e9 / n);
+    printf("  cancel      %10.1f ns/timer\n", cancel * 1e9 / (n / 10));
+    printf("  expire      %10.1f ns/timer  %8.1f ns/tick  (%zu fired)\n",
+           run * 1e9 / expired, run * 1e9 / ticks, expired);
+}
+
+static void run_tw(struct conn *conns, size_t n, uint64_t delay) {
+    tw_t W = tw_new(0);
+    double t0, arm, rearm, cancel, run;
+
+    for (size_t i = 0; i < n; i++)
+        tw_timer_init(&conns[i].timer, &on_expire, &conns[i]);
+
+    t0 = now();
+    for (size_t i = 0; i < n; i++)
+        tw_schedule(W, &conns[i].timer, 1 + rand() % delay);
+    arm = now() - t0;
+
+    t0 = now();
+    for (size_t i = 0; i < n; i++)
+        tw_reschedule(W, &conns[i].timer, 1 + rand() % delay);
+    rearm = now() - t0;
+
+    t0 = now();
+    for (size_t i = 0; i < n; i += 10)
+        tw_cancel(W, &conns[i].timer);
+    cancel = now() - t0;
+
+    expired = 0;
+    t0 = now();
+    for (uint64_t t = 1; t <= delay; t++)
+        tw_advance(W, t);
+    run = now() - t0;
+
+    report("tw", n, arm, rearm, cancel, run, delay);
+    tw_free(W);
+}
+
+static void run_ll(struct conn *conns, size_t n, uint64_t delay) {
+    ll_t L = ll_new(&key_cmp, &entry_key, NULL);
+    double t0, arm, rearm, cancel, run;
+
+    t0 = now();
+    for (size_t i = 0; i < n; i++)
+        ll_arm(L, &conns[i], 1 + rand() % delay);
+    arm = now() - t0;
+
+    t0 = now();
+    for (size_t i = 0; i < n; i++) {
+        ll_del(L, &conns[i]);
+        ll_arm(L, &conns[i], 1 + rand() % delay);
+    }
+    rearm = now() - t0;
+
+    t0 = now();
+    for (size_t i = 0; i < n; i += 10)
+        ll_del(L, &conns[i]);
+    cancel = now() - t0;
+
+    expired = 0;
+    t0 = now();
+    for (uint64_t t = 1; t <= delay; t++) {
+        while (!ll_empty(L) && ((struct conn *)ll_at(L, 0))->expires <= t) {
+            struct conn *C = ll_take_head(L);
+            on_expire(C, &C->timer);
+        }
+    }
+    run = now() - t0;
+
+    report("sorted ll", n, arm, rearm, cancel, run, delay);
+    ll_free(L);
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t n_ll = argc > 2 ? strtoul(argv[2], NULL, 10) : 20000;
+    uint64_t delay = argc > 3 ? strtoull(argv[3], NULL, 10) : 60000;
+    struct conn *conns = malloc(n * sizeof(*conns));
+
+    srand(47);
+    run_tw(conns, n, delay);
+    run_ll(conns, n_ll < n ? n_ll : n, delay);
+
+    free(conns);
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "ds/uba_index.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Random lookups in a sorted uba of integer IDs: binary search over uba_data,
+ * uba_index_rank one key at a time, and uba_index_rank_n over all the keys.
+ *
+ * usage: uba_index_bench [queries] [size]...
+ * */
+
+#define ENTRY(i) ((void *)(uintptr_t)(i))
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t xorshift(uint64_t *s) {
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+static size_t lower_bound(void **a, size_t n, void *key) {
+    size_t lo = 0, hi = n;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if ((uintptr_t)a[mid] < (uintptr_t)key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static void run(size_t n, size_t q) {
+    uba_t U = uba_new(n + 1, false, NULL);
+    void **keys = malloc(q * sizeof(void *));
+    size_t *ranks = malloc(q * sizeof(size_t));
+    uint64_t seed = 48;
+    size_t sum1 = 0, sum2 = 0, sum3 = 0;
+    double start, t1, t2, t3, build;
+
+    for (size_t i = 0; i < n; i++)
+        uba_push(U, ENTRY(2 * i + 1));
+    for (size_t i = 0; i < q; i++)
+        keys[i] = ENTRY(xorshift(&seed) % (2 * n + 2));
+
+    start = now();
+    uba_index_t I = uba_build_index(U, NULL);
+    build = now() - start;
+
+    void **data = uba_data(U);
+    start = now();
+    for (size_t i = 0; i < q; i++)
+        sum1 += lower_bound(data, n, keys[i]);
+    t1 = now() - start;
+
+    start = now();
+    for (size_t i = 0; i < q; i++)
+        sum2 += uba_index_rank(I, keys[i]);
+    t2 = now() - start;
+
+    start = now();
+    uba_index_rank_n(I, keys, ranks, q);
+    for (size_t i = 0; i < q; i++)
+        sum3 += ranks[i];
+    t3 = now() - start;
+
+    printf("%10zu entries  build %7.1f ms\n", n, build * 1e3);
+    printf("  binary search     %7.1f ns/query\n", t1 * 1e9 / q);
+    printf("  uba_index_rank    %7.1f ns/query\n", t2 * 1e9 / q);
+    printf("  uba_index_rank_n  %7.1f ns/query%s\n", t3 * 1e9 / q,
+           sum1 == sum2 && sum2 == sum3 ? "" : "  MISMATCH");
+
+    uba_index_free(I);
+    uba_free(U);
+    free(keys);
+    free(ranks);
+}
+
+int main(int argc, char **argv) {
+    size_t q = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000000;
+
+    if (argc > 2) {
+        for (int i = 2; i < argc; i++)
+            run(strtoul(argv[i], NULL, 10), q);
+    } else {
+        run(1000000, q);
+        run(10000000, q);
+        run(100000000, q);
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "ds/uba_par.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Time uba_map_parallel, uba_reduce_parallel and uba_filter_parallel over one
+ * large uba on pools of 1 to N threads. Entries are integers stored in the
+ * pointer slots, so the numbers show the pool overhead plus a light
+ * per-entry workload rather than allocation costs.
+ *
+ * usage: uba_par_bench [max threads] [entries]
+ * */
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void *work(void *entry, void *context) {
+    (void)context;
+    /* A few dependent multiply-xorshift rounds */
+    uint64_t x = (uintptr_t)entry;
+    for (int i = 0; i < 8; i++) {
+        x *= 0x9e3779b97f4a7c15ull;
+        x ^= x >> 29;
+    }
+    return (void *)(uintptr_t)(x & 0xffffffff);
+}
+
+void fold(void *acc, void *entry, void *context) {
+    (void)context;
+    *(uint64_t *)acc += (uintptr_t)entry;
+}
+
+void combine(void *acc, void *other, void *context) {
+    (void)context;
+    *(uint64_t *)acc += *(uint64_t *)other;
+}
+
+bool odd(void *entry, void *context) {
+    (void)context;
+    return (uintptr_t)entry & 1;
+}
+
+int main(int argc, char **argv) {
+    int max = argc > 1 ? atoi(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+    size_t n = argc > 2 ? strtoul(argv[2], NULL, 10) : 10000000;
+
+    uba_t U = uba_new(n, false, NULL);
+    for (size_t i = 0; i < n; i++)
+        uba_push(U, (void *)(uintptr_t)i);
+
+    printf("threads   map (ms)  reduce (ms)  filter (ms)\n");
+    for (int t = 1; t <= max; t *= 2) {
+        pool_t P = pool_new(t);
+        uint64_t sum = 0;
+
+        double start = now();
+        uba_map_parallel(P, U, &work, NULL);
+        double map = now() - start;
+
+        start = now();
+        uba_reduce_parallel(P, U, &sum, sizeof(sum), &fold, &combine, NULL);
+        double reduce = now() - start;
+
+        start = now();
+        uba_t F = uba_filter_parallel(P, U, &odd, NULL, NULL);
+        double filter = now() - start;
+
+        printf("%7d  %9.1f  %11.1f  %11.1f   (sum %llu, kept %zu)\n", t,
+               map * 1e3, reduce * 1e3, filter * 1e3,
+               (unsigned long long)(sum & 0xffff), uba_size(F));
+        uba_free(F);
+        pool_free(P);
+    }
+
+    uba_free(U);
+    return 0;
+}
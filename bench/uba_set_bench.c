@@ -0,0 +1,121 @@
+#include "ds/uba_set.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Intersect and union sorted ID sets, with uba_intersect/uba_union and with
+ * the ad-hoc uba_get loop calling a comparator that they replace. Runs one
+ * balanced pair and one pair where A is much smaller than B.
+ *
+ * usage: uba_set_bench [balanced size] [small size] [large size]
+ * */
+
+#define ENTRY(i) ((void *)(uintptr_t)(i))
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int id_cmp(void *e1, void *e2) {
+    return (uintptr_t)e1 < (uintptr_t)e2 ? -1 : (uintptr_t)e1 > (uintptr_t)e2;
+}
+
+/* n ascending IDs with random gaps of 1..2 * gap */
+static uba_t ids(size_t n, size_t gap) {
+    uba_t U = uba_new(n + 1, false, NULL);
+    uintptr_t id = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        id += 1 + rand() % (2 * gap);
+        uba_push(U, ENTRY(id));
+    }
+    return U;
+}
+
+static void adhoc_intersect(uba_t R, uba_t A, uba_t B, uba_cmp_fn *cmp) {
+    size_t i = 0, j = 0;
+
+    while (i < uba_size(A) && j < uba_size(B)) {
+        int c = cmp(uba_get(A, i), uba_get(B, j));
+        if (c == 0)
+            uba_push(R, uba_get(A, i));
+        i += c <= 0;
+        j += c >= 0;
+    }
+}
+
+static void adhoc_union(uba_t R, uba_t A, uba_t B, uba_cmp_fn *cmp) {
+    size_t i = 0, j = 0;
+
+    while (i < uba_size(A) && j < uba_size(B)) {
+        int c = cmp(uba_get(A, i), uba_get(B, j));
+        uba_push(R, c <= 0 ? uba_get(A, i) : uba_get(B, j));
+        i += c <= 0;
+        j += c >= 0;
+    }
+    for (; i < uba_size(A); i++)
+        uba_push(R, uba_get(A, i));
+    for (; j < uba_size(B); j++)
+        uba_push(R, uba_get(B, j));
+}
+
+typedef void set_fn(uba_t R, uba_t A, uba_t B, uba_cmp_fn *cmp);
+
+/* Best of three runs into a reused, preallocated R */
+static double run(set_fn *fn, uba_t A, uba_t B, uba_cmp_fn *cmp, size_t *out) {
+    uba_t R = uba_new(uba_size(A) + uba_size(B) + 1, false, NULL);
+    double best = 1e9;
+
+    for (int rep = 0; rep < 3; rep++) {
+        R->size = 0;
+        double start = now();
+        fn(R, A, B, cmp);
+        double t = now() - start;
+        best = t < best ? t : best;
+    }
+    *out = uba_size(R);
+    uba_free(R);
+    return best;
+}
+
+static void report(const char *name, uba_t A, uba_t B) {
+    size_t n1, n2, n3, n4;
+
+    printf("%s: %zu x %zu\n", name, uba_size(A), uba_size(B));
+    double t1 = run(&adhoc_intersect, A, B, &id_cmp, &n1);
+    double t2 = run(&uba_intersect, A, B, &id_cmp, &n2);
+    double t3 = run(&uba_intersect, A, B, NULL, &n3);
+    printf("  intersect ad-hoc        %8.2f ms  (%zu)\n", t1 * 1e3, n1);
+    printf("  uba_intersect cmp       %8.2f ms  (%zu)\n", t2 * 1e3, n2);
+    printf("  uba_intersect NULL      %8.2f ms  (%zu)\n", t3 * 1e3, n3);
+
+    t1 = run(&adhoc_union, A, B, &id_cmp, &n1);
+    t2 = run(&uba_union, A, B, &id_cmp, &n2);
+    t3 = run(&uba_union, A, B, NULL, &n4);
+    printf("  union ad-hoc            %8.2f ms  (%zu)\n", t1 * 1e3, n1);
+    printf("  uba_union cmp           %8.2f ms  (%zu)\n", t2 * 1e3, n2);
+    printf("  uba_union NULL          %8.2f ms  (%zu)\n", t3 * 1e3, n4);
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+    size_t small = argc > 2 ? strtoul(argv[2], NULL, 10) : 1000;
+    size_t large = argc > 3 ? strtoul(argv[3], NULL, 10) : 10000000;
+
+    srand(46);
+    uba_t A = ids(n, 2), B = ids(n, 2);
+    report("balanced", A, B);
+    uba_free(A);
+    uba_free(B);
+
+    A = ids(small, 2 * large / (small ? small : 1));
+    B = ids(large, 2);
+    report("skewed", A, B);
+    uba_free(A);
+    uba_free(B);
+
+    return 0;
+}
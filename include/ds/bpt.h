@@ -0,0 +1,144 @@
+#pragma once
+#ifndef BPT_H
+#define BPT_H
+
+#include "ds/ll.h"
+#include "ds/uba.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* Entries are described with the ll callbacks:
+ *
+ * ll_key_cmp_fn orders keys, ll_entry_key_fn returns a pointer to an entry's
+ * key (it must stay valid while the entry is in the tree) and ll_entry_free_fn
+ * frees an entry.
+ * */
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+typedef struct bpt_Header *bpt_t;
+
+/* Keys per node; nodes are cache-line aligned and hold keys next to each
+ * other so a lookup touches few lines per level */
+#define BPT_ORDER 32
+
+struct bpt_Node;
+
+struct bpt_Header {
+    struct bpt_Node *root;
+
+    size_t size;
+    size_t height;  /* 1 when the root is a leaf */
+
+    ll_key_cmp_fn *key_cmp;
+    ll_entry_key_fn *entry_key;
+    ll_entry_free_fn *entry_free;
+};
+
+/* Position in a range scan, filled in by bpt_range */
+struct bpt_Cursor {
+    bpt_t T;
+    struct bpt_Node *leaf;
+    int index;
+
+    void *end;  /* Last key of the range in scan direction, NULL if unbounded */
+    bool rev;
+};
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* ====== Init and Teardown ====== */
+
+/* Initialize new, empty tree
+ *
+ * requires: key_cmp != NULL && entry_key != NULL
+ * ensures: rv != NULL && bpt_empty(rv)
+ * */
+bpt_t bpt_new(ll_key_cmp_fn *key_cmp,
+              ll_entry_key_fn *entry_key,
+              ll_entry_free_fn *entry_free);
+
+/* Build a tree in O(n) from the entries of U, which must be sorted by key with
+ * no duplicates. The tree refers to the entries but not to U; U must not free
+ * them as well.
+ *
+ * requires: U != NULL && !uba_raw(U) && key_cmp != NULL && entry_key != NULL
+ * ensures: rv != NULL && bpt_size(rv) == uba_size(U)
+ * */
+bpt_t bpt_from_uba(uba_t U,
+                   ll_key_cmp_fn *key_cmp,
+                   ll_entry_key_fn *entry_key,
+                   ll_entry_free_fn *entry_free);
+
+/* Free tree alongside entries if entry_free is defined
+ *
+ * requires: T != NULL
+ * */
+void bpt_free(bpt_t T);
+
+/* ====== Accessors ====== */
+
+/* Returns entry with key or NULL if it doesn't exist
+ *
+ * requires: T != NULL
+ * */
+void *bpt_get(bpt_t T, void *key);
+
+/* Returns number of entries in tree
+ *
+ * requires: T != NULL
+ * */
+size_t bpt_size(bpt_t T);
+
+/* Returns boolean indicating whether tree is empty
+ *
+ * requires: T != NULL
+ * */
+bool bpt_empty(bpt_t T);
+
+/* Start a scan over entries with lo <= key <= hi, ascending or (rev) descending.
+ * A NULL bound leaves that side of the range open. The cursor is invalidated by
+ * any insertion or deletion.
+ *
+ * requires: T != NULL && C != NULL
+ * */
+void bpt_range(bpt_t T, struct bpt_Cursor *C, void *lo, void *hi, bool rev);
+
+/* Returns the next entry of the scan or NULL once the range is exhausted
+ *
+ * requires: C != NULL && C was set up by bpt_range
+ * */
+void *bpt_next(struct bpt_Cursor *C);
+
+/* ====== Mutators ====== */
+
+/* Insert entry; returns 0 on success and 1 (leaving T unchanged) if an entry
+ * with the same key exists
+ *
+ * requires: T != NULL && entry != NULL
+ * */
+int bpt_insert(bpt_t T, void *entry);
+
+/* Delete entry with key; returns 0 on success and 1 if there is none
+ *
+ * requires: T != NULL
+ * */
+int bpt_del(bpt_t T, void *key);
+
+/* Find entry with key and replace it with new_entry, which must have an equal
+ * key, freeing the old entry if the free_old flag is set. Returns old entry if
+ * free_old is not set, NULL if there is no entry with key.
+ *
+ * requires: T != NULL && new_entry != NULL
+ * */
+void *bpt_update(bpt_t T, void *key, void *new_entry, bool free_old);
+
+#endif
@@ -0,0 +1,174 @@
+#pragma once
+#ifndef BUFC_H
+#define BUFC_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* Release bytes handed to bufc_append or bufc_prepend once no chain refers to
+ * them any more
+ *
+ * requires: data != NULL
+ * */
+typedef void bufc_release_fn(void *data);
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+typedef struct bufc_Header *bufc_t;
+
+/* Smallest segment bufc_append_copy allocates; later small copies fill its
+ * slack instead of adding segments */
+#define BUFC_MIN_SEG 4096
+
+/* Most iovecs bufc_writev hands to one writev call */
+#define BUFC_IOV_MAX 64
+
+/* Reference-counted bytes shared by every view on them. Segments made by
+ * bufc_append_copy and bufc_readv hold their bytes inline and may have slack
+ * after fill. */
+struct bufc_Seg {
+    atomic_size_t refs;
+    unsigned char *data;
+    size_t cap;
+    size_t fill;
+    bufc_release_fn *release;
+    unsigned char bytes[];
+};
+
+/* A run of bytes [off, off + len) of one segment */
+struct bufc_View {
+    struct bufc_View *next;
+    struct bufc_Seg *seg;
+    size_t off;
+    size_t len;
+};
+
+struct bufc_Header {
+    struct bufc_View *head;
+    struct bufc_View *tail;
+    size_t len;         /* Bytes over all views */
+    size_t nviews;
+};
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* ====== Init and Teardown ====== */
+
+/* Return an empty chain
+ *
+ * ensures: rv != NULL && bufc_len(rv) == 0
+ * */
+bufc_t bufc_new(void);
+
+/* Free B, releasing segments no other chain refers to
+ *
+ * requires: B != NULL
+ * */
+void bufc_free(bufc_t B);
+
+/* ====== Accessors ====== */
+
+/* Return number of bytes in B
+ *
+ * requires: B != NULL
+ * */
+size_t bufc_len(bufc_t B);
+
+/* Return number of segment views in B, i.e. the iovecs it exports
+ *
+ * requires: B != NULL
+ * */
+size_t bufc_views(bufc_t B);
+
+/* Copy up to len bytes starting at byte off of B into dst and return the
+ * number copied
+ *
+ * requires: B != NULL && (dst != NULL || len == 0) && off <= bufc_len(B)
+ * */
+size_t bufc_peek(bufc_t B, size_t off, void *dst, size_t len);
+
+/* Fill iov with up to max views from the head of B, for writev, and return
+ * the number filled
+ *
+ * requires: B != NULL && (iov != NULL || max == 0)
+ * */
+size_t bufc_iovec(bufc_t B, struct iovec *iov, size_t max);
+
+/* ====== Building ====== */
+
+/* Append len bytes at data without copying them. B takes ownership; release
+ * (if not NULL) runs on data once no chain refers to it.
+ *
+ * requires: B != NULL && data != NULL && 0 < len
+ * */
+void bufc_append(bufc_t B, void *data, size_t len, bufc_release_fn *release);
+
+/* Prepend len bytes at data without copying them, like bufc_append
+ *
+ * requires: B != NULL && data != NULL && 0 < len
+ * */
+void bufc_prepend(bufc_t B, void *data, size_t len, bufc_release_fn *release);
+
+/* Append a copy of len bytes at data, into the slack of the last segment if
+ * B alone owns it. Meant for small pieces such as headers.
+ *
+ * requires: B != NULL && (data != NULL || len == 0)
+ * */
+void bufc_append_copy(bufc_t B, const void *data, size_t len);
+
+/* Move every byte of C to the end of B in O(1), leaving C empty
+ *
+ * requires: B != NULL && C != NULL && B != C
+ * ensures: bufc_len(C) == 0
+ * */
+void bufc_concat(bufc_t B, bufc_t C);
+
+/* Return a new chain with the first n bytes of B and keep the rest in B. A
+ * segment straddling the cut is shared, not copied.
+ *
+ * requires: B != NULL && n <= bufc_len(B)
+ * ensures: bufc_len(rv) == n
+ * */
+bufc_t bufc_split(bufc_t B, size_t n);
+
+/* Return a new chain sharing bytes [off, off + len) of B; B is unchanged
+ *
+ * requires: B != NULL && off + len <= bufc_len(B)
+ * ensures: bufc_len(rv) == len
+ * */
+bufc_t bufc_slice(bufc_t B, size_t off, size_t len);
+
+/* Drop the first n bytes of B. Every fully dropped view costs O(1).
+ *
+ * requires: B != NULL && n <= bufc_len(B)
+ * */
+void bufc_consume(bufc_t B, size_t n);
+
+/* ====== I/O ====== */
+
+/* writev as much of B to fd as it takes and consume what was written. Returns
+ * the writev result: bytes written, or -1 with errno set.
+ *
+ * requires: B != NULL && 0 <= fd
+ * */
+ssize_t bufc_writev(bufc_t B, int fd);
+
+/* readv up to max bytes from fd into the slack of the last segment and a new
+ * segment, appending what arrived. Returns the readv result.
+ *
+ * requires: B != NULL && 0 <= fd && 0 < max
+ * */
+ssize_t bufc_readv(bufc_t B, int fd, size_t max);
+
+#endif
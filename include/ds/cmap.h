@@ -0,0 +1,145 @@
+#pragma once
+#ifndef CMAP_H
+#define CMAP_H
+
+#include "ds/ll.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* Entries are described with the ll callbacks plus a hash:
+ *
+ * ll_key_hash_fn hashes a key (keys that compare equal must hash equal),
+ * ll_key_cmp_fn compares keys for equality, ll_entry_key_fn returns a pointer
+ * to an entry's key and ll_entry_free_fn frees an entry.
+ *
+ * Every function but cmap_new and cmap_free may be called from any number of
+ * threads at once.
+ * */
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+typedef struct cmap_Header *cmap_t;
+
+/* Shards used when cmap_new is passed 0 */
+#define CMAP_DEFAULT_SHARDS 64
+
+struct cmap_Node;
+
+/* Each shard is a chained hash table behind its own lock, on its own cache
+ * line. A shard grows by allocating a table twice the size and moving a few
+ * buckets of the old one on every later insert or delete, so no single call
+ * pays for rehashing the whole shard. */
+struct cmap_Shard {
+    pthread_mutex_t lock;
+
+    struct cmap_Node **table;
+    size_t mask;            /* Number of buckets - 1 */
+    size_t size;
+
+    struct cmap_Node **old; /* Table being migrated, NULL if none */
+    size_t old_mask;
+    size_t migrated;        /* Buckets of old below this are empty */
+} __attribute__((aligned(64)));
+
+struct cmap_Header {
+    struct cmap_Shard *shards;
+    size_t shard_mask;      /* Number of shards - 1 */
+
+    ll_key_hash_fn *key_hash;
+    ll_key_cmp_fn *key_cmp;
+    ll_entry_key_fn *entry_key;
+    ll_entry_free_fn *entry_free;
+};
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* ====== Init and Teardown ====== */
+
+/* Initialize new, empty map with nshards shards (rounded up to a power of two,
+ * CMAP_DEFAULT_SHARDS if 0). More shards mean fewer threads contending for
+ * one lock.
+ *
+ * requires: key_hash != NULL && key_cmp != NULL && entry_key != NULL
+ * ensures: rv != NULL && cmap_size(rv) == 0
+ * */
+cmap_t cmap_new(size_t nshards,
+                ll_key_hash_fn *key_hash,
+                ll_key_cmp_fn *key_cmp,
+                ll_entry_key_fn *entry_key,
+                ll_entry_free_fn *entry_free);
+
+/* Free map alongside entries if entry_free is defined. No other thread may be
+ * using M.
+ *
+ * requires: M != NULL
+ * */
+void cmap_free(cmap_t M);
+
+/* ====== Accessors ====== */
+
+/* Returns entry with key or NULL if it doesn't exist. A concurrent cmap_del or
+ * cmap_update may free the entry; use cmap_visit to work on entries that other
+ * threads can remove.
+ *
+ * requires: M != NULL
+ * */
+void *cmap_get(cmap_t M, void *key);
+
+/* Run p on the entry with key while no other thread can change it, deleting
+ * the entry if p returns LL_TRAVERSAL_DELETE. Returns 0 if the entry was found
+ * and 1 otherwise. p must not call back into M.
+ *
+ * requires: M != NULL && p != NULL
+ * */
+int cmap_visit(cmap_t M, void *key, ll_proc_fn *p, void *context);
+
+/* Run p on every entry, one shard at a time, until it returns
+ * LL_TRAVERSAL_STOP; entries for which p returns LL_TRAVERSAL_DELETE are
+ * deleted. p must not call back into M.
+ *
+ * requires: M != NULL && p != NULL
+ * */
+void cmap_traverse(cmap_t M, ll_proc_fn *p, void *context);
+
+/* Returns number of entries in map. Under concurrent mutation this is a
+ * snapshot of each shard taken at slightly different times.
+ *
+ * requires: M != NULL
+ * */
+size_t cmap_size(cmap_t M);
+
+/* ====== Mutators ====== */
+
+/* Insert entry; returns 0 on success and 1 (leaving M unchanged) if an entry
+ * with the same key exists
+ *
+ * requires: M != NULL && entry != NULL
+ * */
+int cmap_insert(cmap_t M, void *entry);
+
+/* Delete entry with key, freeing it if entry_free is defined; returns 0 on
+ * success and 1 if there is none
+ *
+ * requires: M != NULL
+ * */
+int cmap_del(cmap_t M, void *key);
+
+/* Find entry with key and replace it with new_entry, which must have an equal
+ * key, freeing the old entry if the free_old flag is set. Returns old entry if
+ * free_old is not set, NULL if there is no entry with key.
+ *
+ * requires: M != NULL && new_entry != NULL
+ * */
+void *cmap_update(cmap_t M, void *key, void *new_entry, bool free_old);
+
+#endif
@@ -0,0 +1,129 @@
+#pragma once
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* Both filters take 64-bit key hashes and answer "definitely absent" or
+ * "possibly present". Hashes are remixed internally, but keys that hash
+ * equal are the same key as far as a filter can tell.
+ * */
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+typedef struct bloom_Header *bloom_t;
+typedef struct cuckoo_Header *cuckoo_t;
+
+/* Split-block Bloom filter: each key sets one bit in each of the eight 32-bit
+ * words of a single 32-byte block, so a lookup touches one cache line and the
+ * word loop maps onto one SIMD operation */
+#define BLOOM_BLOCK_WORDS 8
+
+struct bloom_Header {
+    uint32_t (*blocks)[BLOOM_BLOCK_WORDS];
+    size_t nblocks;
+};
+
+/* Cuckoo filter: 16-bit fingerprints in 4-way buckets; each key has two
+ * candidate buckets. A fingerprint that could not be placed is kept in victim
+ * so nothing is ever lost. */
+#define CUCKOO_BUCKET_SLOTS 4
+
+struct cuckoo_Header {
+    uint16_t (*buckets)[CUCKOO_BUCKET_SLOTS];
+    size_t mask;    /* Number of buckets - 1 */
+    size_t size;
+
+    bool has_victim;
+    uint16_t victim_fp;
+    size_t victim_index;
+};
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* ====== Bloom ====== */
+
+/* Return an empty Bloom filter sized for capacity keys at bits_per_key bits
+ * each (10 bits give roughly a 1% false-positive rate)
+ *
+ * requires: 0 < bits_per_key
+ * ensures: rv != NULL
+ * */
+bloom_t bloom_new(size_t capacity, size_t bits_per_key);
+
+/* Free B
+ *
+ * requires: B != NULL
+ * */
+void bloom_free(bloom_t B);
+
+/* Add key with hash to B
+ *
+ * requires: B != NULL
+ * */
+void bloom_add(bloom_t B, uint64_t hash);
+
+/* Return false if no key with hash was added to B
+ *
+ * requires: B != NULL
+ * */
+bool bloom_test(bloom_t B, uint64_t hash);
+
+/* Remove every key from B
+ *
+ * requires: B != NULL
+ * */
+void bloom_clear(bloom_t B);
+
+/* ====== Cuckoo ====== */
+
+/* Return an empty cuckoo filter with room for at least capacity keys
+ *
+ * ensures: rv != NULL && cuckoo_size(rv) == 0
+ * */
+cuckoo_t cuckoo_new(size_t capacity);
+
+/* Free C
+ *
+ * requires: C != NULL
+ * */
+void cuckoo_free(cuckoo_t C);
+
+/* Add key with hash to C. Return 0 on success and 1 if C is full, in which
+ * case C is unchanged.
+ *
+ * requires: C != NULL
+ * */
+int cuckoo_add(cuckoo_t C, uint64_t hash);
+
+/* Return false if no key with hash is in C
+ *
+ * requires: C != NULL
+ * */
+bool cuckoo_test(cuckoo_t C, uint64_t hash);
+
+/* Remove one key with hash from C. Return 0 on success and 1 if there is none.
+ * Only remove keys that were added: removing an absent key that shares a
+ * fingerprint with a present one makes the present one disappear.
+ *
+ * requires: C != NULL
+ * */
+int cuckoo_del(cuckoo_t C, uint64_t hash);
+
+/* Return number of keys in C
+ *
+ * requires: C != NULL
+ * */
+size_t cuckoo_size(cuckoo_t C);
+
+#endif
@@ -0,0 +1,214 @@
+#pragma once
+#ifndef ILL_H
+#define ILL_H
+
+#include "ds/ll.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* ill reuses the callbacks of ll.h: ll_key_cmp_fn, ll_entry_key_fn,
+ * ll_entry_free_fn and ll_proc_fn (with its ll_traversalAction results).
+ * */
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+typedef struct ill_Header *ill_t;
+
+/* Largest number of entries an ill can hold (slot 0 is the sentinel) */
+#define ILL_MAX (UINT32_MAX - 1)
+
+/* A node linked to its neighbours by their slot in the node array. Free slots
+ * are chained through next. */
+struct ill_Node {
+    void *entry;
+    uint32_t next;
+    uint32_t prev;
+};
+
+struct ill_Header {
+    /* nodes[0] is the sentinel: its next is the head, its prev the tail */
+    struct ill_Node *nodes;
+    uint32_t limit;     /* Slots allocated */
+    uint32_t used;      /* Slots handed out at least once */
+    uint32_t free;      /* Top of the free slot stack, 0 if empty */
+
+    size_t size;
+
+    ll_key_cmp_fn *key_cmp;
+    ll_entry_key_fn *entry_key;
+    ll_entry_free_fn *entry_free;
+};
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* ====== Init and Teardown ====== */
+
+/* Initialize new index-linked list: the same verbs as ll, but every node lives
+ * in one growable array and links to its neighbours by 32-bit slot numbers
+ *
+ * requires: key_cmp != NULL && entry_key != NULL
+ * ensures: rv != NULL
+ * */
+ill_t ill_new(ll_key_cmp_fn *key_cmp,
+              ll_entry_key_fn *entry_key,
+              ll_entry_free_fn *entry_free);
+
+/* Free list alongside entries if entry_free is defined
+ *
+ * requires: L != NULL
+ * */
+void ill_free(ill_t L);
+
+/* Return a copy of L made with one memcpy of its node array. Entries are
+ * shared with L, so at most one of the two lists should have an entry_free.
+ *
+ * requires: L != NULL
+ * ensures: rv != NULL && ill_size(rv) == ill_size(L)
+ * */
+ill_t ill_copy(ill_t L, ll_entry_free_fn *entry_free);
+
+/* Move the nodes into list order and shrink the node array to them, so
+ * traversal walks memory sequentially and freed slots are returned
+ *
+ * requires: L != NULL
+ * ensures: ill_size(L) is unchanged
+ * */
+void ill_shrink(ill_t L);
+
+/* ====== Accessors ====== */
+
+/* Returns entry with key or NULL if it doesn't exist
+ *
+ * requires: L != NULL
+ * */
+void *ill_get(ill_t L, void *key);
+
+/* Returns entry at index
+ *
+ * requires: L != NULL && ((0 <= index && index < ill_size(L))
+ *                          || (index < 0 && -index <= ill_size(L)))
+ * */
+void *ill_at(ill_t L, int index);
+
+/* Returns amount of entries in list
+ *
+ * requires: L != NULL
+ * */
+size_t ill_size(ill_t L);
+
+/* Returns whether list is empty
+ *
+ * requires: L != NULL
+ * ensures: (rv && ill_size(L) == 0) || (!rv && ill_size(L) > 0)
+ * */
+bool ill_empty(ill_t L);
+
+/* Traverses L from head, calling p and passing each entry and the context to p
+ *
+ * requires: L != NULL && p != NULL
+ * */
+void ill_traverse(ill_t L, ll_proc_fn *p, void *context);
+
+/* Traverses L from tail, calling p and passing each entry and the context to p
+ *
+ * requires: L != NULL && p != NULL
+ * */
+void ill_traverse_rev(ill_t L, ll_proc_fn *p, void *context);
+
+/* ====== Mutators ====== */
+
+/* Insert entry at head
+ *
+ * requires: L != NULL && entry != NULL && ill_size(L) < ILL_MAX
+ * ensures: !ill_empty(L)
+ * */
+void ill_insert(ill_t L, void *entry);
+
+/* Insert entry at tail
+ *
+ * requires: L != NULL && entry != NULL && ill_size(L) < ILL_MAX
+ * ensures: !ill_empty(L)
+ * */
+int ill_insert_tail(ill_t L, void *entry);
+
+/* Insert entry in front of the node at index, thereby occupying the index.
+ * Allows for negative indexing where -1 is the tail node.
+ *
+ * requires: L != NULL && entry != NULL && ill_size(L) < ILL_MAX
+ *              && ((0 <= index && index < ill_size(L))
+ *              || (index < 0 && -index <= ill_size(L)))
+ * ensures: !ill_empty(L)
+ * */
+int ill_insert_at(ill_t L, void *entry, int index);
+
+/* Searches from head and deletes first entry with key. Returns 0 if an entry
+ * was deleted and 1 otherwise.
+ *
+ * requires: L != NULL
+ * */
+int ill_del(ill_t L, void *key);
+
+/* Searches from tail and deletes first entry with key, like ill_del
+ *
+ * requires: L != NULL
+ * */
+int ill_del_rev(ill_t L, void *key);
+
+/* Delete entry at head
+ *
+ * requires: L != NULL && !ill_empty(L)
+ * */
+int ill_del_head(ill_t L);
+
+/* Delete entry at tail
+ *
+ * requires: L != NULL && !ill_empty(L)
+ * */
+int ill_del_tail(ill_t L);
+
+/* Delete entry at index. Allows for negative indexing where -1 is the tail.
+ *
+ * requires: L != NULL && ((0 <= index && index < ill_size(L))
+ *              || (index < 0 && -index <= ill_size(L)))
+ * */
+int ill_del_at(ill_t L, int index);
+
+/* Remove entry at head and return it without freeing it
+ *
+ * requires: L != NULL && !ill_empty(L)
+ * */
+void *ill_take_head(ill_t L);
+
+/* Remove entry at index and return it without freeing it
+ *
+ * requires: L != NULL && ((0 <= index && index < ill_size(L))
+ *              || (index < 0 && -index <= ill_size(L)))
+ * */
+void *ill_take_at(ill_t L, int index);
+
+/* Find entry with key and replace it with new_entry, freeing the old entry if
+ * the free_old flag is set. Returns old entry if free_old is not set, NULL if
+ * there is no entry with key.
+ *
+ * requires: L != NULL && new_entry != NULL
+ * */
+void *ill_update(ill_t L, void *key, void *new_entry, bool free_old);
+
+/* Replace entry at index with new_entry, like ill_update
+ *
+ * requires: L != NULL && new_entry != NULL
+ *              && ((0 <= index && index < ill_size(L))
+ *              || (index < 0 && -index <= ill_size(L)))
+ * */
+void *ill_update_at(ill_t L, int index, void *new_entry, bool free_old);
+
+#endif
@@ -2,8 +2,15 @@
 #ifndef LL_H
 #define LL_H
 
+#include <assert.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /******************************************************************************/
 /*                              Client Interface                              */
@@ -27,6 +34,12 @@ typedef int ll_key_cmp_fn(void *k1, void *k2);
  * */
 typedef void *ll_entry_key_fn(void *entry);
 
+/* Takes a key and returns its hash; keys that compare equal hash equal
+ *
+ * requires: key != NULL
+ * */
+typedef uint64_t ll_key_hash_fn(void *key);
+
 /* Frees a given entry
  *
  * requires entry != NULL
@@ -40,28 +53,90 @@ typedef void ll_entry_free_fn(void *entry);
  * */
 typedef enum ll_traversalAction ll_proc_fn(void *entry, void *context);
 
+/* Writes entry into buf if it needs at most len bytes and returns the number
+ * of bytes the serialized entry needs (buf may be NULL when len == 0).
+ *
+ * requires: entry != NULL
+ * */
+typedef size_t ll_entry_serialize_fn(void *entry, void *buf, size_t len);
+
+/* Turns a serialized entry back into an entry. payload is 8-byte aligned and
+ * stays mapped (and writable) until the list is freed, so returning payload
+ * itself loads the entry without copying it.
+ *
+ * requires: payload != NULL
+ * */
+typedef void *ll_entry_deserialize_fn(void *payload, size_t len);
+
 /******************************************************************************/
 /*                               Implementation                               */
 /******************************************************************************/
 
 typedef struct ll_Header *ll_t;
 
+/* Operation counters, only maintained when built with DS_STATS */
+struct ll_Stats {
+    size_t allocs;          /* Heap allocations (header and nodes) */
+    size_t bytes;           /* Bytes currently held by the list */
+    size_t nodes_visited;   /* Nodes stepped over by ll_node_at/ll_find_node */
+    size_t key_cmps;        /* Calls to key_cmp */
+    size_t traversal_dels;  /* Nodes deleted through LL_TRAVERSAL_DELETE */
+};
+
+/* How ll_get and ll_update reorder a list around the node they find */
+enum ll_reorg {
+    LL_REORG_NONE,
+    LL_REORG_MOVE_TO_FRONT,     /* Move the node to the head */
+    LL_REORG_TRANSPOSE,         /* Swap the node with its predecessor */
+    LL_REORG_COUNT,             /* Keep nodes ordered by lookup count */
+};
+
 struct ll_Node {
     void *entry;
     struct ll_Node *next;
     struct ll_Node *prev;
 };
 
+/* Node of a list made by ll_new_hashed or kept under LL_REORG_COUNT. The list
+ * links &base like any other node, so only those lists pay for the extra
+ * fields. */
+struct ll_HNode {
+    struct ll_Node base;
+    uint32_t fp;        /* Key fingerprint, set in lists made by ll_new_hashed */
+    uint32_t count;     /* Lookups, kept under LL_REORG_COUNT */
+};
+
 struct ll_Header {
-    /* Points to dummy nodes */
-    struct ll_Node *head;
-    struct ll_Node *tail;
+    /* Sentinels, head.next is the first node and tail.prev the last */
+    struct ll_Node head;
+    struct ll_Node tail;
 
     size_t size;
 
     ll_key_cmp_fn *key_cmp;
     ll_entry_key_fn *entry_key;
     ll_entry_free_fn *entry_free;
+
+    /* Key hash behind the node fingerprints (see ll_new_hashed) and the
+     * membership filter (see ll_set_filter) */
+    ll_key_hash_fn *key_hash;
+    bool fingerprints;
+    struct cuckoo_Header *filter;
+
+    /* See ll_set_reorg */
+    enum ll_reorg reorg;
+
+    /* File mapping backing nodes and entries of a list made by ll_load */
+    void *map;
+    size_t map_len;
+
+    /* Contiguous node array made by ll_compact, block_len bytes long */
+    void *block;
+    size_t block_len;
+
+#ifdef DS_STATS
+    struct ll_Stats stats;
+#endif
 };
 
 /******************************************************************************/
@@ -72,7 +147,7 @@ struct ll_Header {
 
 /* ====== Init and Teardown ====== */
 
-/* Initialize new linked list
+/* Initialize new linked list with one allocation
  *
  * ensures: rv != NULL
  * */
@@ -80,15 +155,129 @@ ll_t ll_new(ll_key_cmp_fn *key_cmp,
             ll_entry_key_fn *entry_key,
             ll_entry_free_fn *entry_free);
 
+/* Initialize an empty linked list in caller-provided storage, e.g. a struct
+ * ll_Header embedded in another struct; nothing is allocated until the first
+ * insert. The sentinels live inside *L, so L must not be moved or copied
+ * while in use (ll_swap is fine). Release it with ll_fini, not ll_free.
+ *
+ * requires: L != NULL && key_cmp != NULL && entry_key != NULL
+ * */
+void ll_init(ll_t L,
+             ll_key_cmp_fn *key_cmp,
+             ll_entry_key_fn *entry_key,
+             ll_entry_free_fn *entry_free);
+
+/* Initialize new linked list whose nodes cache a 32-bit fingerprint of their
+ * key, taken from key_hash on insertion and update. Key lookups (ll_get,
+ * ll_del, ll_del_rev, ll_update) then only call entry_key and key_cmp on
+ * nodes whose fingerprint matches. Keys that compare equal must hash equal.
+ *
+ * requires: key_hash != NULL
+ * ensures: rv != NULL
+ * */
+ll_t ll_new_hashed(ll_key_cmp_fn *key_cmp,
+                   ll_entry_key_fn *entry_key,
+                   ll_entry_free_fn *entry_free,
+                   ll_key_hash_fn *key_hash);
+
 /* Free linked list alongside entries if free_entries_fn is defined
  *
- * requires: L != NULL
+ * requires: L != NULL && L was not set up with ll_init
  * */
 void ll_free(ll_t L);
 
+/* Free the nodes of a list set up with ll_init, alongside entries if
+ * entry_free is defined, but not L itself. L may be passed to ll_init again.
+ *
+ * requires: L != NULL
+ * */
+void ll_fini(ll_t L);
+
+/* Hand L to the background reclaimer thread (see reclaim.h), which frees it
+ * like ll_free in batches. Returns at once; L must not be used afterwards.
+ *
+ * requires: L != NULL && L was not set up with ll_init
+ * */
+void ll_free_async(ll_t L);
+
+/* Free up to budget entries of L and, once none are left, L itself. Returns
+ * true when L is gone. Lets a single-threaded caller spread ll_free over many
+ * bounded steps.
+ *
+ * requires: L != NULL && 0 < budget && L was not set up with ll_init
+ * */
+bool ll_free_step(ll_t L, size_t budget);
+
+/* Exchange the contents of A and B (nodes, callbacks, filter, reorg policy
+ * and counters) in O(1), without copying or freeing any entry
+ *
+ * requires: A != NULL && B != NULL
+ * */
+void ll_swap(ll_t A, ll_t B);
+
+/* Keep a cuckoo filter over the keys of L so that ll_get, ll_del, ll_del_rev
+ * and ll_update on an absent key usually return without walking the list.
+ * Passing NULL drops the filter. On a list made by ll_new_hashed, key_hash
+ * also replaces the fingerprint hash. The filter switches itself off if more than
+ * eight entries share a key.
+ *
+ * requires: L != NULL
+ * */
+void ll_set_filter(ll_t L, ll_key_hash_fn *key_hash);
+
+/* Make ll_get and ll_update reorganize L around the node they find so that
+ * frequently looked up keys drift toward the head: move it to the front,
+ * swap it with its predecessor, or keep nodes ordered by lookup count.
+ * Lookups from the tail (ll_del_rev) and positional access leave the order
+ * alone. New lists use LL_REORG_NONE; switching a list to LL_REORG_COUNT
+ * starts every count at zero. Counts live in ll_HNodes, which only lists made
+ * by ll_new_hashed have from the start, so any other list must be empty to
+ * switch to or from LL_REORG_COUNT.
+ *
+ * requires: L != NULL
+ *     && (ll_empty(L) || L->fingerprints
+ *         || (reorg == LL_REORG_COUNT) == (L->reorg == LL_REORG_COUNT))
+ * */
+void ll_set_reorg(ll_t L, enum ll_reorg reorg);
+
+/* Move every node of L into one contiguous array in list order, so traversal
+ * walks memory sequentially again after heavy insert/delete churn. Entries
+ * are not touched. Slots of nodes deleted afterwards are only reclaimed by
+ * the next ll_compact or ll_free.
+ *
+ * requires: L != NULL
+ * ensures: ll_size(L) is unchanged
+ * */
+void ll_compact(ll_t L);
+
+/* ====== Persistence ====== */
+
+/* Write L to a versioned, checksummed binary file at path using ser to
+ * serialize each entry. Returns 0 on success and 1 on failure.
+ *
+ * requires: L != NULL && path != NULL && ser != NULL
+ * */
+int ll_save(ll_t L, const char *path, ll_entry_serialize_fn *ser);
+
+/* Map a file written by ll_save and build a list over it: nodes live inside
+ * the mapping and deser sees each payload in place. The mapping is released by
+ * ll_free, so entry_free must not free entries that point into it. Returns
+ * NULL if the file cannot be read, was written by an incompatible build or
+ * fails its checksum.
+ *
+ * requires: path != NULL && deser != NULL && key_cmp != NULL
+ *              && entry_key != NULL
+ * */
+ll_t ll_load(const char *path,
+             ll_entry_deserialize_fn *deser,
+             ll_key_cmp_fn *key_cmp,
+             ll_entry_key_fn *entry_key,
+             ll_entry_free_fn *entry_free);
+
 /* ====== Accessors ====== */
 
-/* Returns entry with key or NULL if it doesn't exist
+/* Returns entry with key or NULL if it doesn't exist. Reorders L according
+ * to its ll_set_reorg policy.
  *
  * requires: L != NULL
  * */
@@ -116,6 +305,23 @@ size_t ll_size(ll_t L);
  * */
 bool ll_empty(ll_t L);
 
+/* Returns the operation counters of L (all zero unless built with DS_STATS)
+ *
+ * requires: L != NULL
+ * */
+struct ll_Stats ll_stats(ll_t L);
+
+/* Returns the counters aggregated over every list (all zero unless built with
+ * DS_STATS). bytes only accounts for lists that have not been freed.
+ * */
+struct ll_Stats ll_stats_global(void);
+
+/* Writes the aggregated counters to f in human-readable form
+ *
+ * requires: f != NULL
+ * */
+void ll_stats_dump(FILE *f);
+
 /* Traverses L from head, calling p and passing each node and the context to p
  *
  * requires: L != NULL && p != NULL
@@ -200,8 +406,28 @@ int ll_del_tail(ll_t L);
  * */
 int ll_del_at(ll_t L, int index);
 
+/* Remove entry at head and return it without freeing it; the caller owns the
+ * entry. Entries of a list made by ll_load stay valid only while it lives.
+ *
+ * requires: L != NULL && !ll_empty(L)
+ * ensures: L != NULL
+ * */
+void *ll_take_head(ll_t L);
+
+/* Remove entry at index and return it without freeing it, like ll_take_head
+ *
+ * Allows for negative indexing where -1 is the tail node.
+ *
+ * requires: L != NULL && !ll_empty(L)
+ *              && ((0 <= index && index < ll_size(L))
+ *              || (index < 0 && abs(index) <= ll_size(L)))
+ * ensures: L != NULL
+ * */
+void *ll_take_at(ll_t L, int index);
+
 /* Find entry with key and replace it with new_entry, freeing the old entry if
- * the free_old flag is set. Returns old entry if free_old is not set.
+ * the free_old flag is set. Returns old entry if free_old is not set, NULL if
+ * there is no entry with key.
  *
  * requires: L != NULL && new_entry != NULL
  *              && entry_key != NULL && key_cmp != NULL
@@ -223,4 +449,46 @@ void *ll_update_at(ll_t L,
                    void *new_entry,
                    bool free_old);
 
+/* Insert entry in front of node N, which may be &L->tail to append, and
+ * return the new node. O(1), for callers that walk the nodes themselves.
+ *
+ * requires: L != NULL && entry != NULL && N is a node of L or &L->tail
+ * ensures: rv->entry == entry && rv->next == N
+ * */
+struct ll_Node *ll_insert_before(ll_t L, struct ll_Node *N, void *entry);
+
+/* Remove (and free) the entry of node N and return the node that followed
+ * it, &L->tail if N was the last. O(1).
+ *
+ * requires: L != NULL && N is a node of L
+ * */
+struct ll_Node *ll_erase(ll_t L, struct ll_Node *N);
+
+/******************************************************************************/
+/*                                 Fast Paths                                 */
+/******************************************************************************/
+
+/* The hot accessors expand inline unless DS_NO_INLINE is defined. The
+ * out-of-line functions stay exported either way. Unlike them, the inline
+ * versions skip the O(n) ll_valid check.
+ * */
+#ifndef DS_NO_INLINE
+static inline size_t ll_size_inline(ll_t L) {
+    assert(L != NULL);
+    return L->size;
+}
+
+static inline bool ll_empty_inline(ll_t L) {
+    assert(L != NULL);
+    return !L->size;
+}
+
+#define ll_size(L) ll_size_inline(L)
+#define ll_empty(L) ll_empty_inline(L)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
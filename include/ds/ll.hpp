@@ -0,0 +1,192 @@
+#pragma once
+#ifndef LL_HPP
+#define LL_HPP
+
+#include "ds/ll.h"
+#include "ds/policy.hpp"
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* ds::ll<T, KeyOf, Free> owns an ll_t of T * entries. It is movable but not
+ * copyable (see clone), and its iterators are bidirectional, so it works
+ * with <algorithm>. Dereferencing one gives a proxy that converts to T * and
+ * can be assigned a T *, since the node stores a void *. Lookups go through
+ * the KeyOf policy inline rather than through the key_cmp pointer of the
+ * list; the thunks handed to ll_new serve the C functions called on
+ * handle(), whose keys are the address of a key_type, or the key itself when
+ * KeyOf::key returns a pointer by value (ptr_key). A moved-from list may
+ * only be destroyed or assigned to.
+ * */
+
+namespace ds {
+
+template <typename T, typename KeyOf = ptr_key<T>, typename Free = no_free>
+class ll {
+public:
+    /* The entry of a node, read and written as a T * */
+    class reference {
+    public:
+        explicit reference(struct ll_Node *N) : N_(N) {}
+
+        operator T *() const { return static_cast<T *>(N_->entry); }
+        T *operator->() const { return *this; }
+
+        reference &operator=(T *entry) { N_->entry = entry; return *this; }
+        reference &operator=(const reference &o) { N_->entry = o.N_->entry; return *this; }
+
+        friend void swap(reference a, reference b) { std::swap(a.N_->entry, b.N_->entry); }
+
+    private:
+        struct ll_Node *N_;
+    };
+
+    class iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T *;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = ll::reference;
+
+        iterator() = default;
+        explicit iterator(struct ll_Node *N) : N_(N) {}
+
+        reference operator*() const { return reference(N_); }
+
+        iterator &operator++() { N_ = N_->next; return *this; }
+        iterator &operator--() { N_ = N_->prev; return *this; }
+        iterator operator++(int) { iterator it = *this; N_ = N_->next; return it; }
+        iterator operator--(int) { iterator it = *this; N_ = N_->prev; return it; }
+
+        bool operator==(const iterator &o) const { return N_ == o.N_; }
+        bool operator!=(const iterator &o) const { return N_ != o.N_; }
+
+        struct ll_Node *node() const { return N_; }
+
+    private:
+        struct ll_Node *N_ = nullptr;
+    };
+
+    /* ====== Init and Teardown ====== */
+
+    ll() : L_(ll_new(&cmp_thunk, &key_thunk, Free::frees ? &free_thunk : nullptr)) {}
+
+    ~ll() {
+        if (L_)
+            ll_free(L_);
+    }
+
+    ll(ll &&o) noexcept : L_(std::exchange(o.L_, nullptr)) {}
+
+    ll &operator=(ll &&o) noexcept {
+        if (this != &o) {
+            if (L_)
+                ll_free(L_);
+            L_ = std::exchange(o.L_, nullptr);
+        }
+        return *this;
+    }
+
+    ll(const ll &) = delete;
+    ll &operator=(const ll &) = delete;
+
+    /* Return a list holding the same entries. Only lists that do not own
+     * their entries can share them. */
+    ll clone() const {
+        static_assert(!Free::frees, "entries owned by one list cannot be shared");
+        ll copy;
+        for (T *entry : *this)
+            copy.push_back(entry);
+        return copy;
+    }
+
+    /* ====== Accessors ====== */
+
+    iterator begin() const { return iterator(L_->head.next); }
+    iterator end() const { return iterator(&L_->tail); }
+
+    size_t size() const { return ll_size(L_); }
+    bool empty() const { return ll_empty(L_); }
+
+    T *front() const { assert(!empty()); return static_cast<T *>(L_->head.next->entry); }
+    T *back() const { assert(!empty()); return static_cast<T *>(L_->tail.prev->entry); }
+
+    /* Return the first entry whose key compares equal to key, end() if none */
+    iterator find(const typename KeyOf::key_type &key) const {
+        for (struct ll_Node *N = L_->head.next; N != &L_->tail; N = N->next) {
+            if (KeyOf::compare(key, KeyOf::key(static_cast<T *>(N->entry))) == 0)
+                return iterator(N);
+        }
+        return end();
+    }
+
+    /* Return the entry found by find, nullptr if none */
+    T *get(const typename KeyOf::key_type &key) const {
+        iterator it = find(key);
+        return it == end() ? nullptr : static_cast<T *>(*it);
+    }
+
+    ll_t handle() const { return L_; }
+
+    /* ====== Modifiers ====== */
+
+    void push_front(T *entry) { ll_insert(L_, entry); }
+    void push_back(T *entry) { ll_insert_tail(L_, entry); }
+    void pop_front() { ll_del_head(L_); }
+    void pop_back() { ll_del_tail(L_); }
+
+    /* Insert entry before pos and return an iterator to it */
+    iterator insert(iterator pos, T *entry) {
+        return iterator(ll_insert_before(L_, pos.node(), entry));
+    }
+
+    /* Remove (and release) the entry at pos and return the one after it */
+    iterator erase(iterator pos) { return iterator(ll_erase(L_, pos.node())); }
+
+    void clear() {
+        while (!empty())
+            ll_del_head(L_);
+    }
+
+private:
+    using key_type = typename KeyOf::key_type;
+
+    /* Whether KeyOf::key returns a reference into the entry, whose address
+     * can stand for the key in the C list */
+    static constexpr bool key_by_ref = std::is_lvalue_reference<
+        decltype(KeyOf::key(std::declval<const T *>()))>::value;
+
+    static_assert(key_by_ref || std::is_pointer<key_type>::value,
+                  "KeyOf::key must return a reference or a pointer");
+
+    static int cmp_thunk(void *k1, void *k2) {
+        if constexpr (key_by_ref)
+            return KeyOf::compare(*static_cast<const key_type *>(k1),
+                                  *static_cast<const key_type *>(k2));
+        else
+            return KeyOf::compare(static_cast<key_type>(k1), static_cast<key_type>(k2));
+    }
+
+    static void *key_thunk(void *entry) {
+        if constexpr (key_by_ref)
+            return const_cast<key_type *>(&KeyOf::key(static_cast<T *>(entry)));
+        else
+            return const_cast<void *>(static_cast<const void *>(
+                KeyOf::key(static_cast<T *>(entry))));
+    }
+
+    static void free_thunk(void *entry) { Free::release(entry); }
+
+    ll_t L_;
+};
+
+} // namespace ds
+
+#endif
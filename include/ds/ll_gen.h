@@ -0,0 +1,301 @@
+#pragma once
+#ifndef LL_GEN_H
+#define LL_GEN_H
+
+#include "ds/ll.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* LL_DEFINE(name, T, KEY_T, key_of, cmp) generates a doubly linked list of T
+ * called name##_t that stores entries by value inside its nodes. key_of and
+ * cmp are used directly, so lookups make no indirect calls:
+ *
+ *     KEY_T key_of(const T *entry);     returns the key of entry
+ *     int cmp(KEY_T k1, KEY_T k2);      same contract as ll_key_cmp_fn
+ *
+ * Both may be functions or function-like macros. The generated functions
+ * mirror ll.h, with T * in place of void * entries:
+ *
+ *     name##_t name##_new(void (*entry_free)(T *entry));
+ *     void     name##_free(name##_t L);
+ *     T       *name##_get(name##_t L, KEY_T key);
+ *     T       *name##_at(name##_t L, int index);
+ *     size_t   name##_size(name##_t L);
+ *     bool     name##_empty(name##_t L);
+ *     void     name##_traverse(name##_t L, name##_proc_fn *p, void *context);
+ *     void     name##_traverse_rev(name##_t L, name##_proc_fn *p, void *context);
+ *     void     name##_insert(name##_t L, T entry);
+ *     void     name##_insert_tail(name##_t L, T entry);
+ *     void     name##_insert_at(name##_t L, T entry, int index);
+ *     int      name##_del(name##_t L, KEY_T key);
+ *     int      name##_del_rev(name##_t L, KEY_T key);
+ *     void     name##_del_head(name##_t L);
+ *     void     name##_del_tail(name##_t L);
+ *     void     name##_del_at(name##_t L, int index);
+ *     int      name##_update(name##_t L, KEY_T key, T new_entry, T *old);
+ *     void     name##_update_at(name##_t L, int index, T new_entry, T *old);
+ *
+ * entry_free may be NULL; it is called on an entry's storage before the entry
+ * is dropped. name##_del and name##_update return 0 on success and 1 if no
+ * entry has key. The update functions copy the old entry to *old instead of
+ * freeing it when old != NULL.
+ *
+ * name##_proc_fn is enum ll_traversalAction (T *entry, void *context).
+ * */
+#define LL_DEFINE(name, T, KEY_T, key_of, cmp)                                 \
+                                                                               \
+struct name##_Node {                                                           \
+    struct name##_Node *next;                                                  \
+    struct name##_Node *prev;                                                  \
+    T entry;                                                                   \
+};                                                                             \
+                                                                               \
+struct name##_Header {                                                         \
+    /* Sentinels, head.next is the first node and tail.prev the last */        \
+    struct name##_Node head;                                                   \
+    struct name##_Node tail;                                                   \
+                                                                               \
+    size_t size;                                                               \
+                                                                               \
+    void (*entry_free)(T *entry);                                              \
+};                                                                             \
+                                                                               \
+typedef struct name##_Header *name##_t;                                        \
+typedef enum ll_traversalAction name##_proc_fn(T *entry, void *context);      \
+                                                                               \
+static inline name##_t name##_new(void (*entry_free)(T *entry)) {              \
+    name##_t L = malloc(sizeof(*L));                                           \
+                                                                               \
+    L->head.next = &L->tail;                                                   \
+    L->head.prev = NULL;                                                       \
+    L->tail.next = NULL;                                                       \
+    L->tail.prev = &L->head;                                                   \
+                                                                               \
+    L->size = 0;                                                               \
+    L->entry_free = entry_free;                                                \
+    return L;                                                                  \
+}                                                                              \
+                                                                               \
+static inline void name##_free(name##_t L) {                                   \
+    assert(L != NULL);                                                         \
+    struct name##_Node *curr = L->head.next, *next;                            \
+                                                                               \
+    while (curr != &L->tail) {                                                 \
+        next = curr->next;                                                     \
+        if (L->entry_free)                                                     \
+            L->entry_free(&curr->entry);                                       \
+        free(curr);                                                            \
+        curr = next;                                                           \
+    }                                                                          \
+    free(L);                                                                   \
+}                                                                              \
+                                                                               \
+static inline size_t name##_size(name##_t L) {                                 \
+    assert(L != NULL);                                                         \
+    return L->size;                                                            \
+}                                                                              \
+                                                                               \
+static inline bool name##_empty(name##_t L) {                                  \
+    assert(L != NULL);                                                         \
+    return !L->size;                                                           \
+}                                                                              \
+                                                                               \
+/* ====== Helpers ====== */                                                    \
+                                                                               \
+static inline struct name##_Node *name##_find_node(name##_t L,                 \
+                                                   KEY_T key,                  \
+                                                   bool rev) {                 \
+    struct name##_Node *curr = rev ? L->tail.prev : L->head.next;              \
+                                                                               \
+    while (curr != &L->tail && curr != &L->head) {                             \
+        if (cmp(key, key_of(&curr->entry)) == 0)                               \
+            return curr;                                                       \
+        curr = rev ? curr->prev : curr->next;                                  \
+    }                                                                          \
+    return NULL;                                                               \
+}                                                                              \
+                                                                               \
+static inline struct name##_Node *name##_node_at(name##_t L, int index) {      \
+    assert((0 <= index && (size_t)index < L->size)                             \
+           || (index < 0 && (size_t)-index <= L->size));                       \
+    struct name##_Node *curr;                                                  \
+                                                                               \
+    if (index >= 0) {                                                          \
+        curr = L->head.next;                                                   \
+        for (int i = 0; i < index; i++)                                        \
+            curr = curr->next;                                                 \
+    } else {                                                                   \
+        curr = L->tail.prev;                                                   \
+        for (int i = -1; i > index; i--)                                       \
+            curr = curr->prev;                                                 \
+    }                                                                          \
+    return curr;                                                               \
+}                                                                              \
+                                                                               \
+static inline void name##_insert_node(name##_t L,                              \
+                                      T entry,                                 \
+                                      struct name##_Node *next,                \
+                                      struct name##_Node *prev) {              \
+    struct name##_Node *N = malloc(sizeof(*N));                                \
+                                                                               \
+    N->entry = entry;                                                          \
+    N->next = next;                                                            \
+    N->prev = prev;                                                            \
+    prev->next = N;                                                            \
+    next->prev = N;                                                            \
+    L->size++;                                                                 \
+}                                                                              \
+                                                                               \
+static inline void name##_del_node(name##_t L, struct name##_Node *N) {        \
+    N->next->prev = N->prev;                                                   \
+    N->prev->next = N->next;                                                   \
+                                                                               \
+    if (L->entry_free)                                                         \
+        L->entry_free(&N->entry);                                              \
+    free(N);                                                                   \
+    L->size--;                                                                 \
+}                                                                              \
+                                                                               \
+static inline void name##_replace(name##_t L,                                  \
+                                  struct name##_Node *N,                       \
+                                  T new_entry,                                 \
+                                  T *old) {                                    \
+    if (old)                                                                   \
+        *old = N->entry;                                                       \
+    else if (L->entry_free)                                                    \
+        L->entry_free(&N->entry);                                              \
+    N->entry = new_entry;                                                      \
+}                                                                              \
+                                                                               \
+static inline void name##_traverse_opt(name##_t L,                             \
+                                       name##_proc_fn *p,                      \
+                                       void *context,                          \
+                                       bool rev) {                             \
+    struct name##_Node *curr = rev ? L->tail.prev : L->head.next;              \
+    struct name##_Node *tmp;                                                   \
+                                                                               \
+    while (curr != &L->tail && curr != &L->head) {                             \
+        switch (p(&curr->entry, context)) {                                    \
+            case LL_TRAVERSAL_CONTINUE:                                        \
+                break;                                                         \
+                                                                               \
+            case LL_TRAVERSAL_STOP:                                            \
+                return;                                                        \
+                                                                               \
+            case LL_TRAVERSAL_DELETE:                                          \
+                tmp = curr;                                                    \
+                curr = rev ? curr->prev : curr->next;                          \
+                name##_del_node(L, tmp);                                       \
+                continue;                                                      \
+        }                                                                      \
+        curr = rev ? curr->prev : curr->next;                                  \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+/* ====== Accessors ====== */                                                  \
+                                                                               \
+static inline T *name##_get(name##_t L, KEY_T key) {                           \
+    assert(L != NULL);                                                         \
+    struct name##_Node *N = name##_find_node(L, key, false);                   \
+    return N ? &N->entry : NULL;                                               \
+}                                                                              \
+                                                                               \
+static inline T *name##_at(name##_t L, int index) {                            \
+    assert(L != NULL);                                                         \
+    return &name##_node_at(L, index)->entry;                                   \
+}                                                                              \
+                                                                               \
+static inline void name##_traverse(name##_t L,                                 \
+                                   name##_proc_fn *p,                          \
+                                   void *context) {                            \
+    assert(L != NULL && p);                                                    \
+    name##_traverse_opt(L, p, context, false);                                 \
+}                                                                              \
+                                                                               \
+static inline void name##_traverse_rev(name##_t L,                             \
+                                       name##_proc_fn *p,                      \
+                                       void *context) {                        \
+    assert(L != NULL && p);                                                    \
+    name##_traverse_opt(L, p, context, true);                                  \
+}                                                                              \
+                                                                               \
+/* ====== Mutators ====== */                                                   \
+                                                                               \
+static inline void name##_insert(name##_t L, T entry) {                        \
+    assert(L != NULL);                                                         \
+    name##_insert_node(L, entry, L->head.next, &L->head);                      \
+}                                                                              \
+                                                                               \
+static inline void name##_insert_tail(name##_t L, T entry) {                   \
+    assert(L != NULL);                                                         \
+    name##_insert_node(L, entry, &L->tail, L->tail.prev);                      \
+}                                                                              \
+                                                                               \
+/* Inserts in front of the node at index; index == size appends */            \
+static inline void name##_insert_at(name##_t L, T entry, int index) {          \
+    assert(L != NULL);                                                         \
+    if (index >= 0 && (size_t)index == L->size) {                              \
+        name##_insert_tail(L, entry);                                          \
+        return;                                                                \
+    }                                                                          \
+    struct name##_Node *N = name##_node_at(L, index);                          \
+    name##_insert_node(L, entry, N, N->prev);                                  \
+}                                                                              \
+                                                                               \
+static inline int name##_del(name##_t L, KEY_T key) {                          \
+    assert(L != NULL);                                                         \
+    struct name##_Node *N = name##_find_node(L, key, false);                   \
+    if (!N)                                                                    \
+        return 1;                                                              \
+    name##_del_node(L, N);                                                     \
+    return 0;                                                                  \
+}                                                                              \
+                                                                               \
+static inline int name##_del_rev(name##_t L, KEY_T key) {                      \
+    assert(L != NULL);                                                         \
+    struct name##_Node *N = name##_find_node(L, key, true);                    \
+    if (!N)                                                                    \
+        return 1;                                                              \
+    name##_del_node(L, N);                                                     \
+    return 0;                                                                  \
+}                                                                              \
+                                                                               \
+static inline void name##_del_head(name##_t L) {                               \
+    assert(L != NULL && L->size);                                              \
+    name##_del_node(L, L->head.next);                                          \
+}                                                                              \
+                                                                               \
+static inline void name##_del_tail(name##_t L) {                               \
+    assert(L != NULL && L->size);                                              \
+    name##_del_node(L, L->tail.prev);                                          \
+}                                                                              \
+                                                                               \
+static inline void name##_del_at(name##_t L, int index) {                      \
+    assert(L != NULL && L->size);                                              \
+    name##_del_node(L, name##_node_at(L, index));                              \
+}                                                                              \
+                                                                               \
+static inline int name##_update(name##_t L, KEY_T key, T new_entry, T *old) {  \
+    assert(L != NULL);                                                         \
+    struct name##_Node *N = name##_find_node(L, key, false);                   \
+    if (!N)                                                                    \
+        return 1;                                                              \
+    name##_replace(L, N, new_entry, old);                                      \
+    return 0;                                                                  \
+}                                                                              \
+                                                                               \
+static inline void name##_update_at(name##_t L,                                \
+                                    int index,                                 \
+                                    T new_entry,                               \
+                                    T *old) {                                  \
+    assert(L != NULL);                                                         \
+    name##_replace(L, name##_node_at(L, index), new_entry, old);               \
+}
+
+#endif
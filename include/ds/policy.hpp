@@ -0,0 +1,74 @@
+#pragma once
+#ifndef POLICY_HPP
+#define POLICY_HPP
+
+#include <functional>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* Compile-time policies for the C++ wrappers (ll.hpp, uba.hpp). They are
+ * plain types with static members, so the wrappers call them directly rather
+ * than through the function pointers the C containers store.
+ *
+ * A key policy K for entries of type T provides
+ *
+ *     using key_type = ...;
+ *     static key_type key(const T *entry);      (or a const reference)
+ *     static int compare(const key_type &k1, const key_type &k2);
+ *
+ * where compare has the contract of ll_key_cmp_fn. A release policy F
+ * provides
+ *
+ *     static constexpr bool frees;              whether release does anything
+ *     static void release(void *entry);
+ *
+ * and is called where the C containers call entry_free.
+ * */
+
+namespace ds {
+
+/* Entries are their own keys, compared by address */
+template <typename T>
+struct ptr_key {
+    using key_type = const T *;
+
+    static key_type key(const T *entry) { return entry; }
+
+    static int compare(key_type k1, key_type k2) {
+        std::less<key_type> less;
+        return less(k1, k2) ? -1 : less(k2, k1);
+    }
+};
+
+/* The key is the member M of the entry, compared with < */
+template <typename T, typename K, K T::*M>
+struct member_key {
+    using key_type = K;
+
+    static const K &key(const T *entry) { return entry->*M; }
+
+    static int compare(const K &k1, const K &k2) {
+        return k1 < k2 ? -1 : k2 < k1;
+    }
+};
+
+/* The container does not own its entries */
+struct no_free {
+    static constexpr bool frees = false;
+
+    static void release(void *) {}
+};
+
+/* The container owns entries made with new T */
+template <typename T>
+struct delete_entry {
+    static constexpr bool frees = true;
+
+    static void release(void *entry) { delete static_cast<T *>(entry); }
+};
+
+} // namespace ds
+
+#endif
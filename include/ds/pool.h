@@ -0,0 +1,110 @@
+#pragma once
+#ifndef POOL_H
+#define POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* Process chunk number chunk, which covers indices [begin, end)
+ *
+ * requires: begin < end
+ * */
+typedef void pool_range_fn(void *context, size_t begin, size_t end, size_t chunk);
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+typedef struct pool_Header *pool_t;
+
+/* Smallest chunk pool_grain hands out, so per-chunk overhead stays small */
+#define POOL_MIN_GRAIN 512
+/* Chunks per thread pool_grain aims for, leaving slack for stealing */
+#define POOL_CHUNKS_PER_THREAD 8
+
+/* Chunks still owed to one thread: it takes chunks from the front of its
+ * range and idle threads steal the back half */
+struct pool_Slot {
+    pthread_mutex_t lock;
+    size_t lo;
+    size_t hi;
+} __attribute__((aligned(64)));
+
+struct pool_Job;
+
+struct pool_Header {
+    pthread_t *threads;
+    size_t nthreads;        /* Including the thread calling pool_for */
+    struct pool_Slot *slots;
+
+    pthread_mutex_t job_lock;   /* Serializes pool_for callers */
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t idle;
+    struct pool_Job *job;
+    size_t gen;             /* Bumped for every job */
+    size_t active;          /* Workers inside the current job */
+    bool stop;
+};
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* ====== Init and Teardown ====== */
+
+/* Return a pool running jobs on nthreads threads (the number of online CPUs if
+ * 0). The thread calling pool_for is one of them, so nthreads - 1 threads are
+ * started; they sleep between jobs.
+ *
+ * ensures: rv != NULL && pool_threads(rv) >= 1
+ * */
+pool_t pool_new(size_t nthreads);
+
+/* Stop the threads of P and free it
+ *
+ * requires: P != NULL && no pool_for on P is running
+ * */
+void pool_free(pool_t P);
+
+/* Return the process-wide pool, started with pool_new(0) on first use and
+ * freed at exit
+ *
+ * ensures: rv != NULL
+ * */
+pool_t pool_default(void);
+
+/* ====== Accessors ====== */
+
+/* Return number of threads working on a job of P
+ *
+ * requires: P != NULL
+ * */
+size_t pool_threads(pool_t P);
+
+/* Return a chunk size for n elements on P: about POOL_CHUNKS_PER_THREAD chunks
+ * per thread, but no less than POOL_MIN_GRAIN elements
+ *
+ * requires: P != NULL
+ * ensures: rv > 0
+ * */
+size_t pool_grain(pool_t P, size_t n);
+
+/* ====== Jobs ====== */
+
+/* Split [0, n) into chunks of grain indices (the last may be shorter) and run
+ * fn on every chunk across the threads of P, returning when all are done.
+ * Chunk k covers [k * grain, min((k + 1) * grain, n)). fn must not call
+ * pool_for on P.
+ *
+ * requires: P != NULL && fn != NULL && grain > 0
+ * */
+void pool_for(pool_t P, size_t n, size_t grain, pool_range_fn *fn, void *context);
+
+#endif
@@ -0,0 +1,120 @@
+#pragma once
+#ifndef PQ_H
+#define PQ_H
+
+#include "ds/uba.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* Takes two entries and orders them; the entry comparing lowest is popped
+ * first
+ *
+ * ensures: (rv < 0 && e1 before e2) || (rv > 0 && e2 before e1) || rv == 0
+ * */
+typedef int pq_cmp_fn(void *e1, void *e2);
+
+/* Told the new index of entry every time it moves inside the heap. Storing the
+ * index in the entry gives a handle for pq_update and pq_remove.
+ *
+ * requires: entry != NULL
+ * */
+typedef void pq_index_fn(void *entry, size_t index);
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+typedef struct pq_Header *pq_t;
+
+/* 4-ary heap: the children of index i are 4i + 1 ... 4i + 4 */
+struct pq_Header {
+    uba_t heap;
+
+    pq_cmp_fn *cmp;
+    pq_index_fn *set_index;
+};
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* ====== Init and Teardown ====== */
+
+/* Return an empty priority queue with room for limit entries. set_index may be
+ * NULL when handles are not needed.
+ *
+ * requires: cmp != NULL
+ * ensures: rv != NULL && pq_empty(rv)
+ * */
+pq_t pq_new(size_t limit,
+            pq_cmp_fn *cmp,
+            pq_index_fn *set_index,
+            uba_entry_free_fn *entry_free);
+
+/* Turn the entries of U into a priority queue in O(n). The queue takes over U
+ * (and its entry_free), so U must not be used or freed afterwards.
+ *
+ * requires: U != NULL && !uba_raw(U) && !uba_paged(U) && cmp != NULL
+ * ensures: rv != NULL && pq_size(rv) == uba_size(U)
+ * */
+pq_t pq_heapify(uba_t U, pq_cmp_fn *cmp, pq_index_fn *set_index);
+
+/* Free P alongside remaining entries if entry_free is defined, like uba_free
+ *
+ * requires: P != NULL
+ * */
+void pq_free(pq_t P);
+
+/* ====== Accessors ====== */
+
+/* Return number of entries in P
+ *
+ * requires: P != NULL
+ * */
+size_t pq_size(pq_t P);
+
+/* Return boolean indicating whether P is empty
+ *
+ * requires: P != NULL
+ * */
+bool pq_empty(pq_t P);
+
+/* Return the first entry without removing it
+ *
+ * requires: P != NULL && !pq_empty(P)
+ * */
+void *pq_peek(pq_t P);
+
+/* ====== Mutators ====== */
+
+/* Add entry to P
+ *
+ * requires: P != NULL && entry != NULL
+ * ensures: !pq_empty(P)
+ * */
+void pq_push(pq_t P, void *entry);
+
+/* Remove and return the first entry; it is not freed
+ *
+ * requires: P != NULL && !pq_empty(P)
+ * */
+void *pq_pop(pq_t P);
+
+/* Restore heap order after the priority of the entry at index changed in
+ * either direction (decrease-key and increase-key)
+ *
+ * requires: P != NULL && index < pq_size(P)
+ * */
+void pq_update(pq_t P, size_t index);
+
+/* Remove and return the entry at index; it is not freed
+ *
+ * requires: P != NULL && index < pq_size(P)
+ * */
+void *pq_remove(pq_t P, size_t index);
+
+#endif
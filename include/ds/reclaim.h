@@ -0,0 +1,41 @@
+#pragma once
+#ifndef RECLAIM_H
+#define RECLAIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* Free up to budget elements of obj; return true once obj itself is gone.
+ * ll_free_step and uba_free_step have this shape.
+ * */
+typedef bool reclaim_step_fn(void *obj, size_t budget);
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+/* Elements the reclaimer thread frees per step of a job before moving on to
+ * the next queued job; unfinished jobs go back to the end of the queue */
+#define RECLAIM_BATCH 4096
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* Queue obj for the background reclaimer thread, which calls step on it until
+ * it is gone, taking turns with the other queued objects. The thread is
+ * started on first use and drained at exit.
+ *
+ * requires: obj != NULL && step != NULL
+ * */
+void reclaim_defer(void *obj, reclaim_step_fn *step);
+
+/* Block until everything queued so far has been freed
+ * */
+void reclaim_drain(void);
+
+#endif
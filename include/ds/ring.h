@@ -0,0 +1,138 @@
+#pragma once
+#ifndef RING_H
+#define RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+typedef void ring_entry_free_fn(void *);
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+typedef struct ring_Header *ring_t;
+
+/* Empty polls ring_pop_wait spins through before sleeping on the futex */
+#define RING_SPIN 256
+
+/* Single-producer/single-consumer queue of pointers. head and tail count every
+ * entry ever popped and pushed; the slot of position i is slot[i & mask]. Each
+ * side keeps a cached copy of the other side's index on its own cache line and
+ * only reloads it when the cache says the ring is full (producer) or empty
+ * (consumer), so the common case touches no shared line but the slot.
+ * */
+struct ring_Header {
+    /* Read-only after ring_new */
+    void **slot;
+    size_t mask;
+    ring_entry_free_fn *entry_free;
+
+    /* Producer side */
+    _Alignas(64) atomic_size_t tail;
+    size_t head_cache;
+    atomic_bool closed;
+
+    /* Consumer side */
+    _Alignas(64) atomic_size_t head;
+    size_t tail_cache;
+
+    /* Futex word, 1 while the consumer sleeps or is about to */
+    _Alignas(64) atomic_uint sleeping;
+};
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* ====== Init and Teardown ====== */
+
+/* Return an empty ring holding up to capacity entries, rounded up to a power
+ * of two
+ *
+ * requires: 0 < capacity
+ * ensures: rv != NULL && ring_capacity(rv) >= capacity
+ * */
+ring_t ring_new(size_t capacity, ring_entry_free_fn *entry_free);
+
+/* Free R alongside the entries still in it if entry_free is defined
+ *
+ * requires: R != NULL && neither side is using R
+ * */
+void ring_free(ring_t R);
+
+/* ====== Accessors ====== */
+
+/* Return the number of entries R can hold
+ *
+ * requires: R != NULL
+ * */
+size_t ring_capacity(ring_t R);
+
+/* Return the number of entries in R. Exact from either side when the other
+ * one is idle, a snapshot otherwise.
+ *
+ * requires: R != NULL
+ * */
+size_t ring_size(ring_t R);
+
+/* Return whether the producer closed R (see ring_close)
+ *
+ * requires: R != NULL
+ * */
+bool ring_closed(ring_t R);
+
+/* ====== Producer ====== */
+
+/* The functions below may only be called from one thread at a time */
+
+/* Append entry; returns false if R is full
+ *
+ * requires: R != NULL && entry != NULL && !ring_closed(R)
+ * */
+bool ring_push(ring_t R, void *entry);
+
+/* Append up to n entries from entries, in order, and publish them to the
+ * consumer at once. Returns the number appended.
+ *
+ * requires: R != NULL && (entries != NULL || n == 0) && !ring_closed(R)
+ *              && entries[0..n) != NULL
+ * */
+size_t ring_push_n(ring_t R, void **entries, size_t n);
+
+/* Tell the consumer no more entries will come; wakes it if it is waiting
+ *
+ * requires: R != NULL
+ * */
+void ring_close(ring_t R);
+
+/* ====== Consumer ====== */
+
+/* The functions below may only be called from one thread at a time */
+
+/* Remove and return the oldest entry, or NULL if R is empty
+ *
+ * requires: R != NULL
+ * */
+void *ring_pop(ring_t R);
+
+/* Remove up to n of the oldest entries into out, in order, and hand their
+ * slots back to the producer at once. Returns the number removed.
+ *
+ * requires: R != NULL && (out != NULL || n == 0)
+ * */
+size_t ring_pop_n(ring_t R, void **out, size_t n);
+
+/* Like ring_pop_n, but if R is empty spin for a while, then sleep until the
+ * producer pushes or closes R. Returns 0 only once R is closed and empty.
+ *
+ * requires: R != NULL && out != NULL && 0 < n
+ * */
+size_t ring_pop_wait(ring_t R, void **out, size_t n);
+
+#endif
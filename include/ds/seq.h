@@ -0,0 +1,189 @@
+#pragma once
+#ifndef SEQ_H
+#define SEQ_H
+
+#include "ds/uba.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+typedef void seq_entry_free_fn(void *entry);
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+typedef struct seq_Header *seq_t;
+
+/* Entries per chunk of the chunked layout. Conversion fills chunks to 3/4 so
+ * the first middle inserts do not split them. */
+#define SEQ_CHUNK 256
+
+enum seq_layout {
+    SEQ_ARRAY,      /* One contiguous uba: O(1) index, O(n) middle insert */
+    SEQ_CHUNKED,    /* Linked chunks: O(n / SEQ_CHUNK) index, O(SEQ_CHUNK)
+                       middle insert once the chunk is found */
+};
+
+/* When a sequence changes layout. Every window operations, the share of
+ * them that inserted or removed away from both ends is compared with the
+ * thresholds; the gap between them keeps a mixed workload from converting
+ * back and forth. */
+struct seq_Tuning {
+    size_t window;          /* Operations between decisions, 0 to never convert */
+    size_t min_size;        /* Smaller sequences are always arrays */
+    double to_chunked;      /* An array at or above this share becomes chunked */
+    double to_array;        /* A chunked sequence at or below it becomes an array */
+};
+
+#define SEQ_TUNING_DEFAULT ((struct seq_Tuning){ 1024, 4096, 0.05, 0.01 })
+
+/* Operation counters, only maintained when built with DS_STATS */
+struct seq_Stats {
+    size_t to_chunked;      /* Conversions from SEQ_ARRAY to SEQ_CHUNKED */
+    size_t to_array;        /* Conversions from SEQ_CHUNKED to SEQ_ARRAY */
+    size_t entries_moved;   /* Entries copied by conversions */
+};
+
+struct seq_Chunk {
+    struct seq_Chunk *next;
+    struct seq_Chunk *prev;
+    size_t count;
+    void *entry[SEQ_CHUNK];
+};
+
+struct seq_Header {
+    enum seq_layout layout;
+    size_t size;
+    seq_entry_free_fn *entry_free;
+
+    /* SEQ_ARRAY */
+    uba_t array;
+
+    /* SEQ_CHUNKED; cursor is the chunk last used, whose first entry has
+     * index cursor_base, and where index lookups start */
+    struct seq_Chunk *head;
+    struct seq_Chunk *tail;
+    struct seq_Chunk *cursor;
+    size_t cursor_base;
+
+    /* Operation mix of the current window */
+    struct seq_Tuning tuning;
+    size_t window_ops;
+    size_t window_mid;
+
+#ifdef DS_STATS
+    struct seq_Stats stats;
+#endif
+};
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* ====== Init and Teardown ====== */
+
+/* Return an empty sequence in SEQ_ARRAY layout with SEQ_TUNING_DEFAULT
+ *
+ * ensures: rv != NULL && seq_size(rv) == 0 && seq_layout(rv) == SEQ_ARRAY
+ * */
+seq_t seq_new(seq_entry_free_fn *entry_free);
+
+/* Free S alongside its entries if entry_free is defined
+ *
+ * requires: S != NULL
+ * */
+void seq_free(seq_t S);
+
+/* Replace the conversion thresholds of S and start a new window
+ *
+ * requires: S != NULL && 0 <= tuning.to_array && tuning.to_array <= tuning.to_chunked
+ * */
+void seq_set_tuning(seq_t S, struct seq_Tuning tuning);
+
+/* Convert S to layout now, whatever its tuning says. O(n).
+ *
+ * requires: S != NULL
+ * ensures: seq_layout(S) == layout
+ * */
+void seq_convert(seq_t S, enum seq_layout layout);
+
+/* ====== Accessors ====== */
+
+/* Return the number of entries in S
+ *
+ * requires: S != NULL
+ * */
+size_t seq_size(seq_t S);
+
+/* Return whether S has no entries
+ *
+ * requires: S != NULL
+ * */
+bool seq_empty(seq_t S);
+
+/* Return the current layout of S
+ *
+ * requires: S != NULL
+ * */
+enum seq_layout seq_layout(seq_t S);
+
+/* Return the operation counters of S, all zero without DS_STATS
+ *
+ * requires: S != NULL
+ * */
+struct seq_Stats seq_stats(seq_t S);
+
+/* Return the counters summed over every sequence, all zero without DS_STATS */
+struct seq_Stats seq_stats_global(void);
+
+/* Return the entry at index. Chunked sequences walk from the chunk last
+ * used, so visiting indices in order costs O(1) each.
+ *
+ * requires: S != NULL && index < seq_size(S)
+ * */
+void *seq_get(seq_t S, size_t index);
+
+/* ====== Modifiers ====== */
+
+/* Add entry to the end of S
+ *
+ * requires: S != NULL
+ * */
+void seq_push(seq_t S, void *entry);
+
+/* Remove (and free) the last entry of S
+ *
+ * requires: S != NULL && !seq_empty(S)
+ * */
+void seq_pop(seq_t S);
+
+/* Insert entry at index, moving the entries from index on to the right
+ *
+ * requires: S != NULL && index <= seq_size(S)
+ * */
+void seq_insert(seq_t S, size_t index, void *entry);
+
+/* Remove (and free) the entry at index, moving later entries to the left
+ *
+ * requires: S != NULL && index < seq_size(S)
+ * */
+void seq_remove(seq_t S, size_t index);
+
+/* Remove the entry at index like seq_remove, but return it instead of
+ * freeing it; the caller owns the entry
+ *
+ * requires: S != NULL && index < seq_size(S)
+ * */
+void *seq_take(seq_t S, size_t index);
+
+/* Replace the entry at index, freeing the old one
+ *
+ * requires: S != NULL && index < seq_size(S)
+ * */
+void seq_update(seq_t S, size_t index, void *entry);
+
+#endif
@@ -0,0 +1,139 @@
+#pragma once
+#ifndef TW_H
+#define TW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+struct tw_Timer;
+
+/* Called with the timer's entry when it expires. The timer is no longer
+ * pending, so the callback may schedule it again or free it.
+ * */
+typedef void tw_fire_fn(void *entry, struct tw_Timer *T);
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+typedef struct tw_Header *tw_t;
+
+/* Each level has 2^TW_BITS slots, each covering 2^(TW_BITS * level) ticks, so
+ * the wheel places timers up to 2^(TW_BITS * TW_LEVELS) ticks ahead; later
+ * ones wait in the last slot of the top level and are placed again when it
+ * cascades. A tick is whatever unit the caller passes to tw_advance. */
+#define TW_BITS 8
+#define TW_LEVELS 4
+#define TW_SLOTS (1u << TW_BITS)
+
+/* Timers are embedded in the caller's objects, so arming one allocates
+ * nothing. Slots hold NULL-terminated lists; slot is the index of the list
+ * head in tw_Header.slot, which unlinking the first node updates. */
+struct tw_Timer {
+    void *entry;
+    struct tw_Timer *next;
+    struct tw_Timer *prev;
+
+    uint64_t expires;
+    tw_fire_fn *fire;
+    uint32_t slot;
+    bool pending;
+};
+
+/* slot[level * TW_SLOTS + i] is slot i of level; the extra list at the end
+ * holds the batch tw_advance is firing. clock is the next tick to run. */
+struct tw_Header {
+    uint64_t now;
+    uint64_t clock;
+    size_t size;
+    size_t level_size[TW_LEVELS];
+    struct tw_Timer *slot[TW_LEVELS * TW_SLOTS + 1];
+};
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* ====== Init and Teardown ====== */
+
+/* Return an empty wheel whose time is now
+ *
+ * ensures: rv != NULL && tw_now(rv) == now && tw_size(rv) == 0
+ * */
+tw_t tw_new(uint64_t now);
+
+/* Free W. Pending timers belong to the caller and are left unlinked.
+ *
+ * requires: W != NULL && W is not inside tw_advance
+ * */
+void tw_free(tw_t W);
+
+/* Prepare T to call fire with entry when it expires
+ *
+ * requires: T != NULL && fire != NULL
+ * ensures: !tw_pending(T)
+ * */
+void tw_timer_init(struct tw_Timer *T, tw_fire_fn *fire, void *entry);
+
+/* ====== Accessors ====== */
+
+/* Return the time of the last tw_advance, or tw_new's if there was none
+ *
+ * requires: W != NULL
+ * */
+uint64_t tw_now(tw_t W);
+
+/* Return the number of pending timers in W
+ *
+ * requires: W != NULL
+ * */
+size_t tw_size(tw_t W);
+
+/* Return whether T is scheduled and has not fired or been cancelled
+ *
+ * requires: T != NULL
+ * */
+bool tw_pending(struct tw_Timer *T);
+
+/* ====== Modifiers ====== */
+
+/* Arm T to fire at the first tw_advance to a time >= expires. An expiry at or
+ * before tw_now(W) fires on the next tw_advance past tw_now(W). O(1).
+ *
+ * requires: W != NULL && T was passed to tw_timer_init && !tw_pending(T)
+ * ensures: tw_pending(T)
+ * */
+void tw_schedule(tw_t W, struct tw_Timer *T, uint64_t expires);
+
+/* Disarm T if it is pending, including when it waits in the batch being
+ * fired. O(1).
+ *
+ * requires: W != NULL && T != NULL && (!tw_pending(T) || T is in W)
+ * ensures: !tw_pending(T) && rv == whether T was pending
+ * */
+bool tw_cancel(tw_t W, struct tw_Timer *T);
+
+/* Move T, pending or not, to expire at expires. O(1).
+ *
+ * requires: as tw_schedule, except T may be pending in W
+ * ensures: tw_pending(T)
+ * */
+void tw_reschedule(tw_t W, struct tw_Timer *T, uint64_t expires);
+
+/* Run the wheel up to now, firing every timer that expires by then. Each
+ * tick's timers are detached as one batch before their callbacks run, and
+ * stretches of ticks without timers in reach are skipped. Callbacks may
+ * schedule, reschedule or cancel any timer, but must not advance or free W.
+ * Times before tw_now(W) fire nothing.
+ *
+ * requires: W != NULL
+ * ensures: tw_now(W) == max(now, old tw_now(W)) && rv == timers fired
+ * */
+size_t tw_advance(tw_t W, uint64_t now);
+
+#endif
@@ -2,8 +2,14 @@
 #ifndef UBA_H
 #define UBA_H
 
+#include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /******************************************************************************/
 /*                              Client Interface                              */
@@ -11,11 +17,49 @@
 
 typedef void uba_entry_free_fn(void *);
 
+/* Write entry into buf if it needs at most len bytes and return the number of
+ * bytes the serialized entry needs
+ *
+ * requires: entry != NULL
+ * */
+typedef size_t uba_entry_serialize_fn(void *entry, void *buf, size_t len);
+
+/* Turn a serialized entry back into an entry. payload is 8-byte aligned and
+ * stays mapped (and writable) until the uba is freed, so returning payload
+ * itself loads the entry without copying it.
+ *
+ * requires: payload != NULL
+ * */
+typedef void *uba_entry_deserialize_fn(void *payload, size_t len);
+
+/* Compare two entries, for the routines over sorted ubas (uba_set.h,
+ * uba_index.h)
+ *
+ * ensures: (rv > 0 && e1 > e2) || (rv < 0 && e1 < e2) || (rv == 0 && e1 == e2)
+ * */
+typedef int uba_cmp_fn(void *e1, void *e2);
+
 /******************************************************************************/
 /*                               Implementation                               */
 /******************************************************************************/
 
 typedef struct uba_Header *uba_t;
+typedef struct uba_Snapshot *uba_snap_t;
+
+/* Access pattern hints for file-backed ubas */
+enum uba_advice {
+    UBA_ADVICE_NORMAL,
+    UBA_ADVICE_SEQUENTIAL,
+    UBA_ADVICE_RANDOM,
+};
+
+/* Operation counters, only maintained when built with DS_STATS */
+struct uba_Stats {
+    size_t allocs;          /* Heap allocations (header and data buffers) */
+    size_t bytes;           /* Bytes currently held by the uba */
+    size_t resizes;         /* Calls to uba_resize */
+    size_t bytes_copied;    /* Bytes moved by uba_resize */
+};
 
 struct uba_Header {
     void **data;
@@ -26,6 +70,25 @@ struct uba_Header {
     bool raw;
 
     uba_entry_free_fn *entry_free;
+
+    /* File mapping backing the entries of an uba made by uba_load */
+    void *map;
+    size_t map_len;
+
+    /* Backing file of an uba made by uba_new_mapped, -1 otherwise */
+    int fd;
+    enum uba_advice advice;
+
+    /* Page table of an uba made by uba_new_paged (data is NULL then) */
+    struct uba_PageTable *pages;
+
+    /* Entries removed since the last snapshot, freed once the snapshots
+     * that may still see them are released (see uba_snapshot) */
+    struct uba_Epoch *epoch;
+
+#ifdef DS_STATS
+    struct uba_Stats stats;
+#endif
 };
 
 /******************************************************************************/
@@ -41,12 +104,72 @@ struct uba_Header {
  * */
 uba_t uba_new(size_t limit, bool raw, uba_entry_free_fn *entry_free);
 
+/* Return an uba whose data buffer is a shared mapping of the file at path,
+ * so the OS pages entries in and out instead of holding them all in RAM. The
+ * file is created if needed, its previous contents are discarded and it grows
+ * with the uba. Return NULL if path cannot be opened or mapped.
+ *
+ * requires: path != NULL
+ * ensures: rv == NULL || uba_mapped(rv)
+ * */
+uba_t uba_new_mapped(const char *path,
+                     size_t limit,
+                     bool raw,
+                     uba_entry_free_fn *entry_free);
+
+/* Return an uba that stores entries in reference-counted pages so that
+ * uba_snapshot is O(1). Writes copy a page only while a snapshot shares it.
+ * uba_data is unavailable for paged ubas.
+ *
+ * ensures: rv != NULL && uba_paged(rv)
+ * */
+uba_t uba_new_paged(size_t limit, bool raw, uba_entry_free_fn *entry_free);
+
 /* Free U alongside entries if entry_free defined for U
  *
  * requires: U != NULL
  * */
 void uba_free(uba_t U);
 
+/* Hand U to the background reclaimer thread (see reclaim.h), which frees it
+ * like uba_free in batches. Returns at once; U must not be used afterwards.
+ *
+ * requires: U != NULL
+ * */
+void uba_free_async(uba_t U);
+
+/* Free up to budget entries of U, from the back, and once none are left U
+ * itself. Returns true when U is gone. Lets a single-threaded caller spread
+ * uba_free over many bounded steps.
+ *
+ * requires: U != NULL && 0 < budget
+ * */
+bool uba_free_step(uba_t U, size_t budget);
+
+/* Exchange the contents of A and B (entries, storage, entry_free and
+ * counters) in O(1), without copying or freeing any entry
+ *
+ * requires: A != NULL && B != NULL
+ * */
+void uba_swap(uba_t A, uba_t B);
+
+/* Write U to a versioned, checksummed binary file at path using ser to
+ * serialize each entry. Return 0 on success and 1 on failure.
+ *
+ * requires: U != NULL && !uba_raw(U) && path != NULL && ser != NULL
+ * */
+int uba_save(uba_t U, const char *path, uba_entry_serialize_fn *ser);
+
+/* Map a file written by uba_save and fill a new uba with deser applied to each
+ * payload in place. The mapping is released by uba_free, so entry_free must not
+ * free entries that point into it. Return NULL if the file cannot be read, has
+ * an unknown version or fails its checksum.
+ *
+ * requires: path != NULL && deser != NULL
+ * */
+uba_t uba_load(const char *path,
+               uba_entry_deserialize_fn *deser,
+               uba_entry_free_fn *entry_free);
 
 /* Return size of uba (used space)
  *
@@ -69,6 +192,35 @@ size_t uba_limit(uba_t U);
  * */
 bool uba_raw(uba_t U);
 
+/* Return boolean indicating whether uba is backed by a file
+ *
+ * requires: U != NULL
+ * ensures: U != NULL
+ * */
+bool uba_mapped(uba_t U);
+
+/* Set the expected access pattern of a file-backed uba (kept across resizes)
+ *
+ * requires: U != NULL && uba_mapped(U)
+ * ensures: U != NULL
+ * */
+void uba_advise(uba_t U, enum uba_advice advice);
+
+/* Flush the data buffer of a file-backed uba to its file. Return 0 on success
+ * and 1 on failure.
+ *
+ * requires: U != NULL && uba_mapped(U)
+ * ensures: U != NULL
+ * */
+int uba_sync(uba_t U);
+
+/* Return boolean indicating whether uba stores entries in pages
+ *
+ * requires: U != NULL
+ * ensures: U != NULL
+ * */
+bool uba_paged(uba_t U);
+
 /* Return boolean indicating whether uba is empty
  *
  * requires: U != NULL && !uba_raw(U)
@@ -76,6 +228,23 @@ bool uba_raw(uba_t U);
  * */
 bool uba_empty(uba_t U);
 
+/* Return the operation counters of U (all zero unless built with DS_STATS)
+ *
+ * requires: U != NULL
+ * */
+struct uba_Stats uba_stats(uba_t U);
+
+/* Return the counters aggregated over every uba (all zero unless built with
+ * DS_STATS). bytes only accounts for ubas that have not been freed.
+ * */
+struct uba_Stats uba_stats_global(void);
+
+/* Write the aggregated counters to f in human-readable form
+ *
+ * requires: f != NULL
+ * */
+void uba_stats_dump(FILE *f);
+
 /******************************************************************************/
 /*                             High-Level Access                              */
 /******************************************************************************/
@@ -89,12 +258,13 @@ bool uba_empty(uba_t U);
  * */
 void *uba_get(uba_t U, size_t index);
 
-/* Add entry to end of uba's used space
+/* Add entry to end of uba's used space. Return 0, or 1 if a mapped uba
+ * cannot grow its file, leaving U unchanged.
  *
  * requires: U != NULL && !uba_raw(U)
  * ensures: U != NULL
  * */
-void uba_push(uba_t U, void *entry);
+int uba_push(uba_t U, void *entry);
 
 /* Delete last element of used space
  *
@@ -103,12 +273,21 @@ void uba_push(uba_t U, void *entry);
  * */
 void uba_pop(uba_t U);
 
-/* Insert entry at index, moving current index to the right
+/* Remove last element of used space and return it without freeing it; the
+ * caller owns the entry
+ *
+ * requires: U != NULL && !uba_raw(U) && uba_size(U) > 0
+ * ensures: U != NULL
+ * */
+void *uba_pop_take(uba_t U);
+
+/* Insert entry at index, moving current index to the right. Return 0, or 1
+ * if a mapped uba cannot grow its file, leaving U unchanged.
  *
  * requires: U != NULL && !uba_raw(U) && 0 <= index && index <= uba_size(U)
  * ensures: U != NULL
  * */
-void uba_insert(uba_t U, size_t index, void *entry);
+int uba_insert(uba_t U, size_t index, void *entry);
 
 /* Remove (and free) entry at index, moving higher-index entries to the left
  *
@@ -118,6 +297,15 @@ void uba_insert(uba_t U, size_t index, void *entry);
  * */
 void uba_remove(uba_t U, size_t index);
 
+/* Remove entry at index like uba_remove, but return it instead of freeing it;
+ * the caller owns the entry
+ *
+ * requires: U != null && !uba_raw(U) && uba_size(U) > 0
+ *              0 <= index && index < uba_size(U)
+ * ensures: U != NULL
+ * */
+void *uba_take(uba_t U, size_t index);
+
 /* Update entry at index, freeing old entry *
  * requires: U != null && !uba_raw(U) && uba_size(U) > 0
  *              0 <= index && index < uba_size(U)
@@ -125,12 +313,13 @@ void uba_remove(uba_t U, size_t index);
  * */
 void uba_update(uba_t U, size_t index, void *entry);
 
-/* Shrink reserved space to used space
+/* Shrink reserved space to used space. Return 0, or 1 if a mapped uba
+ * cannot cut its file, leaving U unchanged.
  *
  * requires: U != null
  * ensures: U != null
  * */
-void uba_shrink(uba_t U);
+int uba_shrink(uba_t U);
 
 /******************************************************************************/
 /*                              Low-Level Access                              */
@@ -157,11 +346,95 @@ void uba_del(uba_t U, size_t index);
  * */
 void *uba_data(uba_t U);
 
-/* Change limit to new_limit if new_limit > uba_size(U)
+/* Free U but hand its data array to the caller instead of freeing it. The
+ * caller owns the array and its entries and releases the array with free().
+ * Stores the number of entries (uba_limit for raw ubas) in *size if size is
+ * not NULL.
+ *
+ * requires: U != NULL && !uba_mapped(U) && !uba_paged(U)
+ *              && U was not made by uba_load
+ * ensures: rv != NULL
+ * */
+void **uba_steal_buffer(uba_t U, size_t *size);
+
+/* Change limit to new_limit if new_limit > uba_size(U). Return 0, or 1 if
+ * the backing file of a mapped uba cannot be resized, leaving U unchanged.
  *
  * requires: U != NULL && uba_size(U) < new_limit && new_limit <= ULONG_MAX / 2
  * ensures: U != NULL
  * */
-void uba_resize(uba_t U, size_t new_limit);
+int uba_resize(uba_t U, size_t new_limit);
+
+/******************************************************************************/
+/*                                 Snapshots                                  */
+/******************************************************************************/
+
+/* Return an immutable view of U's current entries in O(1). The view shares
+ * U's pages and may be read and released from any thread while U's (single)
+ * writer keeps mutating U.
+ *
+ * Entries themselves are shared, not copied. An entry removed or replaced in
+ * U after a snapshot is taken is not freed until that snapshot is released,
+ * so entry_free may then run on the thread releasing it.
+ *
+ * requires: U != NULL && !uba_raw(U) && uba_paged(U)
+ * ensures: rv != NULL && uba_snap_size(rv) == uba_size(U)
+ * */
+uba_snap_t uba_snapshot(uba_t U);
+
+/* Return number of entries in snapshot
+ *
+ * requires: S != NULL
+ * */
+size_t uba_snap_size(uba_snap_t S);
+
+/* Return entry at index of snapshot
+ *
+ * requires: S != NULL && 0 <= index && index < uba_snap_size(S)
+ * */
+void *uba_snap_get(uba_snap_t S, size_t index);
+
+/* Release snapshot, dropping its references to U's pages
+ *
+ * requires: S != NULL
+ * */
+void uba_snap_release(uba_snap_t S);
+
+/******************************************************************************/
+/*                                 Fast Paths                                 */
+/******************************************************************************/
+
+/* The hot accessors expand inline unless DS_NO_INLINE is defined. The
+ * out-of-line functions stay exported either way; (uba_get)(U, i) or &uba_get
+ * still reach them.
+ * */
+#ifndef DS_NO_INLINE
+static inline void *uba_get_inline(uba_t U, size_t index) {
+    assert(U != NULL && (U->raw || index < U->size) && index < U->limit);
+
+    /* Paged ubas have no flat data buffer */
+    if (U->data)
+        return U->data[index];
+    return (uba_get)(U, index);
+}
+
+static inline size_t uba_size_inline(uba_t U) {
+    assert(U != NULL && !U->raw);
+    return U->size;
+}
+
+static inline size_t uba_limit_inline(uba_t U) {
+    assert(U != NULL);
+    return U->limit;
+}
+
+#define uba_get(U, index) uba_get_inline((U), (index))
+#define uba_size(U) uba_size_inline(U)
+#define uba_limit(U) uba_limit_inline(U)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
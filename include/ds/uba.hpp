@@ -0,0 +1,204 @@
+#pragma once
+#ifndef UBA_HPP
+#define UBA_HPP
+
+#include "ds/uba.h"
+#include "ds/policy.hpp"
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* ds::uba<T, Free> owns a uba_t of T * entries. It is movable but not
+ * copyable (see clone). Its iterators are random access and, as with
+ * std::vector, are invalidated by anything that grows or shifts the buffer.
+ * As in ll.hpp, dereferencing a mutable iterator gives a proxy that
+ * converts to T * and assigns through the void * slot. Reads and appends
+ * that fit are inline; the rest calls into uba.c. A moved-from array may
+ * only be destroyed or assigned to.
+ * */
+
+namespace ds {
+
+template <typename T, typename Free = no_free>
+class uba {
+public:
+    /* A slot of the buffer, read and written as a T * */
+    class reference {
+    public:
+        explicit reference(void **slot) : slot_(slot) {}
+
+        operator T *() const { return static_cast<T *>(*slot_); }
+        T *operator->() const { return *this; }
+
+        reference &operator=(T *entry) { *slot_ = entry; return *this; }
+        reference &operator=(const reference &o) { *slot_ = *o.slot_; return *this; }
+
+        friend void swap(reference a, reference b) { std::swap(*a.slot_, *b.slot_); }
+
+    private:
+        void **slot_;
+    };
+
+    template <bool Const>
+    class basic_iterator {
+    public:
+        using slot_type = std::conditional_t<Const, void *const *, void **>;
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T *;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::conditional_t<Const, T *, uba::reference>;
+
+        basic_iterator() = default;
+        explicit basic_iterator(slot_type slot) : slot_(slot) {}
+
+        /* iterator converts to const_iterator */
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false> &it) : slot_(it.slot()) {}
+
+        reference operator*() const {
+            if constexpr (Const)
+                return static_cast<T *>(*slot_);
+            else
+                return reference(slot_);
+        }
+        reference operator[](difference_type n) const { return *(*this + n); }
+
+        basic_iterator &operator++() { ++slot_; return *this; }
+        basic_iterator &operator--() { --slot_; return *this; }
+        basic_iterator operator++(int) { return basic_iterator(slot_++); }
+        basic_iterator operator--(int) { return basic_iterator(slot_--); }
+
+        basic_iterator &operator+=(difference_type n) { slot_ += n; return *this; }
+        basic_iterator &operator-=(difference_type n) { slot_ -= n; return *this; }
+        basic_iterator operator+(difference_type n) const { return basic_iterator(slot_ + n); }
+        basic_iterator operator-(difference_type n) const { return basic_iterator(slot_ - n); }
+        friend basic_iterator operator+(difference_type n, const basic_iterator &it) { return it + n; }
+        difference_type operator-(const basic_iterator &o) const { return slot_ - o.slot_; }
+
+        bool operator==(const basic_iterator &o) const { return slot_ == o.slot_; }
+        bool operator!=(const basic_iterator &o) const { return slot_ != o.slot_; }
+        bool operator<(const basic_iterator &o) const { return slot_ < o.slot_; }
+        bool operator>(const basic_iterator &o) const { return slot_ > o.slot_; }
+        bool operator<=(const basic_iterator &o) const { return slot_ <= o.slot_; }
+        bool operator>=(const basic_iterator &o) const { return slot_ >= o.slot_; }
+
+        slot_type slot() const { return slot_; }
+
+    private:
+        slot_type slot_ = nullptr;
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    /* ====== Init and Teardown ====== */
+
+    explicit uba(size_t limit = 16)
+        : U_(uba_new(limit, false, Free::frees ? &free_thunk : nullptr)) {}
+
+    ~uba() {
+        if (U_)
+            uba_free(U_);
+    }
+
+    uba(uba &&o) noexcept : U_(std::exchange(o.U_, nullptr)) {}
+
+    uba &operator=(uba &&o) noexcept {
+        if (this != &o) {
+            if (U_)
+                uba_free(U_);
+            U_ = std::exchange(o.U_, nullptr);
+        }
+        return *this;
+    }
+
+    uba(const uba &) = delete;
+    uba &operator=(const uba &) = delete;
+
+    /* Return an array holding the same entries. Only arrays that do not own
+     * their entries can share them. */
+    uba clone() const {
+        static_assert(!Free::frees, "entries owned by one array cannot be shared");
+        uba copy(U_->limit);
+        for (T *entry : *this)
+            copy.push_back(entry);
+        return copy;
+    }
+
+    /* ====== Accessors ====== */
+
+    iterator begin() { return iterator(U_->data); }
+    iterator end() { return iterator(U_->data + U_->size); }
+    const_iterator begin() const { return const_iterator(U_->data); }
+    const_iterator end() const { return const_iterator(U_->data + U_->size); }
+
+    reference operator[](size_t index) { assert(index < U_->size); return reference(U_->data + index); }
+    T *operator[](size_t index) const { assert(index < U_->size); return static_cast<T *>(U_->data[index]); }
+
+    T *front() const { return (*this)[0]; }
+    T *back() const { return (*this)[U_->size - 1]; }
+
+    size_t size() const { return U_->size; }
+    bool empty() const { return U_->size == 0; }
+    size_t capacity() const { return U_->limit; }
+
+    uba_t handle() const { return U_; }
+
+    /* ====== Modifiers ====== */
+
+    void push_back(T *entry) {
+#ifndef DS_STATS
+        /* uba_push keeps size < limit, so this is the case that does not
+         * resize */
+        if (U_->size + 1 < U_->limit) {
+            U_->data[U_->size++] = entry;
+            return;
+        }
+#endif
+        uba_push(U_, entry);
+    }
+
+    void pop_back() { uba_pop(U_); }
+
+    /* Insert entry before pos and return an iterator to it */
+    iterator insert(const_iterator pos, T *entry) {
+        size_t index = pos.slot() - U_->data;
+        uba_insert(U_, index, entry);
+        return begin() + index;
+    }
+
+    /* Remove (and release) the entry at pos and return the one after it */
+    iterator erase(const_iterator pos) {
+        size_t index = pos.slot() - U_->data;
+        uba_remove(U_, index);
+        return begin() + index;
+    }
+
+    /* Make room for n entries without resizing */
+    void reserve(size_t n) {
+        if (n >= U_->limit)
+            uba_resize(U_, n + 1);
+    }
+
+    void clear() {
+        while (!empty())
+            uba_pop(U_);
+    }
+
+private:
+    static void free_thunk(void *entry) { Free::release(entry); }
+
+    uba_t U_;
+};
+
+} // namespace ds
+
+#endif
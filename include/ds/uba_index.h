@@ -0,0 +1,81 @@
+#pragma once
+#ifndef UBA_INDEX_H
+#define UBA_INDEX_H
+
+#include "ds/uba.h"
+#include <stddef.h>
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+typedef struct uba_Index *uba_index_t;
+
+/* Searches uba_index_rank_n runs in lockstep, so their cache misses overlap */
+#define UBA_INDEX_BATCH 16
+
+/* A sorted uba's entries in Eytzinger (BFS) order: the children of node k
+ * are 2k and 2k + 1, so the top levels share a few cache lines and the
+ * sixteen nodes four levels below k are contiguous and prefetched together.
+ * Node 0 is unused. A node's index in the uba follows from its position, so
+ * the index takes one pointer per entry. */
+struct uba_Index {
+    void **node;
+    size_t size;
+    unsigned depth;     /* Levels of the tree, the last one possibly partial */
+    uba_cmp_fn *cmp;
+};
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* ====== Init and Teardown ====== */
+
+/* Return an immutable search index over the entries of U, which must be
+ * sorted in ascending cmp order. The index shares U's entries but not its
+ * storage, so U may change or be freed while the entries live. A NULL cmp
+ * compares the entries themselves as unsigned integers.
+ *
+ * requires: U != NULL && !uba_raw(U) && !uba_paged(U)
+ * ensures: rv != NULL && uba_index_size(rv) == uba_size(U)
+ * */
+uba_index_t uba_build_index(uba_t U, uba_cmp_fn *cmp);
+
+/* Free I, leaving its entries alone
+ *
+ * requires: I != NULL
+ * */
+void uba_index_free(uba_index_t I);
+
+/* ====== Queries ====== */
+
+/* Return the number of entries in I
+ *
+ * requires: I != NULL
+ * */
+size_t uba_index_size(uba_index_t I);
+
+/* Return the index in the uba of the first entry not below key, or
+ * uba_index_size(I) if there is none. Takes the same number of steps for
+ * every key, with no branch on the comparisons.
+ *
+ * requires: I != NULL
+ * ensures: rv <= uba_index_size(I)
+ * */
+size_t uba_index_rank(uba_index_t I, void *key);
+
+/* Return the entry equal to key, or NULL if there is none
+ *
+ * requires: I != NULL
+ * */
+void *uba_index_find(uba_index_t I, void *key);
+
+/* Store uba_index_rank(I, keys[i]) in ranks[i] for every i < n, searching
+ * for up to UBA_INDEX_BATCH keys at once
+ *
+ * requires: I != NULL && (n == 0 || (keys != NULL && ranks != NULL))
+ * */
+void uba_index_rank_n(uba_index_t I, void **keys, size_t *ranks, size_t n);
+
+#endif
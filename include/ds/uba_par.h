@@ -0,0 +1,95 @@
+#pragma once
+#ifndef UBA_PAR_H
+#define UBA_PAR_H
+
+#include "ds/pool.h"
+#include "ds/uba.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/******************************************************************************/
+/*                              Client Interface                              */
+/******************************************************************************/
+
+/* The algorithms below split the entries of an uba (indices below uba_size, or
+ * below uba_limit for raw ubas) into chunks sized by pool_grain and run the
+ * callbacks on them from several threads at once, so callbacks must be safe to
+ * call concurrently on different entries. Passing a NULL pool uses
+ * pool_default().
+ * */
+
+/* Process entry at index */
+typedef void uba_visit_fn(void *entry, size_t index, void *context);
+
+/* Return the entry that replaces entry */
+typedef void *uba_map_fn(void *entry, void *context);
+
+/* Fold entry into the accumulator acc */
+typedef void uba_fold_fn(void *acc, void *entry, void *context);
+
+/* Fold the accumulator other, which covers entries after those of acc, into
+ * acc. Must be associative.
+ * */
+typedef void uba_combine_fn(void *acc, void *other, void *context);
+
+/* Return whether entry is kept */
+typedef bool uba_pred_fn(void *entry, void *context);
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* Run fn on every entry of U
+ *
+ * requires: U != NULL && !uba_paged(U) && fn != NULL
+ * */
+void uba_foreach_parallel(pool_t P, uba_t U, uba_visit_fn *fn, void *context);
+
+/* Replace every entry of U with fn(entry). fn owns the old entry.
+ *
+ * requires: U != NULL && !uba_paged(U) && fn != NULL
+ * */
+void uba_map_parallel(pool_t P, uba_t U, uba_map_fn *fn, void *context);
+
+/* Return a new uba holding fn(entry) for every entry of U, in order; U is not
+ * changed
+ *
+ * requires: U != NULL && !uba_paged(U) && fn != NULL
+ * ensures: rv != NULL && !uba_raw(rv) && uba_size(rv) == number of entries of U
+ * */
+uba_t uba_map_new_parallel(pool_t P,
+                           uba_t U,
+                           uba_map_fn *fn,
+                           void *context,
+                           uba_entry_free_fn *entry_free);
+
+/* Reduce U into acc, which holds acc_size bytes. On entry acc must hold an
+ * identity value for combine; every chunk starts from a copy of it, folds its
+ * entries in with fold and the chunk results are combined into acc in index
+ * order.
+ *
+ * requires: U != NULL && !uba_paged(U) && acc != NULL && 0 < acc_size
+ *           && fold != NULL && combine != NULL
+ * */
+void uba_reduce_parallel(pool_t P,
+                         uba_t U,
+                         void *acc,
+                         size_t acc_size,
+                         uba_fold_fn *fold,
+                         uba_combine_fn *combine,
+                         void *context);
+
+/* Return a new uba holding the entries of U for which pred returns true, in
+ * order. The entries are shared with U, so at most one of them should have an
+ * entry_free.
+ *
+ * requires: U != NULL && !uba_paged(U) && pred != NULL
+ * ensures: rv != NULL && !uba_raw(rv)
+ * */
+uba_t uba_filter_parallel(pool_t P,
+                          uba_t U,
+                          uba_pred_fn *pred,
+                          void *context,
+                          uba_entry_free_fn *entry_free);
+
+#endif
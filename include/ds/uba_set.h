@@ -0,0 +1,58 @@
+#pragma once
+#ifndef UBA_SET_H
+#define UBA_SET_H
+
+#include "ds/uba.h"
+#include <stddef.h>
+
+/******************************************************************************/
+/*                               Implementation                               */
+/******************************************************************************/
+
+/* Size ratio from which the routines stop walking the larger input and
+ * instead gallop (exponential then binary search) through it */
+#define UBA_SET_GALLOP 16
+
+/******************************************************************************/
+/*                             Library Interface                              */
+/******************************************************************************/
+
+/* The routines below read the entries of A and B, which must be sorted in
+ * ascending cmp order, and append their result, also sorted, to R. R grows
+ * only if its limit is too small for the largest possible result, so a
+ * preallocated R is written in place. Entries are shared with A and B, so at
+ * most one of the three ubas should have an entry_free.
+ *
+ * Passing a NULL cmp compares the entries themselves as unsigned integers,
+ * for ubas of integer handles stored as pointers. uba_intersect then uses a
+ * SIMD fast path where the CPU supports it.
+ * */
+
+/* Append every entry of A and B to R; entries of A go first among equals
+ *
+ * requires: A != NULL && B != NULL && R != NULL && R != A && R != B
+ *              && !uba_raw(A) && !uba_raw(B) && !uba_raw(R)
+ *              && !uba_paged(A) && !uba_paged(B) && !uba_paged(R)
+ * ensures: uba_size(R) grows by uba_size(A) + uba_size(B)
+ * */
+void uba_merge(uba_t R, uba_t A, uba_t B, uba_cmp_fn *cmp);
+
+/* Append the entries found in A or B to R, taking A's entry when both have it
+ *
+ * requires: as uba_merge, and A and B hold no duplicates
+ * */
+void uba_union(uba_t R, uba_t A, uba_t B, uba_cmp_fn *cmp);
+
+/* Append the entries of A that are also in B to R
+ *
+ * requires: as uba_merge, and A and B hold no duplicates
+ * */
+void uba_intersect(uba_t R, uba_t A, uba_t B, uba_cmp_fn *cmp);
+
+/* Append the entries of A that are not in B to R
+ *
+ * requires: as uba_merge, and A and B hold no duplicates
+ * */
+void uba_difference(uba_t R, uba_t A, uba_t B, uba_cmp_fn *cmp);
+
+#endif
@@ -0,0 +1,585 @@
+#include "ds/bpt.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Minimum keys in any node but the root */
+#define BPT_MIN (BPT_ORDER / 2)
+#define BPT_MAX_HEIGHT 32
+#define BPT_LINE 64
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+
+/* Internal nodes: children[i] holds keys < keys[i] <= keys of children[i + 1].
+ * Separators are key pointers of entries in the tree, so bpt_rekey replaces
+ * them before their entry goes away. Leaves are chained through prev/next. */
+struct bpt_Node {
+    bool leaf;
+    int n;
+
+    struct bpt_Node *prev;
+    struct bpt_Node *next;
+
+    void *keys[BPT_ORDER];
+    union {
+        void *entries[BPT_ORDER];
+        struct bpt_Node *children[BPT_ORDER + 1];
+    };
+};
+
+/* Nodes and child indices from the root down to a leaf's parent */
+struct bpt_Path {
+    struct bpt_Node *node[BPT_MAX_HEIGHT];
+    int index[BPT_MAX_HEIGHT];
+};
+
+/******************************************************************************/
+/*                                  Helpers                                   */
+/******************************************************************************/
+
+static struct bpt_Node *bpt_node_new(bool leaf) {
+    size_t size = (sizeof(struct bpt_Node) + BPT_LINE - 1) & ~(size_t)(BPT_LINE - 1);
+    struct bpt_Node *N = aligned_alloc(BPT_LINE, size);
+
+    N->leaf = leaf;
+    N->n = 0;
+    N->prev = NULL;
+    N->next = NULL;
+    return N;
+}
+
+/* First index whose key is >= key */
+static int bpt_lower(bpt_t T, struct bpt_Node *N, void *key) {
+    int lo = 0, hi = N->n;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (T->key_cmp(N->keys[mid], key) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* First index whose key is > key, i.e. the child to descend into */
+static int bpt_upper(bpt_t T, struct bpt_Node *N, void *key) {
+    int lo = 0, hi = N->n;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (T->key_cmp(N->keys[mid], key) <= 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Return the leaf that would hold key, recording the way down if path */
+static struct bpt_Node *bpt_descend(bpt_t T, void *key, struct bpt_Path *path) {
+    struct bpt_Node *N = T->root;
+
+    for (int depth = 0; !N->leaf; depth++) {
+        int i = bpt_upper(T, N, key);
+        if (path) {
+            path->node[depth] = N;
+            path->index[depth] = i;
+        }
+        N = N->children[i];
+    }
+    return N;
+}
+
+static struct bpt_Node *bpt_edge_leaf(struct bpt_Node *N, bool last) {
+    while (!N->leaf)
+        N = N->children[last ? N->n : 0];
+    return N;
+}
+
+/* Replace every separator equal to old_key with new_key, or with the smallest
+ * key to its right if new_key is NULL */
+static void bpt_rekey(bpt_t T, void *old_key, void *new_key) {
+    struct bpt_Node *N = T->root;
+
+    while (!N->leaf) {
+        int i = bpt_upper(T, N, old_key);
+        if (i > 0 && T->key_cmp(N->keys[i - 1], old_key) == 0)
+            N->keys[i - 1] = new_key ? new_key
+                                     : bpt_edge_leaf(N->children[i], false)->keys[0];
+        N = N->children[i];
+    }
+}
+
+/* Insert sep and right child R next to the child at depth in path, splitting
+ * parents as needed */
+static void bpt_insert_parent(bpt_t T,
+                              struct bpt_Path *path,
+                              int depth,
+                              void *sep,
+                              struct bpt_Node *R) {
+    if (depth == 0) {
+        struct bpt_Node *root = bpt_node_new(false);
+        root->n = 1;
+        root->keys[0] = sep;
+        root->children[0] = T->root;
+        root->children[1] = R;
+
+        T->root = root;
+        T->height++;
+        return;
+    }
+
+    struct bpt_Node *P = path->node[depth - 1];
+    int ci = path->index[depth - 1];
+
+    if (P->n < BPT_ORDER) {
+        memmove(&P->keys[ci + 1], &P->keys[ci], sizeof(void *) * (P->n - ci));
+        memmove(&P->children[ci + 2], &P->children[ci + 1],
+                sizeof(void *) * (P->n - ci));
+        P->keys[ci] = sep;
+        P->children[ci + 1] = R;
+        P->n++;
+        return;
+    }
+
+    /* Split: the left half keeps BPT_MIN keys and the middle key moves up */
+    void *keys[BPT_ORDER + 1];
+    struct bpt_Node *children[BPT_ORDER + 2];
+
+    memcpy(keys, P->keys, sizeof(void *) * ci);
+    keys[ci] = sep;
+    memcpy(&keys[ci + 1], &P->keys[ci], sizeof(void *) * (BPT_ORDER - ci));
+
+    memcpy(children, P->children, sizeof(void *) * (ci + 1));
+    children[ci + 1] = R;
+    memcpy(&children[ci + 2], &P->children[ci + 1],
+           sizeof(void *) * (BPT_ORDER - ci));
+
+    struct bpt_Node *PR = bpt_node_new(false);
+    P->n = BPT_MIN;
+    PR->n = BPT_ORDER - BPT_MIN;
+
+    memcpy(P->keys, keys, sizeof(void *) * P->n);
+    memcpy(P->children, children, sizeof(void *) * (P->n + 1));
+    memcpy(PR->keys, &keys[BPT_MIN + 1], sizeof(void *) * PR->n);
+    memcpy(PR->children, &children[BPT_MIN + 1], sizeof(void *) * (PR->n + 1));
+
+    bpt_insert_parent(T, path, depth - 1, keys[BPT_MIN], PR);
+}
+
+/* Split full leaf N while inserting entry at pos, returning the new right leaf */
+static struct bpt_Node *bpt_split_leaf(struct bpt_Node *N,
+                                       int pos,
+                                       void *key,
+                                       void *entry) {
+    void *keys[BPT_ORDER + 1];
+    void *entries[BPT_ORDER + 1];
+
+    memcpy(keys, N->keys, sizeof(void *) * pos);
+    memcpy(entries, N->entries, sizeof(void *) * pos);
+    keys[pos] = key;
+    entries[pos] = entry;
+    memcpy(&keys[pos + 1], &N->keys[pos], sizeof(void *) * (BPT_ORDER - pos));
+    memcpy(&entries[pos + 1], &N->entries[pos],
+           sizeof(void *) * (BPT_ORDER - pos));
+
+    struct bpt_Node *R = bpt_node_new(true);
+    N->n = (BPT_ORDER + 1) / 2;
+    R->n = BPT_ORDER + 1 - N->n;
+
+    memcpy(N->keys, keys, sizeof(void *) * N->n);
+    memcpy(N->entries, entries, sizeof(void *) * N->n);
+    memcpy(R->keys, &keys[N->n], sizeof(void *) * R->n);
+    memcpy(R->entries, &entries[N->n], sizeof(void *) * R->n);
+
+    R->next = N->next;
+    R->prev = N;
+    if (R->next)
+        R->next->prev = R;
+    N->next = R;
+
+    return R;
+}
+
+/* Remove key k and child k + 1 of P */
+static void bpt_remove_child(struct bpt_Node *P, int k) {
+    memmove(&P->keys[k], &P->keys[k + 1], sizeof(void *) * (P->n - k - 1));
+    memmove(&P->children[k + 1], &P->children[k + 2],
+            sizeof(void *) * (P->n - k - 1));
+    P->n--;
+}
+
+/* Append B (the right neighbour of A) to A and free B; sep separates them */
+static void bpt_merge(struct bpt_Node *A, void *sep, struct bpt_Node *B) {
+    if (A->leaf) {
+        memcpy(&A->keys[A->n], B->keys, sizeof(void *) * B->n);
+        memcpy(&A->entries[A->n], B->entries, sizeof(void *) * B->n);
+        A->n += B->n;
+
+        A->next = B->next;
+        if (A->next)
+            A->next->prev = A;
+    } else {
+        A->keys[A->n] = sep;
+        memcpy(&A->keys[A->n + 1], B->keys, sizeof(void *) * B->n);
+        memcpy(&A->children[A->n + 1], B->children,
+               sizeof(void *) * (B->n + 1));
+        A->n += B->n + 1;
+    }
+    free(B);
+}
+
+/* Move the last key of L (N's left neighbour under P) to the front of N */
+static void bpt_borrow_left(struct bpt_Node *P,
+                            int ci,
+                            struct bpt_Node *L,
+                            struct bpt_Node *N) {
+    memmove(&N->keys[1], N->keys, sizeof(void *) * N->n);
+
+    if (N->leaf) {
+        memmove(&N->entries[1], N->entries, sizeof(void *) * N->n);
+        N->keys[0] = L->keys[L->n - 1];
+        N->entries[0] = L->entries[L->n - 1];
+        P->keys[ci - 1] = N->keys[0];
+    } else {
+        memmove(&N->children[1], N->children, sizeof(void *) * (N->n + 1));
+        N->keys[0] = P->keys[ci - 1];
+        N->children[0] = L->children[L->n];
+        P->keys[ci - 1] = L->keys[L->n - 1];
+    }
+
+    L->n--;
+    N->n++;
+}
+
+/* Move the first key of R (N's right neighbour under P) to the end of N */
+static void bpt_borrow_right(struct bpt_Node *P,
+                             int ci,
+                             struct bpt_Node *N,
+                             struct bpt_Node *R) {
+    if (N->leaf) {
+        N->keys[N->n] = R->keys[0];
+        N->entries[N->n] = R->entries[0];
+        memmove(R->entries, &R->entries[1], sizeof(void *) * (R->n - 1));
+        memmove(R->keys, &R->keys[1], sizeof(void *) * (R->n - 1));
+        P->keys[ci] = R->keys[0];
+    } else {
+        N->keys[N->n] = P->keys[ci];
+        N->children[N->n + 1] = R->children[0];
+        P->keys[ci] = R->keys[0];
+        memmove(R->keys, &R->keys[1], sizeof(void *) * (R->n - 1));
+        memmove(R->children, &R->children[1], sizeof(void *) * R->n);
+    }
+
+    N->n++;
+    R->n--;
+}
+
+/* Restore the minimum fill of N (at depth in path) after a removal */
+static void bpt_rebalance(bpt_t T,
+                          struct bpt_Path *path,
+                          int depth,
+                          struct bpt_Node *N) {
+    if (depth == 0) {
+        if (!N->leaf && N->n == 0) {
+            T->root = N->children[0];
+            T->height--;
+            free(N);
+        }
+        return;
+    }
+
+    if (N->n >= BPT_MIN)
+        return;
+
+    struct bpt_Node *P = path->node[depth - 1];
+    int ci = path->index[depth - 1];
+    struct bpt_Node *L = ci > 0 ? P->children[ci - 1] : NULL;
+    struct bpt_Node *R = ci < P->n ? P->children[ci + 1] : NULL;
+
+    if (L && L->n > BPT_MIN) {
+        bpt_borrow_left(P, ci, L, N);
+        return;
+    }
+    if (R && R->n > BPT_MIN) {
+        bpt_borrow_right(P, ci, N, R);
+        return;
+    }
+
+    if (L) {
+        bpt_merge(L, P->keys[ci - 1], N);
+        bpt_remove_child(P, ci - 1);
+    } else {
+        bpt_merge(N, P->keys[ci], R);
+        bpt_remove_child(P, ci);
+    }
+
+    bpt_rebalance(T, path, depth - 1, P);
+}
+
+static void bpt_free_node(bpt_t T, struct bpt_Node *N) {
+    if (N->leaf) {
+        if (T->entry_free) {
+            for (int i = 0; i < N->n; i++)
+                T->entry_free(N->entries[i]);
+        }
+    } else {
+        for (int i = 0; i <= N->n; i++)
+            bpt_free_node(T, N->children[i]);
+    }
+    free(N);
+}
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+/*                              Init & Teardown                               */
+/******************************************************************************/
+
+bpt_t bpt_new(ll_key_cmp_fn *key_cmp,
+              ll_entry_key_fn *entry_key,
+              ll_entry_free_fn *entry_free) {
+    assert(key_cmp && entry_key);
+    struct bpt_Header *T = malloc(sizeof(*T));
+
+    T->root = bpt_node_new(true);
+    T->size = 0;
+    T->height = 1;
+
+    T->key_cmp = key_cmp;
+    T->entry_key = entry_key;
+    T->entry_free = entry_free;
+
+    return T;
+}
+
+bpt_t bpt_from_uba(uba_t U,
+                   ll_key_cmp_fn *key_cmp,
+                   ll_entry_key_fn *entry_key,
+                   ll_entry_free_fn *entry_free) {
+    assert(U != NULL && !uba_raw(U));
+    bpt_t T = bpt_new(key_cmp, entry_key, entry_free);
+    size_t n = uba_size(U);
+
+    if (n == 0)
+        return T;
+
+    /* Spread entries evenly so every node but the root stays above BPT_MIN */
+    size_t count = (n + BPT_ORDER - 1) / BPT_ORDER;
+    struct bpt_Node **level = malloc(sizeof(*level) * count);
+    void **mins = malloc(sizeof(*mins) * count);
+    struct bpt_Node *prev = NULL;
+    size_t e = 0;
+
+    free(T->root);
+
+    for (size_t l = 0; l < count; l++) {
+        struct bpt_Node *N = bpt_node_new(true);
+        N->n = n / count + (l < n % count);
+
+        for (int i = 0; i < N->n; i++, e++) {
+            N->entries[i] = uba_get(U, e);
+            N->keys[i] = entry_key(N->entries[i]);
+            assert(e == 0 || key_cmp(entry_key(uba_get(U, e - 1)), N->keys[i]) < 0);
+        }
+
+        N->prev = prev;
+        if (prev)
+            prev->next = N;
+        prev = N;
+
+        level[l] = N;
+        mins[l] = N->keys[0];
+    }
+
+    /* Build each parent level in place over the one below */
+    while (count > 1) {
+        size_t parents = (count + BPT_ORDER) / (BPT_ORDER + 1);
+        size_t c = 0;
+
+        for (size_t p = 0; p < parents; p++) {
+            struct bpt_Node *N = bpt_node_new(false);
+            int children = count / parents + (p < count % parents);
+            void *min = mins[c];
+
+            for (int i = 0; i < children; i++, c++) {
+                N->children[i] = level[c];
+                if (i > 0)
+                    N->keys[i - 1] = mins[c];
+            }
+            N->n = children - 1;
+
+            level[p] = N;
+            mins[p] = min;
+        }
+
+        count = parents;
+        T->height++;
+    }
+
+    T->root = level[0];
+    T->size = n;
+
+    free(level);
+    free(mins);
+    return T;
+}
+
+void bpt_free(bpt_t T) {
+    assert(T != NULL);
+    bpt_free_node(T, T->root);
+    free(T);
+}
+
+/******************************************************************************/
+/*                                 Accessors                                  */
+/******************************************************************************/
+
+void *bpt_get(bpt_t T, void *key) {
+    assert(T != NULL);
+    struct bpt_Node *N = bpt_descend(T, key, NULL);
+    int pos = bpt_lower(T, N, key);
+
+    if (pos < N->n && T->key_cmp(N->keys[pos], key) == 0)
+        return N->entries[pos];
+    return NULL;
+}
+
+size_t bpt_size(bpt_t T) {
+    assert(T != NULL);
+    return T->size;
+}
+
+bool bpt_empty(bpt_t T) {
+    assert(T != NULL);
+    return !T->size;
+}
+
+void bpt_range(bpt_t T, struct bpt_Cursor *C, void *lo, void *hi, bool rev) {
+    assert(T != NULL && C != NULL);
+
+    C->T = T;
+    C->rev = rev;
+
+    if (!rev) {
+        C->end = hi;
+        C->leaf = lo ? bpt_descend(T, lo, NULL) : bpt_edge_leaf(T->root, false);
+        C->index = lo ? bpt_lower(T, C->leaf, lo) : 0;
+    } else {
+        C->end = lo;
+        C->leaf = hi ? bpt_descend(T, hi, NULL) : bpt_edge_leaf(T->root, true);
+        C->index = (hi ? bpt_upper(T, C->leaf, hi) : C->leaf->n) - 1;
+    }
+}
+
+void *bpt_next(struct bpt_Cursor *C) {
+    assert(C != NULL);
+
+    /* Step over leaf boundaries (and empty leaves) */
+    while (C->leaf && (C->index < 0 || C->index >= C->leaf->n)) {
+        C->leaf = C->rev ? C->leaf->prev : C->leaf->next;
+        if (C->leaf)
+            C->index = C->rev ? C->leaf->n - 1 : 0;
+    }
+
+    if (!C->leaf)
+        return NULL;
+
+    if (C->end) {
+        int rv = C->T->key_cmp(C->leaf->keys[C->index], C->end);
+        if (C->rev ? rv < 0 : rv > 0) {
+            C->leaf = NULL;
+            return NULL;
+        }
+    }
+
+    void *entry = C->leaf->entries[C->index];
+    C->index += C->rev ? -1 : 1;
+    return entry;
+}
+
+/******************************************************************************/
+/*                                  Mutators                                  */
+/******************************************************************************/
+
+int bpt_insert(bpt_t T, void *entry) {
+    assert(T != NULL && entry);
+    void *key = T->entry_key(entry);
+    struct bpt_Path path;
+    struct bpt_Node *N = bpt_descend(T, key, &path);
+    int pos = bpt_lower(T, N, key);
+
+    if (pos < N->n && T->key_cmp(N->keys[pos], key) == 0)
+        return 1;
+
+    if (N->n < BPT_ORDER) {
+        memmove(&N->keys[pos + 1], &N->keys[pos], sizeof(void *) * (N->n - pos));
+        memmove(&N->entries[pos + 1], &N->entries[pos],
+                sizeof(void *) * (N->n - pos));
+        N->keys[pos] = key;
+        N->entries[pos] = entry;
+        N->n++;
+    } else {
+        struct bpt_Node *R = bpt_split_leaf(N, pos, key, entry);
+        bpt_insert_parent(T, &path, T->height - 1, R->keys[0], R);
+    }
+
+    T->size++;
+    return 0;
+}
+
+int bpt_del(bpt_t T, void *key) {
+    assert(T != NULL);
+    struct bpt_Path path;
+    struct bpt_Node *N = bpt_descend(T, key, &path);
+    int pos = bpt_lower(T, N, key);
+
+    if (pos >= N->n || T->key_cmp(N->keys[pos], key) != 0)
+        return 1;
+
+    void *entry = N->entries[pos];
+    void *old_key = N->keys[pos];
+
+    memmove(&N->keys[pos], &N->keys[pos + 1], sizeof(void *) * (N->n - pos - 1));
+    memmove(&N->entries[pos], &N->entries[pos + 1],
+            sizeof(void *) * (N->n - pos - 1));
+    N->n--;
+    T->size--;
+
+    bpt_rebalance(T, &path, T->height - 1, N);
+
+    /* The entry (and its key) must outlive every separator pointing at it */
+    bpt_rekey(T, old_key, NULL);
+    if (T->entry_free)
+        T->entry_free(entry);
+
+    return 0;
+}
+
+void *bpt_update(bpt_t T, void *key, void *new_entry, bool free_old) {
+    assert(T != NULL && new_entry);
+    struct bpt_Node *N = bpt_descend(T, key, NULL);
+    int pos = bpt_lower(T, N, key);
+
+    if (pos >= N->n || T->key_cmp(N->keys[pos], key) != 0)
+        return NULL;
+
+    void *old = N->entries[pos];
+    void *old_key = N->keys[pos];
+
+    N->entries[pos] = new_entry;
+    N->keys[pos] = T->entry_key(new_entry);
+    assert(T->key_cmp(N->keys[pos], old_key) == 0);
+    bpt_rekey(T, old_key, N->keys[pos]);
+
+    if (free_old && T->entry_free) {
+        T->entry_free(old);
+        return NULL;
+    }
+    return old;
+}
@@ -0,0 +1,358 @@
+#include "ds/bufc.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+/*                                  Segments                                  */
+/******************************************************************************/
+
+/* Segment holding up to cap bytes inline */
+static struct bufc_Seg *bufc_seg_new(size_t cap) {
+    struct bufc_Seg *S = malloc(sizeof(*S) + cap);
+
+    atomic_init(&S->refs, 1);
+    S->data = S->bytes;
+    S->cap = cap;
+    S->fill = 0;
+    S->release = NULL;
+
+    return S;
+}
+
+/* Segment referring to the caller's bytes */
+static struct bufc_Seg *bufc_seg_wrap(void *data, size_t len,
+                                      bufc_release_fn *release) {
+    struct bufc_Seg *S = malloc(sizeof(*S));
+
+    atomic_init(&S->refs, 1);
+    S->data = data;
+    S->cap = len;
+    S->fill = len;
+    S->release = release;
+
+    return S;
+}
+
+static void bufc_seg_ref(struct bufc_Seg *S) {
+    atomic_fetch_add_explicit(&S->refs, 1, memory_order_relaxed);
+}
+
+static void bufc_seg_unref(struct bufc_Seg *S) {
+    if (atomic_fetch_sub_explicit(&S->refs, 1, memory_order_acq_rel) != 1)
+        return;
+
+    if (S->release)
+        S->release(S->data);
+    free(S);
+}
+
+/******************************************************************************/
+/*                                   Views                                    */
+/******************************************************************************/
+
+static struct bufc_View *bufc_view_new(struct bufc_Seg *S, size_t off, size_t len) {
+    struct bufc_View *V = malloc(sizeof(*V));
+
+    V->next = NULL;
+    V->seg = S;
+    V->off = off;
+    V->len = len;
+
+    return V;
+}
+
+static void bufc_push_tail(bufc_t B, struct bufc_View *V) {
+    V->next = NULL;
+    if (B->tail)
+        B->tail->next = V;
+    else
+        B->head = V;
+    B->tail = V;
+
+    B->len += V->len;
+    B->nviews++;
+}
+
+/* Detach the head view of B and return it */
+static struct bufc_View *bufc_pop_head(bufc_t B) {
+    struct bufc_View *V = B->head;
+
+    B->head = V->next;
+    if (!B->head)
+        B->tail = NULL;
+
+    B->len -= V->len;
+    B->nviews--;
+    return V;
+}
+
+/* Return the bytes that may still be written after the last view of B: only
+ * an inline segment that B alone refers to, and only right after its fill */
+static size_t bufc_slack(bufc_t B) {
+    struct bufc_View *V = B->tail;
+
+    if (!V || V->seg->data != V->seg->bytes || V->off + V->len != V->seg->fill
+            || atomic_load_explicit(&V->seg->refs, memory_order_acquire) != 1)
+        return 0;
+    return V->seg->cap - V->seg->fill;
+}
+
+/* Extend the last view of B over n bytes just written into its slack */
+static void bufc_grow_tail(bufc_t B, size_t n) {
+    B->tail->len += n;
+    B->tail->seg->fill += n;
+    B->len += n;
+}
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+/*                            Init and Teardown                               */
+/******************************************************************************/
+
+bufc_t bufc_new(void) {
+    struct bufc_Header *B = malloc(sizeof(*B));
+
+    B->head = NULL;
+    B->tail = NULL;
+    B->len = 0;
+    B->nviews = 0;
+
+    return B;
+}
+
+void bufc_free(bufc_t B) {
+    assert(B != NULL);
+
+    while (B->head) {
+        struct bufc_View *V = bufc_pop_head(B);
+        bufc_seg_unref(V->seg);
+        free(V);
+    }
+    free(B);
+}
+
+/******************************************************************************/
+/*                                 Accessors                                  */
+/******************************************************************************/
+
+size_t bufc_len(bufc_t B) {
+    assert(B != NULL);
+    return B->len;
+}
+
+size_t bufc_views(bufc_t B) {
+    assert(B != NULL);
+    return B->nviews;
+}
+
+size_t bufc_peek(bufc_t B, size_t off, void *dst, size_t len) {
+    assert(B != NULL && (dst != NULL || len == 0) && off <= B->len);
+    unsigned char *out = dst;
+    size_t copied = 0;
+
+    for (struct bufc_View *V = B->head; V && copied < len; V = V->next) {
+        if (off >= V->len) {
+            off -= V->len;
+            continue;
+        }
+
+        size_t n = V->len - off < len - copied ? V->len - off : len - copied;
+        memcpy(out + copied, V->seg->data + V->off + off, n);
+        copied += n;
+        off = 0;
+    }
+    return copied;
+}
+
+size_t bufc_iovec(bufc_t B, struct iovec *iov, size_t max) {
+    assert(B != NULL && (iov != NULL || max == 0));
+    size_t n = 0;
+
+    for (struct bufc_View *V = B->head; V && n < max; V = V->next, n++) {
+        iov[n].iov_base = V->seg->data + V->off;
+        iov[n].iov_len = V->len;
+    }
+    return n;
+}
+
+/******************************************************************************/
+/*                                  Building                                  */
+/******************************************************************************/
+
+void bufc_append(bufc_t B, void *data, size_t len, bufc_release_fn *release) {
+    assert(B != NULL && data != NULL && 0 < len);
+    bufc_push_tail(B, bufc_view_new(bufc_seg_wrap(data, len, release), 0, len));
+}
+
+void bufc_prepend(bufc_t B, void *data, size_t len, bufc_release_fn *release) {
+    assert(B != NULL && data != NULL && 0 < len);
+    struct bufc_View *V = bufc_view_new(bufc_seg_wrap(data, len, release), 0, len);
+
+    V->next = B->head;
+    B->head = V;
+    if (!B->tail)
+        B->tail = V;
+
+    B->len += len;
+    B->nviews++;
+}
+
+void bufc_append_copy(bufc_t B, const void *data, size_t len) {
+    assert(B != NULL && (data != NULL || len == 0));
+    size_t take = bufc_slack(B);
+
+    take = take < len ? take : len;
+    if (take) {
+        memcpy(B->tail->seg->data + B->tail->seg->fill, data, take);
+        bufc_grow_tail(B, take);
+    }
+
+    len -= take;
+    if (len == 0)
+        return;
+
+    struct bufc_Seg *S = bufc_seg_new(len < BUFC_MIN_SEG ? BUFC_MIN_SEG : len);
+    memcpy(S->data, (const unsigned char *)data + take, len);
+    S->fill = len;
+    bufc_push_tail(B, bufc_view_new(S, 0, len));
+}
+
+void bufc_concat(bufc_t B, bufc_t C) {
+    assert(B != NULL && C != NULL && B != C);
+
+    if (!C->head)
+        return;
+
+    if (B->tail)
+        B->tail->next = C->head;
+    else
+        B->head = C->head;
+    B->tail = C->tail;
+    B->len += C->len;
+    B->nviews += C->nviews;
+
+    C->head = NULL;
+    C->tail = NULL;
+    C->len = 0;
+    C->nviews = 0;
+}
+
+bufc_t bufc_split(bufc_t B, size_t n) {
+    assert(B != NULL && n <= B->len);
+    bufc_t R = bufc_new();
+
+    /* Whole views change chains; only a view straddling the cut is shared */
+    while (n > 0 && n >= B->head->len) {
+        n -= B->head->len;
+        bufc_push_tail(R, bufc_pop_head(B));
+    }
+
+    if (n > 0) {
+        struct bufc_View *V = B->head;
+
+        bufc_seg_ref(V->seg);
+        bufc_push_tail(R, bufc_view_new(V->seg, V->off, n));
+        V->off += n;
+        V->len -= n;
+        B->len -= n;
+    }
+    return R;
+}
+
+bufc_t bufc_slice(bufc_t B, size_t off, size_t len) {
+    assert(B != NULL && off <= B->len && len <= B->len - off);
+    bufc_t R = bufc_new();
+
+    for (struct bufc_View *V = B->head; V && len > 0; V = V->next) {
+        if (off >= V->len) {
+            off -= V->len;
+            continue;
+        }
+
+        size_t n = V->len - off < len ? V->len - off : len;
+        bufc_seg_ref(V->seg);
+        bufc_push_tail(R, bufc_view_new(V->seg, V->off + off, n));
+        len -= n;
+        off = 0;
+    }
+    return R;
+}
+
+void bufc_consume(bufc_t B, size_t n) {
+    assert(B != NULL && n <= B->len);
+
+    while (n > 0 && n >= B->head->len) {
+        struct bufc_View *V = bufc_pop_head(B);
+
+        n -= V->len;
+        bufc_seg_unref(V->seg);
+        free(V);
+    }
+
+    if (n > 0) {
+        B->head->off += n;
+        B->head->len -= n;
+        B->len -= n;
+    }
+}
+
+/******************************************************************************/
+/*                                    I/O                                     */
+/******************************************************************************/
+
+ssize_t bufc_writev(bufc_t B, int fd) {
+    assert(B != NULL && 0 <= fd);
+    struct iovec iov[BUFC_IOV_MAX];
+    size_t n = bufc_iovec(B, iov, BUFC_IOV_MAX);
+
+    if (n == 0)
+        return 0;
+
+    ssize_t written = writev(fd, iov, n);
+    if (written > 0)
+        bufc_consume(B, written);
+    return written;
+}
+
+ssize_t bufc_readv(bufc_t B, int fd, size_t max) {
+    assert(B != NULL && 0 <= fd && 0 < max);
+    struct iovec iov[2];
+    int n = 0;
+
+    size_t slack = bufc_slack(B);
+    slack = slack < max ? slack : max;
+    if (slack) {
+        iov[n].iov_base = B->tail->seg->data + B->tail->seg->fill;
+        iov[n++].iov_len = slack;
+    }
+
+    struct bufc_Seg *S = NULL;
+    size_t rest = max - slack;
+    if (rest) {
+        S = bufc_seg_new(rest < BUFC_MIN_SEG ? BUFC_MIN_SEG : rest);
+        iov[n].iov_base = S->data;
+        iov[n++].iov_len = rest;
+    }
+
+    ssize_t got = readv(fd, iov, n);
+    size_t in_slack = got <= 0 ? 0 : (size_t)got < slack ? (size_t)got : slack;
+
+    if (in_slack)
+        bufc_grow_tail(B, in_slack);
+
+    if (got > 0 && (size_t)got > in_slack) {
+        S->fill = got - in_slack;
+        bufc_push_tail(B, bufc_view_new(S, 0, S->fill));
+    } else if (S) {
+        free(S);
+    }
+    return got;
+}
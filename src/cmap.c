@@ -0,0 +1,345 @@
+#include "ds/cmap.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/* Initial buckets per shard */
+#define CMAP_SHARD_BUCKETS 8
+/* Old buckets moved into the new table per insert or delete while growing */
+#define CMAP_MIGRATE_STEP 4
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+
+/* The mixed hash is kept so lookups skip most key_cmp calls and migration
+ * never calls key_hash */
+struct cmap_Node {
+    struct cmap_Node *next;
+    uint64_t hash;
+    void *entry;
+};
+
+/******************************************************************************/
+/*                                  Helpers                                   */
+/******************************************************************************/
+
+/* Murmur3 finalizer, so weak client hashes still spread over all bits */
+static inline uint64_t cmap_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static inline uint64_t cmap_hash(cmap_t M, void *key) {
+    return cmap_mix(M->key_hash(key));
+}
+
+/* Shards take the high half of the hash, buckets the low bits */
+static inline struct cmap_Shard *cmap_shard(cmap_t M, uint64_t h) {
+    return &M->shards[(h >> 32) & M->shard_mask];
+}
+
+/* Bucket that holds hash h, in old if it has not been migrated yet */
+static struct cmap_Node **cmap_bucket(struct cmap_Shard *S, uint64_t h) {
+    if (S->old && (h & S->old_mask) >= S->migrated)
+        return &S->old[h & S->old_mask];
+    return &S->table[h & S->mask];
+}
+
+/* Returns the link pointing at the node with key, or at the bucket's
+ * terminating NULL if there is none */
+static struct cmap_Node **cmap_find(cmap_t M, struct cmap_Shard *S,
+                                    uint64_t h, void *key) {
+    struct cmap_Node **pp = cmap_bucket(S, h);
+
+    for (; *pp; pp = &(*pp)->next) {
+        if ((*pp)->hash == h && M->key_cmp(M->entry_key((*pp)->entry), key) == 0)
+            break;
+    }
+    return pp;
+}
+
+/* Move up to CMAP_MIGRATE_STEP buckets from old into table */
+static void cmap_migrate(struct cmap_Shard *S) {
+    for (int i = 0; i < CMAP_MIGRATE_STEP && S->old; i++) {
+        struct cmap_Node *N = S->old[S->migrated];
+
+        while (N) {
+            struct cmap_Node *next = N->next;
+            N->next = S->table[N->hash & S->mask];
+            S->table[N->hash & S->mask] = N;
+            N = next;
+        }
+
+        if (S->migrated++ == S->old_mask) {
+            free(S->old);
+            S->old = NULL;
+        }
+    }
+}
+
+/* Start growing once the shard averages more than one entry per bucket */
+static void cmap_maybe_grow(struct cmap_Shard *S) {
+    if (S->old || S->size <= S->mask + 1)
+        return;
+
+    S->old = S->table;
+    S->old_mask = S->mask;
+    S->migrated = 0;
+    S->mask = 2 * S->mask + 1;
+    S->table = calloc(S->mask + 1, sizeof(*S->table));
+}
+
+/* Unlink the node *pp and return its entry */
+static void *cmap_unlink(struct cmap_Shard *S, struct cmap_Node **pp) {
+    struct cmap_Node *N = *pp;
+    void *entry = N->entry;
+
+    *pp = N->next;
+    S->size--;
+    free(N);
+    return entry;
+}
+
+/* Free the nodes of table from bucket from on, their entries and the table */
+static void cmap_free_table(cmap_t M, struct cmap_Node **table, size_t from,
+                            size_t mask) {
+    for (size_t b = from; b <= mask; b++) {
+        struct cmap_Node *N = table[b];
+        while (N) {
+            struct cmap_Node *next = N->next;
+            if (M->entry_free)
+                M->entry_free(N->entry);
+            free(N);
+            N = next;
+        }
+    }
+    free(table);
+}
+
+/* Run p over one bucket chain; returns true if p asked to stop */
+static bool cmap_traverse_bucket(cmap_t M, struct cmap_Shard *S,
+                                 struct cmap_Node **pp,
+                                 ll_proc_fn *p, void *context) {
+    while (*pp) {
+        switch (p((*pp)->entry, context)) {
+        case LL_TRAVERSAL_STOP:
+            return true;
+        case LL_TRAVERSAL_DELETE: {
+            void *entry = cmap_unlink(S, pp);
+            if (M->entry_free)
+                M->entry_free(entry);
+            break;
+        }
+        default:
+            pp = &(*pp)->next;
+        }
+    }
+    return false;
+}
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+/*                            Init and Teardown                               */
+/******************************************************************************/
+
+cmap_t cmap_new(size_t nshards,
+                ll_key_hash_fn *key_hash,
+                ll_key_cmp_fn *key_cmp,
+                ll_entry_key_fn *entry_key,
+                ll_entry_free_fn *entry_free) {
+    assert(key_hash != NULL && key_cmp != NULL && entry_key != NULL);
+    struct cmap_Header *M = malloc(sizeof(*M));
+    size_t n = 1;
+
+    nshards = nshards ? nshards : CMAP_DEFAULT_SHARDS;
+    while (n < nshards)
+        n <<= 1;
+
+    M->shards = aligned_alloc(_Alignof(struct cmap_Shard), n * sizeof(*M->shards));
+    M->shard_mask = n - 1;
+    for (size_t i = 0; i < n; i++) {
+        struct cmap_Shard *S = &M->shards[i];
+
+        pthread_mutex_init(&S->lock, NULL);
+        S->table = calloc(CMAP_SHARD_BUCKETS, sizeof(*S->table));
+        S->mask = CMAP_SHARD_BUCKETS - 1;
+        S->size = 0;
+        S->old = NULL;
+        S->old_mask = 0;
+        S->migrated = 0;
+    }
+
+    M->key_hash = key_hash;
+    M->key_cmp = key_cmp;
+    M->entry_key = entry_key;
+    M->entry_free = entry_free;
+
+    return M;
+}
+
+void cmap_free(cmap_t M) {
+    assert(M != NULL);
+
+    for (size_t i = 0; i <= M->shard_mask; i++) {
+        struct cmap_Shard *S = &M->shards[i];
+
+        if (S->old)
+            cmap_free_table(M, S->old, S->migrated, S->old_mask);
+        cmap_free_table(M, S->table, 0, S->mask);
+        pthread_mutex_destroy(&S->lock);
+    }
+
+    free(M->shards);
+    free(M);
+}
+
+/******************************************************************************/
+/*                                 Accessors                                  */
+/******************************************************************************/
+
+void *cmap_get(cmap_t M, void *key) {
+    assert(M != NULL);
+    uint64_t h = cmap_hash(M, key);
+    struct cmap_Shard *S = cmap_shard(M, h);
+
+    pthread_mutex_lock(&S->lock);
+    struct cmap_Node *N = *cmap_find(M, S, h, key);
+    void *entry = N ? N->entry : NULL;
+    pthread_mutex_unlock(&S->lock);
+
+    return entry;
+}
+
+int cmap_visit(cmap_t M, void *key, ll_proc_fn *p, void *context) {
+    assert(M != NULL && p != NULL);
+    uint64_t h = cmap_hash(M, key);
+    struct cmap_Shard *S = cmap_shard(M, h);
+    void *deleted = NULL;
+
+    pthread_mutex_lock(&S->lock);
+    struct cmap_Node **pp = cmap_find(M, S, h, key);
+    if (*pp == NULL) {
+        pthread_mutex_unlock(&S->lock);
+        return 1;
+    }
+    if (p((*pp)->entry, context) == LL_TRAVERSAL_DELETE)
+        deleted = cmap_unlink(S, pp);
+    pthread_mutex_unlock(&S->lock);
+
+    if (deleted && M->entry_free)
+        M->entry_free(deleted);
+    return 0;
+}
+
+void cmap_traverse(cmap_t M, ll_proc_fn *p, void *context) {
+    assert(M != NULL && p != NULL);
+    bool stop = false;
+
+    for (size_t i = 0; i <= M->shard_mask && !stop; i++) {
+        struct cmap_Shard *S = &M->shards[i];
+
+        pthread_mutex_lock(&S->lock);
+        for (size_t b = 0; b <= S->mask && !stop; b++)
+            stop = cmap_traverse_bucket(M, S, &S->table[b], p, context);
+        for (size_t b = S->migrated; S->old && b <= S->old_mask && !stop; b++)
+            stop = cmap_traverse_bucket(M, S, &S->old[b], p, context);
+        pthread_mutex_unlock(&S->lock);
+    }
+}
+
+size_t cmap_size(cmap_t M) {
+    assert(M != NULL);
+    size_t size = 0;
+
+    for (size_t i = 0; i <= M->shard_mask; i++) {
+        struct cmap_Shard *S = &M->shards[i];
+
+        pthread_mutex_lock(&S->lock);
+        size += S->size;
+        pthread_mutex_unlock(&S->lock);
+    }
+    return size;
+}
+
+/******************************************************************************/
+/*                                  Mutators                                  */
+/******************************************************************************/
+
+int cmap_insert(cmap_t M, void *entry) {
+    assert(M != NULL && entry != NULL);
+    uint64_t h = cmap_hash(M, M->entry_key(entry));
+    struct cmap_Shard *S = cmap_shard(M, h);
+
+    /* Allocate before locking to keep the critical section short */
+    struct cmap_Node *N = malloc(sizeof(*N));
+    N->hash = h;
+    N->entry = entry;
+
+    pthread_mutex_lock(&S->lock);
+    cmap_migrate(S);
+    struct cmap_Node **pp = cmap_find(M, S, h, M->entry_key(entry));
+    if (*pp) {
+        pthread_mutex_unlock(&S->lock);
+        free(N);
+        return 1;
+    }
+
+    N->next = NULL;
+    *pp = N;
+    S->size++;
+    cmap_maybe_grow(S);
+    pthread_mutex_unlock(&S->lock);
+
+    return 0;
+}
+
+int cmap_del(cmap_t M, void *key) {
+    assert(M != NULL);
+    uint64_t h = cmap_hash(M, key);
+    struct cmap_Shard *S = cmap_shard(M, h);
+
+    pthread_mutex_lock(&S->lock);
+    cmap_migrate(S);
+    struct cmap_Node **pp = cmap_find(M, S, h, key);
+    if (*pp == NULL) {
+        pthread_mutex_unlock(&S->lock);
+        return 1;
+    }
+    void *entry = cmap_unlink(S, pp);
+    pthread_mutex_unlock(&S->lock);
+
+    if (M->entry_free)
+        M->entry_free(entry);
+    return 0;
+}
+
+void *cmap_update(cmap_t M, void *key, void *new_entry, bool free_old) {
+    assert(M != NULL && new_entry != NULL);
+    uint64_t h = cmap_hash(M, key);
+    struct cmap_Shard *S = cmap_shard(M, h);
+
+    pthread_mutex_lock(&S->lock);
+    struct cmap_Node *N = *cmap_find(M, S, h, key);
+    if (N == NULL) {
+        pthread_mutex_unlock(&S->lock);
+        return NULL;
+    }
+    void *old = N->entry;
+    N->entry = new_entry;
+    pthread_mutex_unlock(&S->lock);
+
+    if (free_old && M->entry_free) {
+        M->entry_free(old);
+        return NULL;
+    }
+    return old;
+}
@@ -0,0 +1,237 @@
+#include "ds/filter.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOOM_BLOCK_BYTES (sizeof(uint32_t) * BLOOM_BLOCK_WORDS)
+#define CUCKOO_MAX_KICKS 500
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+/*                                  Helpers                                   */
+/******************************************************************************/
+
+/* Murmur3 finalizer, so weak client hashes still spread over all bits */
+static inline uint64_t filter_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+/* Odd multipliers picking one bit per word of a Bloom block */
+static const uint32_t bloom_salt[BLOOM_BLOCK_WORDS] = {
+    0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+    0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+};
+
+static inline uint32_t *bloom_block(bloom_t B, uint64_t h) {
+    /* Multiply-shift maps the high half onto [0, nblocks) without a division */
+    return B->blocks[((h >> 32) * B->nblocks) >> 32];
+}
+
+static inline uint16_t cuckoo_fp(uint64_t h) {
+    uint16_t fp = h >> 48;
+    return fp ? fp : 1;     /* 0 marks an empty slot */
+}
+
+static inline size_t cuckoo_alt(cuckoo_t C, size_t index, uint16_t fp) {
+    return (index ^ filter_mix(fp)) & C->mask;
+}
+
+static bool cuckoo_bucket_add(cuckoo_t C, size_t index, uint16_t fp) {
+    for (int i = 0; i < CUCKOO_BUCKET_SLOTS; i++) {
+        if (!C->buckets[index][i]) {
+            C->buckets[index][i] = fp;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool cuckoo_bucket_has(cuckoo_t C, size_t index, uint16_t fp) {
+    uint16_t *b = C->buckets[index];
+    return (b[0] == fp) | (b[1] == fp) | (b[2] == fp) | (b[3] == fp);
+}
+
+static bool cuckoo_bucket_del(cuckoo_t C, size_t index, uint16_t fp) {
+    for (int i = 0; i < CUCKOO_BUCKET_SLOTS; i++) {
+        if (C->buckets[index][i] == fp) {
+            C->buckets[index][i] = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+/*                                   Bloom                                    */
+/******************************************************************************/
+
+bloom_t bloom_new(size_t capacity, size_t bits_per_key) {
+    assert(0 < bits_per_key);
+    struct bloom_Header *B = malloc(sizeof(*B));
+    size_t bits = capacity * bits_per_key;
+
+    B->nblocks = (bits + BLOOM_BLOCK_BYTES * 8 - 1) / (BLOOM_BLOCK_BYTES * 8);
+    B->nblocks = B->nblocks ? B->nblocks : 1;
+    B->blocks = aligned_alloc(BLOOM_BLOCK_BYTES, B->nblocks * BLOOM_BLOCK_BYTES);
+    bloom_clear(B);
+
+    return B;
+}
+
+void bloom_free(bloom_t B) {
+    assert(B != NULL);
+    free(B->blocks);
+    free(B);
+}
+
+void bloom_add(bloom_t B, uint64_t hash) {
+    assert(B != NULL);
+    uint64_t h = filter_mix(hash);
+    uint32_t *block = bloom_block(B, h);
+
+    for (int i = 0; i < BLOOM_BLOCK_WORDS; i++)
+        block[i] |= (uint32_t)1 << (((uint32_t)h * bloom_salt[i]) >> 27);
+}
+
+bool bloom_test(bloom_t B, uint64_t hash) {
+    assert(B != NULL);
+    uint64_t h = filter_mix(hash);
+    uint32_t *block = bloom_block(B, h);
+    uint32_t missing = 0;
+
+    /* No early exit, so the loop vectorizes */
+    for (int i = 0; i < BLOOM_BLOCK_WORDS; i++)
+        missing |= ~block[i] & (uint32_t)1 << (((uint32_t)h * bloom_salt[i]) >> 27);
+
+    return !missing;
+}
+
+void bloom_clear(bloom_t B) {
+    assert(B != NULL);
+    memset(B->blocks, 0, B->nblocks * BLOOM_BLOCK_BYTES);
+}
+
+/******************************************************************************/
+/*                                   Cuckoo                                   */
+/******************************************************************************/
+
+cuckoo_t cuckoo_new(size_t capacity) {
+    struct cuckoo_Header *C = malloc(sizeof(*C));
+
+    /* Aim for at most 95% occupancy */
+    size_t want = capacity * 100 / 95 / CUCKOO_BUCKET_SLOTS + 1;
+    size_t nbuckets = 1;
+    while (nbuckets < want)
+        nbuckets <<= 1;
+
+    C->buckets = calloc(nbuckets, sizeof(*C->buckets));
+    C->mask = nbuckets - 1;
+    C->size = 0;
+    C->has_victim = false;
+
+    return C;
+}
+
+void cuckoo_free(cuckoo_t C) {
+    assert(C != NULL);
+    free(C->buckets);
+    free(C);
+}
+
+int cuckoo_add(cuckoo_t C, uint64_t hash) {
+    assert(C != NULL);
+    if (C->has_victim)
+        return 1;
+
+    uint64_t h = filter_mix(hash);
+    uint16_t fp = cuckoo_fp(h);
+    size_t index = h & C->mask;
+
+    if (cuckoo_bucket_add(C, index, fp)
+            || cuckoo_bucket_add(C, cuckoo_alt(C, index, fp), fp)) {
+        C->size++;
+        return 0;
+    }
+
+    /* Evict fingerprints to their other bucket until one finds room */
+    index = (h >> 32) & 1 ? cuckoo_alt(C, index, fp) : index;
+    for (int kick = 0; kick < CUCKOO_MAX_KICKS; kick++) {
+        int slot = (kick + fp) % CUCKOO_BUCKET_SLOTS;
+        uint16_t evicted = C->buckets[index][slot];
+
+        C->buckets[index][slot] = fp;
+        fp = evicted;
+        index = cuckoo_alt(C, index, fp);
+
+        if (cuckoo_bucket_add(C, index, fp)) {
+            C->size++;
+            return 0;
+        }
+    }
+
+    /* Out of room: park the last evicted fingerprint */
+    C->has_victim = true;
+    C->victim_fp = fp;
+    C->victim_index = index;
+    C->size++;
+    return 0;
+}
+
+bool cuckoo_test(cuckoo_t C, uint64_t hash) {
+    assert(C != NULL);
+    uint64_t h = filter_mix(hash);
+    uint16_t fp = cuckoo_fp(h);
+    size_t i1 = h & C->mask;
+    size_t i2 = cuckoo_alt(C, i1, fp);
+
+    if (C->has_victim && C->victim_fp == fp
+            && (C->victim_index == i1 || C->victim_index == i2))
+        return true;
+
+    return cuckoo_bucket_has(C, i1, fp) || cuckoo_bucket_has(C, i2, fp);
+}
+
+int cuckoo_del(cuckoo_t C, uint64_t hash) {
+    assert(C != NULL);
+    uint64_t h = filter_mix(hash);
+    uint16_t fp = cuckoo_fp(h);
+    size_t i1 = h & C->mask;
+    size_t i2 = cuckoo_alt(C, i1, fp);
+
+    if (C->has_victim && C->victim_fp == fp
+            && (C->victim_index == i1 || C->victim_index == i2)) {
+        C->has_victim = false;
+        C->size--;
+        return 0;
+    }
+
+    if (!cuckoo_bucket_del(C, i1, fp) && !cuckoo_bucket_del(C, i2, fp))
+        return 1;
+    C->size--;
+
+    /* A slot just opened up; try to settle the victim */
+    if (C->has_victim) {
+        size_t vi = C->victim_index;
+        if (cuckoo_bucket_add(C, vi, C->victim_fp)
+                || cuckoo_bucket_add(C, cuckoo_alt(C, vi, C->victim_fp),
+                                     C->victim_fp))
+            C->has_victim = false;
+    }
+    return 0;
+}
+
+size_t cuckoo_size(cuckoo_t C) {
+    assert(C != NULL);
+    return C->size;
+}
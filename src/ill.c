@@ -0,0 +1,395 @@
+#include "ds/ill.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+/*                               Helper Headers                               */
+/******************************************************************************/
+
+static uint32_t ill_alloc_node(ill_t L);
+static void ill_link_node(ill_t L, uint32_t n, void *entry, uint32_t prev);
+static void *ill_take_node(ill_t L, uint32_t n);
+static void ill_del_node(ill_t L, uint32_t n);
+static uint32_t ill_find_node(ill_t L, void *key, bool rev);
+static uint32_t ill_node_at(ill_t L, int index);
+static void *ill_replace_entry(ill_t L, uint32_t n, void *new_entry, bool free_old);
+static void ill_traverse_opt(ill_t L, ll_proc_fn *p, void *context, bool rev);
+
+/******************************************************************************/
+/*                             Validation Headers                             */
+/******************************************************************************/
+
+static bool ill_valid(ill_t L);
+static bool ill_valid_index(ill_t L, int index);
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+/*                              Init & Teardown                               */
+/******************************************************************************/
+
+ill_t ill_new(ll_key_cmp_fn *key_cmp,
+              ll_entry_key_fn *entry_key,
+              ll_entry_free_fn *entry_free) {
+    assert(key_cmp && entry_key);
+    struct ill_Header *L = malloc(sizeof(*L));
+
+    L->limit = 8;
+    L->nodes = malloc(sizeof(*L->nodes) * L->limit);
+    L->used = 1;
+    L->free = 0;
+
+    L->nodes[0].entry = NULL;
+    L->nodes[0].next = 0;
+    L->nodes[0].prev = 0;
+
+    L->size = 0;
+
+    L->key_cmp = key_cmp;
+    L->entry_key = entry_key;
+    L->entry_free = entry_free;
+
+    assert(ill_valid(L));
+    return L;
+}
+
+void ill_free(ill_t L) {
+    assert(ill_valid(L));
+
+    if (L->entry_free) {
+        for (uint32_t n = L->nodes[0].next; n != 0; n = L->nodes[n].next)
+            L->entry_free(L->nodes[n].entry);
+    }
+
+    free(L->nodes);
+    free(L);
+}
+
+ill_t ill_copy(ill_t L, ll_entry_free_fn *entry_free) {
+    assert(ill_valid(L));
+    struct ill_Header *C = malloc(sizeof(*C));
+
+    *C = *L;
+    C->entry_free = entry_free;
+
+    /* Links are slot numbers, so the array copies as is */
+    C->nodes = malloc(sizeof(*C->nodes) * C->limit);
+    memcpy(C->nodes, L->nodes, sizeof(*C->nodes) * L->used);
+
+    assert(ill_valid(C));
+    return C;
+}
+
+void ill_shrink(ill_t L) {
+    assert(ill_valid(L));
+    uint32_t limit = L->size + 1;
+    struct ill_Node *nodes = malloc(sizeof(*nodes) * limit);
+    uint32_t i = 1;
+
+    for (uint32_t n = L->nodes[0].next; n != 0; n = L->nodes[n].next, i++) {
+        nodes[i].entry = L->nodes[n].entry;
+        nodes[i].next = i + 1 < limit ? i + 1 : 0;
+        nodes[i].prev = i - 1;
+    }
+
+    nodes[0].entry = NULL;
+    nodes[0].next = limit > 1 ? 1 : 0;
+    nodes[0].prev = limit - 1;
+
+    free(L->nodes);
+    L->nodes = nodes;
+    L->limit = limit;
+    L->used = limit;
+    L->free = 0;
+
+    assert(ill_valid(L));
+}
+
+/******************************************************************************/
+/*                                 Accessors                                  */
+/******************************************************************************/
+
+void *ill_get(ill_t L, void *key) {
+    assert(ill_valid(L));
+    uint32_t n = ill_find_node(L, key, false);
+
+    return n ? L->nodes[n].entry : NULL;
+}
+
+void *ill_at(ill_t L, int index) {
+    assert(ill_valid(L) && ill_valid_index(L, index));
+    return L->nodes[ill_node_at(L, index)].entry;
+}
+
+size_t ill_size(ill_t L) {
+    assert(L != NULL);
+    return L->size;
+}
+
+bool ill_empty(ill_t L) {
+    assert(L != NULL);
+    return L->size == 0;
+}
+
+void ill_traverse(ill_t L, ll_proc_fn *p, void *context) {
+    assert(ill_valid(L) && p);
+    ill_traverse_opt(L, p, context, false);
+}
+
+void ill_traverse_rev(ill_t L, ll_proc_fn *p, void *context) {
+    assert(ill_valid(L) && p);
+    ill_traverse_opt(L, p, context, true);
+}
+
+/******************************************************************************/
+/*                                  Mutators                                  */
+/******************************************************************************/
+
+void ill_insert(ill_t L, void *entry) {
+    assert(ill_valid(L) && entry && L->size < ILL_MAX);
+    ill_link_node(L, ill_alloc_node(L), entry, 0);
+    assert(ill_valid(L));
+}
+
+int ill_insert_tail(ill_t L, void *entry) {
+    assert(ill_valid(L) && entry && L->size < ILL_MAX);
+    ill_link_node(L, ill_alloc_node(L), entry, L->nodes[0].prev);
+    assert(ill_valid(L));
+    return 0;
+}
+
+int ill_insert_at(ill_t L, void *entry, int index) {
+    assert(ill_valid(L) && entry && L->size < ILL_MAX
+            && ill_valid_index(L, index));
+
+    /* Allocate first: growing the array moves the nodes, not their slots */
+    uint32_t n = ill_alloc_node(L);
+    ill_link_node(L, n, entry, L->nodes[ill_node_at(L, index)].prev);
+
+    assert(ill_valid(L));
+    return 0;
+}
+
+int ill_del(ill_t L, void *key) {
+    assert(ill_valid(L));
+    uint32_t n = ill_find_node(L, key, false);
+
+    if (!n)
+        return 1;
+
+    ill_del_node(L, n);
+    return 0;
+}
+
+int ill_del_rev(ill_t L, void *key) {
+    assert(ill_valid(L));
+    uint32_t n = ill_find_node(L, key, true);
+
+    if (!n)
+        return 1;
+
+    ill_del_node(L, n);
+    return 0;
+}
+
+int ill_del_head(ill_t L) {
+    assert(ill_valid(L) && !ill_empty(L));
+    ill_del_node(L, L->nodes[0].next);
+    return 0;
+}
+
+int ill_del_tail(ill_t L) {
+    assert(ill_valid(L) && !ill_empty(L));
+    ill_del_node(L, L->nodes[0].prev);
+    return 0;
+}
+
+int ill_del_at(ill_t L, int index) {
+    assert(ill_valid(L) && ill_valid_index(L, index));
+    ill_del_node(L, ill_node_at(L, index));
+    return 0;
+}
+
+void *ill_take_head(ill_t L) {
+    assert(ill_valid(L) && !ill_empty(L));
+    return ill_take_node(L, L->nodes[0].next);
+}
+
+void *ill_take_at(ill_t L, int index) {
+    assert(ill_valid(L) && ill_valid_index(L, index));
+    return ill_take_node(L, ill_node_at(L, index));
+}
+
+void *ill_update(ill_t L, void *key, void *new_entry, bool free_old) {
+    assert(ill_valid(L) && new_entry);
+    uint32_t n = ill_find_node(L, key, false);
+
+    if (!n)
+        return NULL;
+
+    return ill_replace_entry(L, n, new_entry, free_old);
+}
+
+void *ill_update_at(ill_t L, int index, void *new_entry, bool free_old) {
+    assert(ill_valid(L) && ill_valid_index(L, index) && new_entry);
+    return ill_replace_entry(L, ill_node_at(L, index), new_entry, free_old);
+}
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+/*                           Invariants/Validators                            */
+/******************************************************************************/
+
+static bool ill_valid(ill_t L) {
+    if (L == NULL || L->nodes == NULL || L->used > L->limit || L->used == 0)
+        return false;
+
+    size_t count = 0;
+    uint32_t p = 0;
+    for (uint32_t n = L->nodes[0].next; n != 0; p = n, n = L->nodes[n].next) {
+        if (n >= L->used || L->nodes[n].prev != p || ++count > L->size)
+            return false;
+    }
+
+    return L->nodes[0].prev == p && count == L->size;
+}
+
+static bool ill_valid_index(ill_t L, int index) {
+    return (0 <= index && (size_t)index < L->size)
+           || (index < 0 && (size_t)-index <= L->size);
+}
+
+/******************************************************************************/
+/*                                  Helpers                                   */
+/******************************************************************************/
+
+/* Pop a slot off the free stack, or hand out a fresh one, growing the array */
+static uint32_t ill_alloc_node(ill_t L) {
+    uint32_t n = L->free;
+
+    if (n) {
+        L->free = L->nodes[n].next;
+        return n;
+    }
+
+    if (L->used == L->limit) {
+        size_t limit = (size_t)L->limit * 2;
+        L->limit = limit < UINT32_MAX ? limit : UINT32_MAX;
+        L->nodes = realloc(L->nodes, sizeof(*L->nodes) * L->limit);
+    }
+    return L->used++;
+}
+
+/* Link slot n holding entry after slot prev */
+static void ill_link_node(ill_t L, uint32_t n, void *entry, uint32_t prev) {
+    struct ill_Node *nodes = L->nodes;
+    uint32_t next = nodes[prev].next;
+
+    nodes[n].entry = entry;
+    nodes[n].prev = prev;
+    nodes[n].next = next;
+    nodes[next].prev = n;
+    nodes[prev].next = n;
+
+    L->size++;
+}
+
+/* Unlink slot n, push it on the free stack and return its entry */
+static void *ill_take_node(ill_t L, uint32_t n) {
+    assert(n != 0);
+    struct ill_Node *nodes = L->nodes;
+    void *entry = nodes[n].entry;
+
+    nodes[nodes[n].prev].next = nodes[n].next;
+    nodes[nodes[n].next].prev = nodes[n].prev;
+
+    nodes[n].entry = NULL;
+    nodes[n].next = L->free;
+    L->free = n;
+    L->size--;
+
+    assert(ill_valid(L));
+    return entry;
+}
+
+static void ill_del_node(ill_t L, uint32_t n) {
+    void *entry = ill_take_node(L, n);
+
+    if (L->entry_free)
+        L->entry_free(entry);
+}
+
+/* Return the slot of the first node with key, 0 if there is none */
+static uint32_t ill_find_node(ill_t L, void *key, bool rev) {
+    struct ill_Node *nodes = L->nodes;
+    uint32_t n = rev ? nodes[0].prev : nodes[0].next;
+
+    while (n != 0) {
+        if (L->key_cmp(key, L->entry_key(nodes[n].entry)) == 0)
+            return n;
+        n = rev ? nodes[n].prev : nodes[n].next;
+    }
+    return 0;
+}
+
+static uint32_t ill_node_at(ill_t L, int index) {
+    assert(ill_valid_index(L, index));
+    struct ill_Node *nodes = L->nodes;
+    uint32_t n;
+
+    if (index >= 0) {
+        n = nodes[0].next;
+        for (int i = 0; i < index; i++)
+            n = nodes[n].next;
+    } else {
+        n = nodes[0].prev;
+        for (int i = -1; i > index; i--)
+            n = nodes[n].prev;
+    }
+    return n;
+}
+
+static void *ill_replace_entry(ill_t L, uint32_t n, void *new_entry, bool free_old) {
+    void *old = L->nodes[n].entry;
+
+    L->nodes[n].entry = new_entry;
+
+    if (free_old && L->entry_free) {
+        L->entry_free(old);
+        return NULL;
+    }
+    return old;
+}
+
+static void ill_traverse_opt(ill_t L, ll_proc_fn *p, void *context, bool rev) {
+    uint32_t n = rev ? L->nodes[0].prev : L->nodes[0].next;
+    uint32_t tmp;
+
+    while (n != 0) {
+        /* p may insert into L and move the array, so index it afresh */
+        switch (p(L->nodes[n].entry, context)) {
+            case LL_TRAVERSAL_CONTINUE:
+                break;
+
+            case LL_TRAVERSAL_STOP:
+                assert(ill_valid(L));
+                return;
+
+            case LL_TRAVERSAL_DELETE:
+                tmp = n;
+                n = rev ? L->nodes[n].prev : L->nodes[n].next;
+                ill_del_node(L, tmp);
+                continue;
+        }
+
+        n = rev ? L->nodes[n].prev : L->nodes[n].next;
+    }
+    assert(ill_valid(L));
+}
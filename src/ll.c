@@ -1,9 +1,21 @@
+#ifndef DS_NO_INLINE
+#define DS_NO_INLINE    /* This file defines the out-of-line versions */
+#endif
 #include "ds/ll.h"
+#include "ds/filter.h"
+#include "ds/reclaim.h"
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /******************************************************************************/
 /*                                  INTERNAL                                  */
@@ -11,14 +23,90 @@
 /*                               Helper Headers                               */
 /******************************************************************************/
 
+/* Lists without fingerprints or counts allocate bare ll_Nodes */
+_Static_assert(sizeof(struct ll_Node) == 3 * sizeof(void *),
+               "ll_Node must stay three pointers");
+
+/* The ll_HNode that N is the base of, in lists that allocate them (see
+ * ll_node_size) */
+#define ll_hnode(N) \
+    ((struct ll_HNode *)((char *)(N) - offsetof(struct ll_HNode, base)))
+
 static struct ll_Node *ll_find_node(struct ll_Header *L, void *key, bool rev);
 static void ll_traverse_opt(ll_t L, ll_proc_fn *p, void *context, bool rev);
 static void ll_del_node(ll_t L, struct ll_Node *N);
+static void *ll_take_node(ll_t L, struct ll_Node *N);
 static struct ll_Node *ll_node_at(ll_t L, int index);
 static void ll_insert_node(ll_t L,
                     void *entry,
                     struct ll_Node *next,
                     struct ll_Node *prev);
+static void ll_link_node(ll_t L,
+                         struct ll_Node *N,
+                         struct ll_Node *next,
+                         struct ll_Node *prev);
+static void ll_release_node(ll_t L, struct ll_Node *N);
+static void *ll_replace_entry(ll_t L,
+                              struct ll_Node *N,
+                              void *new_entry,
+                              bool free_old);
+static void ll_filter_rebuild(ll_t L);
+static void ll_filter_add(ll_t L, void *entry);
+static void ll_filter_del(ll_t L, void *entry);
+static void ll_set_fingerprint(ll_t L, struct ll_Node *N);
+static size_t ll_node_size(ll_t L);
+static void ll_reorg_node(ll_t L, struct ll_Node *N);
+static void ll_adopt_sentinels(ll_t L);
+
+/******************************************************************************/
+/*                                 Statistics                                 */
+/******************************************************************************/
+
+#ifdef DS_STATS
+/* Lists on different threads share the global counters, so those are atomic;
+ * a list's own counters are only touched by whoever is using the list */
+static struct {
+    atomic_size_t allocs;
+    atomic_size_t bytes;
+    atomic_size_t nodes_visited;
+    atomic_size_t key_cmps;
+    atomic_size_t traversal_dels;
+} ll_global_stats;
+
+#define LL_GLOBAL_ADD(field, n) \
+    atomic_fetch_add_explicit(&ll_global_stats.field, (n), memory_order_relaxed)
+#define LL_GLOBAL_SUB(field, n) \
+    atomic_fetch_sub_explicit(&ll_global_stats.field, (n), memory_order_relaxed)
+#define LL_GLOBAL_GET(field) \
+    atomic_load_explicit(&ll_global_stats.field, memory_order_relaxed)
+
+#define LL_STAT_ADD(L, field, n) \
+    ((L)->stats.field += (n), LL_GLOBAL_ADD(field, n))
+#define LL_STAT_SUB(L, field, n) \
+    ((L)->stats.field -= (n), LL_GLOBAL_SUB(field, n))
+#else
+#define LL_STAT_ADD(L, field, n) ((void)0)
+#define LL_STAT_SUB(L, field, n) ((void)0)
+#endif
+
+/* Walks prefetch two nodes ahead: the node after next, whose address sits in
+ * the (already requested) next node, and the entry of next. Prefetching NULL
+ * past a sentinel is harmless. */
+#if defined(__GNUC__) || defined(__clang__)
+#define LL_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define LL_PREFETCH(addr) ((void)0)
+#endif
+
+#define LL_PREFETCH_AHEAD(N, rev, with_entry) do {                  \
+        struct ll_Node *ahead_ = (rev) ? (N)->prev : (N)->next;     \
+        LL_PREFETCH((rev) ? ahead_->prev : ahead_->next);           \
+        if (with_entry)                                             \
+            LL_PREFETCH(ahead_->entry);                             \
+    } while (0)
+
+/* Fold a 64-bit key hash into a node fingerprint */
+#define LL_FINGERPRINT(h) ((uint32_t)((h) ^ ((h) >> 32)))
 
 /******************************************************************************/
 /*                             Validation Headers                             */
@@ -33,50 +121,382 @@ static bool ll_valid_index(ll_t L, int index);
 /*                              Init & Teardown                               */
 /******************************************************************************/
 
+void ll_init(ll_t L,
+             ll_key_cmp_fn *key_cmp,
+             ll_entry_key_fn *entry_key,
+             ll_entry_free_fn *entry_free) {
+    assert(L && key_cmp && entry_key);
+
+    L->head.entry = NULL;
+    L->head.next = &L->tail;
+    L->head.prev = NULL;
+
+    L->tail.entry = NULL;
+    L->tail.next = NULL;
+    L->tail.prev = &L->head;
+
+    L->size = 0;
+
+    L->key_cmp = key_cmp;
+    L->entry_key = entry_key;
+    L->entry_free = entry_free;
+
+    L->key_hash = NULL;
+    L->fingerprints = false;
+    L->filter = NULL;
+
+    L->reorg = LL_REORG_NONE;
+
+    L->map = NULL;
+    L->map_len = 0;
+
+    L->block = NULL;
+    L->block_len = 0;
+
+#ifdef DS_STATS
+    L->stats = (struct ll_Stats){0};
+#endif
+
+    assert(ll_valid(L));
+}
+
 struct ll_Header *ll_new(ll_key_cmp_fn *key_cmp,
                          ll_entry_key_fn *entry_key,
                          ll_entry_free_fn *entry_free) {
     assert(key_cmp && entry_key);
 
+    /* The sentinels live in the header, so this is the only allocation */
     struct ll_Header *L = malloc(sizeof(*L));
-    L->head = malloc(sizeof(*L->head));
-    L->tail = malloc(sizeof(*L->tail));
+    ll_init(L, key_cmp, entry_key, entry_free);
 
-    L->head->next = L->tail;
-    L->head->prev = NULL;
+    LL_STAT_ADD(L, allocs, 1);
+    LL_STAT_ADD(L, bytes, sizeof(*L));
 
-    L->tail->next = NULL;
-    L->tail->prev = L->head;
+    return L;
+}
 
-    L->size = 0;
+ll_t ll_new_hashed(ll_key_cmp_fn *key_cmp,
+                   ll_entry_key_fn *entry_key,
+                   ll_entry_free_fn *entry_free,
+                   ll_key_hash_fn *key_hash) {
+    assert(key_hash);
+    ll_t L = ll_new(key_cmp, entry_key, entry_free);
 
-    L->key_cmp = key_cmp;
-    L->entry_key = entry_key;
-    L->entry_free = entry_free;
+    L->key_hash = key_hash;
+    L->fingerprints = true;
 
-    assert(ll_valid(L));
     return L;
 }
 
-void ll_free(ll_t L) {
+void ll_fini(ll_t L) {
     assert(ll_valid(L));
-    struct ll_Node *curr = L->head->next;
+    struct ll_Node *curr = L->head.next;
     struct ll_Node *next_node = curr->next;
 
-    while (curr != L->tail) {
+    while (curr != &L->tail) {
         if (L->entry_free)
             L->entry_free(curr->entry);
 
-        free(curr);
+        ll_release_node(L, curr);
         curr = next_node;
         next_node = next_node->next;
     }
 
-    free(L->head);
-    free(L->tail);
+    if (L->filter)
+        cuckoo_free(L->filter);
+
+    if (L->map)
+        munmap(L->map, L->map_len);
+
+    free(L->block);
+
+#ifdef DS_STATS
+    LL_GLOBAL_SUB(bytes, L->stats.bytes);
+#endif
+}
+
+void ll_free(ll_t L) {
+    ll_fini(L);
     free(L);
 }
 
+static bool ll_reclaim_step(void *L, size_t budget) {
+    return ll_free_step(L, budget);
+}
+
+void ll_free_async(ll_t L) {
+    assert(L != NULL);
+    reclaim_defer(L, &ll_reclaim_step);
+}
+
+bool ll_free_step(ll_t L, size_t budget) {
+    assert(L != NULL && 0 < budget);
+
+    /* No ll_valid here: it walks the whole list on every step */
+    while (budget-- && L->head.next != &L->tail) {
+        struct ll_Node *N = L->head.next;
+
+        L->head.next = N->next;
+        N->next->prev = &L->head;
+        L->size--;
+
+        if (L->entry_free)
+            L->entry_free(N->entry);
+        ll_release_node(L, N);
+    }
+
+    if (L->head.next != &L->tail)
+        return false;
+
+    ll_free(L);
+    return true;
+}
+
+void ll_swap(ll_t A, ll_t B) {
+    assert(ll_valid(A) && ll_valid(B));
+
+    /* Per-list counters travel with the nodes they describe */
+    struct ll_Header tmp = *A;
+    *A = *B;
+    *B = tmp;
+
+    /* The sentinels moved with the headers; point the nodes back at them */
+    ll_adopt_sentinels(A);
+    ll_adopt_sentinels(B);
+
+    assert(ll_valid(A) && ll_valid(B));
+}
+
+void ll_set_filter(ll_t L, ll_key_hash_fn *key_hash) {
+    assert(ll_valid(L));
+
+    if (!key_hash) {
+        if (L->filter)
+            cuckoo_free(L->filter);
+        L->filter = NULL;
+        if (!L->fingerprints)
+            L->key_hash = NULL;
+        return;
+    }
+
+    bool rehash = L->fingerprints && key_hash != L->key_hash;
+    L->key_hash = key_hash;
+    if (rehash) {
+        for (struct ll_Node *N = L->head.next; N != &L->tail; N = N->next)
+            ll_set_fingerprint(L, N);
+    }
+    ll_filter_rebuild(L);
+}
+
+void ll_set_reorg(ll_t L, enum ll_reorg reorg) {
+    assert(ll_valid(L));
+    assert(L->size == 0 || L->fingerprints
+           || (reorg == LL_REORG_COUNT) == (L->reorg == LL_REORG_COUNT));
+
+    /* Counts are only kept under LL_REORG_COUNT; starting them all at zero
+     * leaves the current order valid */
+    if (reorg == LL_REORG_COUNT && L->reorg != LL_REORG_COUNT) {
+        for (struct ll_Node *N = L->head.next; N != &L->tail; N = N->next)
+            ll_hnode(N)->count = 0;
+    }
+    L->reorg = reorg;
+}
+
+void ll_compact(ll_t L) {
+    assert(ll_valid(L));
+    size_t node_size = ll_node_size(L);
+    char *block = L->size ? malloc(L->size * node_size) : NULL;
+    struct ll_Node *prev = &L->head;
+    struct ll_Node *curr = L->head.next;
+    size_t i = 0;
+
+    if (block) {
+        LL_STAT_ADD(L, allocs, 1);
+        LL_STAT_ADD(L, bytes, L->size * node_size);
+    }
+
+    /* Nodes of the previous block are skipped by ll_release_node and go away
+     * with the block itself below */
+    while (curr != &L->tail) {
+        struct ll_Node *next = curr->next;
+        struct ll_Node *N = (struct ll_Node *)(block + i++ * node_size);
+
+        N->entry = curr->entry;
+        if (L->fingerprints)
+            ll_hnode(N)->fp = ll_hnode(curr)->fp;
+        if (L->reorg == LL_REORG_COUNT)
+            ll_hnode(N)->count = ll_hnode(curr)->count;
+        N->prev = prev;
+        prev->next = N;
+
+        ll_release_node(L, curr);
+        prev = N;
+        curr = next;
+    }
+    prev->next = &L->tail;
+    L->tail.prev = prev;
+
+    if (L->block) {
+        free(L->block);
+        LL_STAT_SUB(L, bytes, L->block_len);
+    }
+    L->block = block;
+    L->block_len = L->size * node_size;
+
+    assert(ll_valid(L));
+}
+
+/******************************************************************************/
+/*                                Persistence                                 */
+/******************************************************************************/
+
+/* File layout: ll_FileHeader followed by one record per entry, in list order.
+ * A record is a node slot (zero on disk, linked up in place by ll_load), the
+ * payload length and the payload padded to 8 bytes. The checksum covers the
+ * header fields before it and everything after the header.
+ * */
+#define LL_FILE_MAGIC 0x314c4c44u   /* "DLL1" */
+#define LL_FILE_VERSION 2
+
+struct ll_FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t node_size;
+    uint32_t reserved;
+    uint64_t count;
+    uint64_t checksum;
+};
+
+#define LL_PAD8(n) (((n) + 7) & ~(size_t)7)
+
+/* FNV-1a over 64-bit words; len is always a multiple of 8 */
+static uint64_t ll_checksum(uint64_t h, const void *buf, size_t len) {
+    const unsigned char *p = buf;
+    uint64_t w;
+
+    for (size_t i = 0; i < len; i += 8) {
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+/* Checksum of the header fields, where the one over the records starts */
+static uint64_t ll_checksum_header(const struct ll_FileHeader *hdr) {
+    return ll_checksum(0xcbf29ce484222325ull, hdr,
+                       offsetof(struct ll_FileHeader, checksum));
+}
+
+static bool ll_write(FILE *f, uint64_t *h, const void *buf, size_t len) {
+    *h = ll_checksum(*h, buf, len);
+    return fwrite(buf, 1, len, f) == len;
+}
+
+int ll_save(ll_t L, const char *path, ll_entry_serialize_fn *ser) {
+    assert(ll_valid(L) && path && ser);
+
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        return 1;
+
+    struct ll_FileHeader hdr = {
+        .magic = LL_FILE_MAGIC,
+        .version = LL_FILE_VERSION,
+        .node_size = sizeof(struct ll_Node),
+        .count = L->size,
+    };
+    struct ll_Node slot = {0};
+    size_t cap = 64, len;
+    unsigned char *buf = malloc(cap);
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+
+    hdr.checksum = ll_checksum_header(&hdr);
+    for (struct ll_Node *N = L->head.next; ok && N != &L->tail; N = N->next) {
+        len = ser(N->entry, buf, cap);
+        if (len > cap) {
+            cap = LL_PAD8(len);
+            buf = realloc(buf, cap);
+            len = ser(N->entry, buf, cap);
+        }
+        memset(buf + len, 0, LL_PAD8(len) - len);
+
+        uint64_t len64 = len;
+        ok = ll_write(f, &hdr.checksum, &slot, sizeof(slot))
+             && ll_write(f, &hdr.checksum, &len64, sizeof(len64))
+             && ll_write(f, &hdr.checksum, buf, LL_PAD8(len));
+    }
+
+    ok = ok && fseek(f, 0, SEEK_SET) == 0
+         && fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+
+    free(buf);
+    return fclose(f) == 0 && ok ? 0 : 1;
+}
+
+ll_t ll_load(const char *path,
+             ll_entry_deserialize_fn *deser,
+             ll_key_cmp_fn *key_cmp,
+             ll_entry_key_fn *entry_key,
+             ll_entry_free_fn *entry_free) {
+    assert(path && deser && key_cmp && entry_key);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(struct ll_FileHeader)
+            || (st.st_size - sizeof(struct ll_FileHeader)) % 8) {
+        close(fd);
+        return NULL;
+    }
+
+    /* Private and writable: node slots are filled in without touching the file */
+    size_t map_len = st.st_size;
+    char *map = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    struct ll_FileHeader *hdr = (struct ll_FileHeader *)map;
+    char *p = map + sizeof(*hdr), *end = map + map_len;
+
+    if (hdr->magic != LL_FILE_MAGIC || hdr->version != LL_FILE_VERSION
+            || hdr->node_size != sizeof(struct ll_Node)
+            || hdr->count > (size_t)(end - p) / (sizeof(struct ll_Node) + 8)
+            || ll_checksum(ll_checksum_header(hdr), p, end - p) != hdr->checksum) {
+        munmap(map, map_len);
+        return NULL;
+    }
+
+    ll_t L = ll_new(key_cmp, entry_key, entry_free);
+    L->map = map;
+    L->map_len = map_len;
+
+    for (uint64_t i = 0; i < hdr->count; i++) {
+        struct ll_Node *N = (struct ll_Node *)p;
+        uint64_t len;
+
+        if ((size_t)(end - p) < sizeof(*N) + sizeof(len)) {
+            ll_free(L);
+            return NULL;
+        }
+        memcpy(&len, p + sizeof(*N), sizeof(len));
+        p += sizeof(*N) + sizeof(len);
+        if (len > (size_t)(end - p)) {
+            ll_free(L);
+            return NULL;
+        }
+
+        N->entry = deser(p, len);
+        ll_link_node(L, N, &L->tail, L->tail.prev);
+        p += LL_PAD8(len);
+    }
+
+    assert(ll_valid(L));
+    return L;
+}
+
 /******************************************************************************/
 /*                                 Accessors                                  */
 /******************************************************************************/
@@ -85,7 +505,11 @@ void *ll_get(ll_t L, void *key) {
     assert(ll_valid(L));
 
     struct ll_Node *tmp = ll_find_node(L, key, false);
-    return tmp ? tmp->entry : NULL;
+    if (!tmp)
+        return NULL;
+
+    ll_reorg_node(L, tmp);
+    return tmp->entry;
 }
 
 void *ll_at(ll_t L, int index) {
@@ -100,13 +524,13 @@ void *ll_at(ll_t L, int index) {
 
 void ll_insert(ll_t L, void *entry) {
     assert(ll_valid(L) && entry);
-    ll_insert_node(L, entry, L->head->next, L->head);
+    ll_insert_node(L, entry, L->head.next, &L->head);
     assert(ll_valid(L));
 }
 
 int ll_insert_tail(ll_t L, void *entry) {
     assert(ll_valid(L) && entry);
-    ll_insert_node(L, entry, L->tail, L->tail->prev);
+    ll_insert_node(L, entry, &L->tail, L->tail.prev);
     assert(ll_valid(L));
 }
 
@@ -153,13 +577,13 @@ int ll_del_rev(ll_t L, void *key) {
 
 int ll_del_head(ll_t L) {
     assert(ll_valid(L) && !ll_empty(L));
-    ll_del_node(L, L->head->next);
+    ll_del_node(L, L->head.next);
     assert(ll_valid(L));
 }
 
 int ll_del_tail(ll_t L) {
     assert(ll_valid(L) && !ll_empty(L));
-    ll_del_node(L, L->tail->prev);
+    ll_del_node(L, L->tail.prev);
     assert(ll_valid(L));
 
 }
@@ -170,6 +594,16 @@ int ll_del_at(ll_t L, int index) {
     assert(ll_valid(L));
 }
 
+void *ll_take_head(ll_t L) {
+    assert(ll_valid(L) && !ll_empty(L));
+    return ll_take_node(L, L->head.next);
+}
+
+void *ll_take_at(ll_t L, int index) {
+    assert(ll_valid(L) && !ll_empty(L) && ll_valid_index(L, index));
+    return ll_take_node(L, ll_node_at(L, index));
+}
+
 void *ll_update(ll_t L,
                 void *key,
                 void *new_entry,
@@ -177,12 +611,11 @@ void *ll_update(ll_t L,
     assert(ll_valid(L) && !ll_empty(L) && new_entry);
     struct ll_Node *tmp = ll_find_node(L, key, false);
 
-    if (free_old && L->entry_free)
-        L->entry_free(tmp->entry);
-
-    tmp->entry = new_entry;
+    if (!tmp)
+        return NULL;
 
-    assert(ll_valid(L) && !ll_empty(L));
+    ll_reorg_node(L, tmp);
+    return ll_replace_entry(L, tmp, new_entry, free_old);
 }
 
 void *ll_update_at(ll_t L,
@@ -191,14 +624,21 @@ void *ll_update_at(ll_t L,
                    bool free_old) {
     assert(ll_valid(L) && ll_valid_index(L, index) && !ll_empty(L) && new_entry);
 
-    struct ll_Node *tmp = ll_node_at(L, index);
+    return ll_replace_entry(L, ll_node_at(L, index), new_entry, free_old);
+}
 
-    if (free_old && L->entry_free)
-        L->entry_free(tmp->entry);
+struct ll_Node *ll_insert_before(ll_t L, struct ll_Node *N, void *entry) {
+    assert(L != NULL && N != NULL && N != &L->head && entry);
+    ll_insert_node(L, entry, N, N->prev);
+    return N->prev;
+}
 
-    tmp->entry = new_entry;
+struct ll_Node *ll_erase(ll_t L, struct ll_Node *N) {
+    assert(L != NULL && N != NULL && N != &L->head && N != &L->tail);
+    struct ll_Node *next = N->next;
 
-    assert(ll_valid(L) && !ll_empty(L));
+    ll_del_node(L, N);
+    return next;
 }
 
 /******************************************************************************/
@@ -231,6 +671,42 @@ bool ll_empty(struct ll_Header *L) {
     return !ll_size(L);
 }
 
+/******************************************************************************/
+/*                                 Statistics                                 */
+/******************************************************************************/
+
+struct ll_Stats ll_stats(ll_t L) {
+    assert(L != NULL);
+#ifdef DS_STATS
+    return L->stats;
+#else
+    return (struct ll_Stats){0};
+#endif
+}
+
+struct ll_Stats ll_stats_global(void) {
+#ifdef DS_STATS
+    return (struct ll_Stats){
+        .allocs = LL_GLOBAL_GET(allocs),
+        .bytes = LL_GLOBAL_GET(bytes),
+        .nodes_visited = LL_GLOBAL_GET(nodes_visited),
+        .key_cmps = LL_GLOBAL_GET(key_cmps),
+        .traversal_dels = LL_GLOBAL_GET(traversal_dels),
+    };
+#else
+    return (struct ll_Stats){0};
+#endif
+}
+
+void ll_stats_dump(FILE *f) {
+    assert(f != NULL);
+    struct ll_Stats s = ll_stats_global();
+
+    fprintf(f, "ll: allocs=%zu bytes=%zu nodes_visited=%zu key_cmps=%zu "
+               "traversal_dels=%zu\n",
+            s.allocs, s.bytes, s.nodes_visited, s.key_cmps, s.traversal_dels);
+}
+
 /******************************************************************************/
 /*                                  INTERNAL                                  */
 /******************************************************************************/
@@ -238,16 +714,16 @@ bool ll_empty(struct ll_Header *L) {
 /******************************************************************************/
 
 static bool ll_valid(struct ll_Header *L) {
-    if (L == NULL || L->head == NULL || L->tail == NULL)
+    if (L == NULL)
         return false;
 
-    for (struct ll_Node *p = L->head; p; p = p->next) {
+    for (struct ll_Node *p = &L->head; p; p = p->next) {
         /* Check the next node's previous pointer */
-        if (p != L->tail && p->next != NULL && p->next->prev != p)
+        if (p != &L->tail && p->next != NULL && p->next->prev != p)
             return false;
 
         /* Check previous node's next pointer */
-        if (p != L->head && p->prev->next != p)
+        if (p != &L->head && p->prev->next != p)
             return false;
     }
 
@@ -265,28 +741,48 @@ static bool ll_valid_index(struct ll_Header *L, int index) {
 /******************************************************************************/
 
 static void ll_del_node(ll_t L, struct ll_Node *N) {
+    void *entry = ll_take_node(L, N);
+
+    if (L->entry_free)
+        L->entry_free(entry);
+}
+
+static void *ll_take_node(ll_t L, struct ll_Node *N) {
     assert(ll_valid(L) && N);
+    void *entry = N->entry;
 
     N->next->prev = N->prev;
     N->prev->next = N->next;
 
-    if (L->entry_free)
-        L->entry_free(N->entry);
-
-    free(N);
+    ll_filter_del(L, entry);
+    ll_release_node(L, N);
     L->size--;
 
     assert(ll_valid(L));
+    return entry;
+}
+
+/* Relink the first and last node of L to its sentinels after the header was
+ * copied to a new place */
+static void ll_adopt_sentinels(ll_t L) {
+    if (L->size == 0) {
+        L->head.next = &L->tail;
+        L->tail.prev = &L->head;
+    } else {
+        L->head.next->prev = &L->head;
+        L->tail.prev->next = &L->tail;
+    }
 }
 
 static void ll_traverse_opt(ll_t L, ll_proc_fn *p, void *context, bool rev) {
     assert(ll_valid(L) && p);
 
-    struct ll_Node *curr = rev ? L->tail->prev : L->head->next;
+    struct ll_Node *curr = rev ? L->tail.prev : L->head.next;
     struct ll_Node *tmp;
     enum ll_traversalAction rv;
 
-    while (curr != L->tail && curr != L->head) {
+    while (curr != &L->tail && curr != &L->head) {
+        LL_PREFETCH_AHEAD(curr, rev, true);
         rv = p(curr->entry, context);
 
         switch(rv) {
@@ -301,6 +797,7 @@ static void ll_traverse_opt(ll_t L, ll_proc_fn *p, void *context, bool rev) {
                 tmp = curr;
                 curr = rev ? curr->prev : curr->next;
                 ll_del_node(L, tmp);
+                LL_STAT_ADD(L, traversal_dels, 1);
                 continue;
         }
 
@@ -312,9 +809,28 @@ static void ll_traverse_opt(ll_t L, ll_proc_fn *p, void *context, bool rev) {
 static struct ll_Node *ll_find_node(struct ll_Header *L, void *key, bool rev) {
     assert(ll_valid(L));
 
-    struct ll_Node *curr = rev ? L->tail->prev : L->head->next;
+    uint32_t fp = 0;
+    if (L->key_hash) {
+        uint64_t h = L->key_hash(key);
+
+        if (L->filter && !cuckoo_test(L->filter, h))
+            return NULL;
+        fp = LL_FINGERPRINT(h);
+    }
+
+    struct ll_Node *curr = rev ? L->tail.prev : L->head.next;
+
+    while (curr != &L->tail && curr != &L->head) {
+        /* With fingerprints the entry is rarely needed */
+        LL_PREFETCH_AHEAD(curr, rev, !L->fingerprints);
+        LL_STAT_ADD(L, nodes_visited, 1);
+
+        if (L->fingerprints && ll_hnode(curr)->fp != fp) {
+            curr = rev ? curr->prev : curr->next;
+            continue;
+        }
 
-    while (curr != L->tail && curr != L->head) {
+        LL_STAT_ADD(L, key_cmps, 1);
         if (L->key_cmp(key, L->entry_key(curr->entry)) == 0) {
             assert(ll_valid(L));
             return curr;
@@ -331,16 +847,18 @@ struct ll_Node *ll_node_at(ll_t L, int index) {
 
     struct ll_Node *curr;
     if (index >= 0) {
-        curr = L->head->next;
+        curr = L->head.next;
         for (int i = 0; i < index; i++) {
             curr = curr->next;
         }
+        LL_STAT_ADD(L, nodes_visited, index + 1);
     } else {
-        curr = L->tail->prev;
+        curr = L->tail.prev;
 
         for (int i = -1; i > index; i--) {
             curr = curr->prev;
         }
+        LL_STAT_ADD(L, nodes_visited, -index);
     }
 
     return curr;
@@ -352,13 +870,162 @@ static void ll_insert_node(ll_t L,
                     struct ll_Node *prev) {
 
     /* Create node and fill out info */
-    struct ll_Node *tmp = malloc(sizeof(*tmp));
+    struct ll_Node *tmp = malloc(ll_node_size(L));
     tmp->entry = entry;
-    tmp->next = next;
-    tmp->prev = prev;
+
+    LL_STAT_ADD(L, allocs, 1);
+    LL_STAT_ADD(L, bytes, ll_node_size(L));
+
+    ll_link_node(L, tmp, next, prev);
+}
+
+static void ll_link_node(ll_t L,
+                         struct ll_Node *N,
+                         struct ll_Node *next,
+                         struct ll_Node *prev) {
+    N->next = next;
+    N->prev = prev;
 
     /* Correct pointers in list to point at new node */
-    tmp->prev->next = tmp;
-    tmp->next->prev = tmp;
+    N->prev->next = N;
+    N->next->prev = N;
     L->size++;
+
+    if (L->reorg == LL_REORG_COUNT)
+        ll_hnode(N)->count = 0;
+
+    ll_set_fingerprint(L, N);
+    ll_filter_add(L, N->entry);
+}
+
+static void *ll_replace_entry(ll_t L,
+                              struct ll_Node *N,
+                              void *new_entry,
+                              bool free_old) {
+    void *old = N->entry;
+
+    ll_filter_del(L, old);
+    N->entry = new_entry;
+    ll_set_fingerprint(L, N);
+    ll_filter_add(L, new_entry);
+
+    if (free_old && L->entry_free) {
+        L->entry_free(old);
+        return NULL;
+    }
+    return old;
+}
+
+/******************************************************************************/
+/*                                   Filter                                   */
+/******************************************************************************/
+
+/* (Re)build the filter from scratch at under 50% load, or drop it if the keys
+ * cannot be placed even then (too many duplicates) */
+static void ll_filter_rebuild(ll_t L) {
+    if (L->filter) {
+        cuckoo_free(L->filter);
+        L->filter = NULL;
+    }
+
+    if (!L->key_hash)
+        return;
+
+    cuckoo_t C = cuckoo_new(2 * L->size + 64);
+    for (struct ll_Node *N = L->head.next; N != &L->tail; N = N->next) {
+        if (cuckoo_add(C, L->key_hash(L->entry_key(N->entry)))) {
+            cuckoo_free(C);
+            return;
+        }
+    }
+
+    L->filter = C;
+}
+
+static void ll_filter_add(ll_t L, void *entry) {
+    if (L->filter && cuckoo_add(L->filter, L->key_hash(L->entry_key(entry))))
+        ll_filter_rebuild(L);
+}
+
+static void ll_filter_del(ll_t L, void *entry) {
+    if (L->filter)
+        cuckoo_del(L->filter, L->key_hash(L->entry_key(entry)));
+}
+
+/* Nodes inside the mapping of a loaded list or the block of a compacted one
+ * are not individually allocated */
+static void ll_release_node(ll_t L, struct ll_Node *N) {
+    if (L->map && (char *)N >= (char *)L->map
+            && (char *)N < (char *)L->map + L->map_len)
+        return;
+    if (L->block && (char *)N >= (char *)L->block
+            && (char *)N < (char *)L->block + L->block_len)
+        return;
+
+    free(N);
+    LL_STAT_SUB(L, bytes, ll_node_size(L));
+}
+
+/******************************************************************************/
+/*                                Fingerprints                                */
+/******************************************************************************/
+
+/* Hashed and counting lists allocate ll_HNodes */
+static size_t ll_node_size(ll_t L) {
+    if (L->fingerprints || L->reorg == LL_REORG_COUNT)
+        return sizeof(struct ll_HNode);
+    return sizeof(struct ll_Node);
+}
+
+static void ll_set_fingerprint(ll_t L, struct ll_Node *N) {
+    if (L->fingerprints) {
+        uint64_t h = L->key_hash(L->entry_key(N->entry));
+        ll_hnode(N)->fp = LL_FINGERPRINT(h);
+    }
+}
+
+/******************************************************************************/
+/*                               Reorganization                               */
+/******************************************************************************/
+
+/* Unlink N and link it back in right after prev */
+static void ll_move_node(struct ll_Node *N, struct ll_Node *prev) {
+    N->prev->next = N->next;
+    N->next->prev = N->prev;
+
+    N->prev = prev;
+    N->next = prev->next;
+    prev->next->prev = N;
+    prev->next = N;
+}
+
+static void ll_reorg_node(ll_t L, struct ll_Node *N) {
+    struct ll_Node *prev = N->prev;
+
+    switch (L->reorg) {
+        case LL_REORG_NONE:
+            break;
+
+        case LL_REORG_MOVE_TO_FRONT:
+            if (prev != &L->head)
+                ll_move_node(N, &L->head);
+            break;
+
+        case LL_REORG_TRANSPOSE:
+            if (prev != &L->head)
+                ll_move_node(N, prev->prev);
+            break;
+
+        case LL_REORG_COUNT:
+            if (ll_hnode(N)->count < UINT32_MAX)
+                ll_hnode(N)->count++;
+
+            /* Walk past every node with fewer lookups */
+            while (prev != &L->head
+                   && ll_hnode(prev)->count < ll_hnode(N)->count)
+                prev = prev->prev;
+            if (prev != N->prev)
+                ll_move_node(N, prev);
+            break;
+    }
 }
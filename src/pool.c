@@ -0,0 +1,253 @@
+#include "ds/pool.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+
+struct pool_Job {
+    pool_range_fn *fn;
+    void *context;
+    size_t n;
+    size_t grain;
+};
+
+struct pool_Worker {
+    pool_t P;
+    size_t slot;
+};
+
+static pthread_once_t pool_default_once = PTHREAD_ONCE_INIT;
+static pool_t pool_default_pool;
+
+/******************************************************************************/
+/*                                  Helpers                                   */
+/******************************************************************************/
+
+/* Take the next chunk of slot S; returns false if it has none left */
+static bool pool_take(struct pool_Slot *S, size_t *chunk) {
+    bool found = false;
+
+    pthread_mutex_lock(&S->lock);
+    if (S->lo < S->hi) {
+        *chunk = S->lo++;
+        found = true;
+    }
+    pthread_mutex_unlock(&S->lock);
+    return found;
+}
+
+/* Move the back half of some other slot's chunks into slot self; returns false
+ * once every slot is empty */
+static bool pool_steal(pool_t P, size_t self) {
+    for (size_t i = 1; i < P->nthreads; i++) {
+        struct pool_Slot *V = &P->slots[(self + i) % P->nthreads];
+        size_t lo = 0, hi = 0;
+
+        pthread_mutex_lock(&V->lock);
+        if (V->lo < V->hi) {
+            lo = V->lo + (V->hi - V->lo) / 2;
+            hi = V->hi;
+            V->hi = lo;
+        }
+        pthread_mutex_unlock(&V->lock);
+
+        if (lo < hi) {
+            struct pool_Slot *S = &P->slots[self];
+            pthread_mutex_lock(&S->lock);
+            S->lo = lo;
+            S->hi = hi;
+            pthread_mutex_unlock(&S->lock);
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Run chunks of J from slot self, then from other slots, until none are left */
+static void pool_work(pool_t P, struct pool_Job *J, size_t self) {
+    size_t chunk;
+
+    do {
+        while (pool_take(&P->slots[self], &chunk)) {
+            size_t begin = chunk * J->grain;
+            size_t end = J->n - begin < J->grain ? J->n : begin + J->grain;
+            J->fn(J->context, begin, end, chunk);
+        }
+    } while (pool_steal(P, self));
+}
+
+static void *pool_worker_run(void *arg) {
+    struct pool_Worker *W = arg;
+    pool_t P = W->P;
+    size_t seen = 0;
+
+    pthread_mutex_lock(&P->lock);
+    for (;;) {
+        while (!P->stop && (P->job == NULL || P->gen == seen))
+            pthread_cond_wait(&P->wake, &P->lock);
+        if (P->stop)
+            break;
+
+        struct pool_Job *J = P->job;
+        seen = P->gen;
+        P->active++;
+        pthread_mutex_unlock(&P->lock);
+
+        pool_work(P, J, W->slot);
+
+        pthread_mutex_lock(&P->lock);
+        if (--P->active == 0)
+            pthread_cond_signal(&P->idle);
+    }
+    pthread_mutex_unlock(&P->lock);
+
+    free(W);
+    return NULL;
+}
+
+static void pool_default_free(void) {
+    pool_free(pool_default_pool);
+}
+
+static void pool_default_init(void) {
+    pool_default_pool = pool_new(0);
+    atexit(&pool_default_free);
+}
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+/*                            Init and Teardown                               */
+/******************************************************************************/
+
+pool_t pool_new(size_t nthreads) {
+    struct pool_Header *P = malloc(sizeof(*P));
+
+    if (nthreads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = cpus > 0 ? cpus : 1;
+    }
+
+    P->nthreads = nthreads;
+    P->slots = aligned_alloc(_Alignof(struct pool_Slot),
+                             nthreads * sizeof(*P->slots));
+    for (size_t i = 0; i < nthreads; i++) {
+        pthread_mutex_init(&P->slots[i].lock, NULL);
+        P->slots[i].lo = 0;
+        P->slots[i].hi = 0;
+    }
+
+    pthread_mutex_init(&P->job_lock, NULL);
+    pthread_mutex_init(&P->lock, NULL);
+    pthread_cond_init(&P->wake, NULL);
+    pthread_cond_init(&P->idle, NULL);
+    P->job = NULL;
+    P->gen = 0;
+    P->active = 0;
+    P->stop = false;
+
+    /* The last slot belongs to whichever thread calls pool_for */
+    P->threads = malloc(nthreads * sizeof(*P->threads));
+    for (size_t i = 0; i < nthreads - 1; i++) {
+        struct pool_Worker *W = malloc(sizeof(*W));
+        W->P = P;
+        W->slot = i;
+        pthread_create(&P->threads[i], NULL, &pool_worker_run, W);
+    }
+
+    return P;
+}
+
+void pool_free(pool_t P) {
+    assert(P != NULL);
+
+    pthread_mutex_lock(&P->lock);
+    P->stop = true;
+    pthread_cond_broadcast(&P->wake);
+    pthread_mutex_unlock(&P->lock);
+
+    for (size_t i = 0; i < P->nthreads - 1; i++)
+        pthread_join(P->threads[i], NULL);
+
+    for (size_t i = 0; i < P->nthreads; i++)
+        pthread_mutex_destroy(&P->slots[i].lock);
+    pthread_mutex_destroy(&P->job_lock);
+    pthread_mutex_destroy(&P->lock);
+    pthread_cond_destroy(&P->wake);
+    pthread_cond_destroy(&P->idle);
+
+    free(P->threads);
+    free(P->slots);
+    free(P);
+}
+
+pool_t pool_default(void) {
+    pthread_once(&pool_default_once, &pool_default_init);
+    return pool_default_pool;
+}
+
+/******************************************************************************/
+/*                                 Accessors                                  */
+/******************************************************************************/
+
+size_t pool_threads(pool_t P) {
+    assert(P != NULL);
+    return P->nthreads;
+}
+
+size_t pool_grain(pool_t P, size_t n) {
+    assert(P != NULL);
+    size_t chunks = P->nthreads * POOL_CHUNKS_PER_THREAD;
+    size_t grain = (n + chunks - 1) / chunks;
+
+    return grain < POOL_MIN_GRAIN ? POOL_MIN_GRAIN : grain;
+}
+
+/******************************************************************************/
+/*                                    Jobs                                    */
+/******************************************************************************/
+
+void pool_for(pool_t P, size_t n, size_t grain, pool_range_fn *fn, void *context) {
+    assert(P != NULL && fn != NULL && grain > 0);
+    size_t nchunks = (n + grain - 1) / grain;
+    struct pool_Job J = { fn, context, n, grain };
+
+    if (nchunks == 0)
+        return;
+
+    pthread_mutex_lock(&P->job_lock);
+
+    /* Hand every thread an equal run of chunks up front */
+    for (size_t i = 0; i < P->nthreads; i++) {
+        struct pool_Slot *S = &P->slots[i];
+        pthread_mutex_lock(&S->lock);
+        S->lo = nchunks * i / P->nthreads;
+        S->hi = nchunks * (i + 1) / P->nthreads;
+        pthread_mutex_unlock(&S->lock);
+    }
+
+    if (nchunks > 1 && P->nthreads > 1) {
+        pthread_mutex_lock(&P->lock);
+        P->job = &J;
+        P->gen++;
+        pthread_cond_broadcast(&P->wake);
+        pthread_mutex_unlock(&P->lock);
+    }
+
+    pool_work(P, &J, P->nthreads - 1);
+
+    /* Every chunk is taken; wait for workers still running theirs */
+    pthread_mutex_lock(&P->lock);
+    P->job = NULL;
+    while (P->active > 0)
+        pthread_cond_wait(&P->idle, &P->lock);
+    pthread_mutex_unlock(&P->lock);
+
+    pthread_mutex_unlock(&P->job_lock);
+}
@@ -0,0 +1,166 @@
+#include "ds/pq.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#define PQ_ARITY 4
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+/*                                  Helpers                                   */
+/******************************************************************************/
+
+static inline void pq_place(pq_t P, void **d, size_t index, void *entry) {
+    d[index] = entry;
+    if (P->set_index)
+        P->set_index(entry, index);
+}
+
+static void pq_sift_up(pq_t P, size_t index) {
+    void **d = uba_data(P->heap);
+    void *entry = d[index];
+
+    while (index > 0) {
+        size_t parent = (index - 1) / PQ_ARITY;
+        if (P->cmp(entry, d[parent]) >= 0)
+            break;
+
+        pq_place(P, d, index, d[parent]);
+        index = parent;
+    }
+
+    pq_place(P, d, index, entry);
+}
+
+static void pq_sift_down(pq_t P, size_t index) {
+    void **d = uba_data(P->heap);
+    size_t n = uba_size(P->heap);
+    void *entry = d[index];
+
+    for (;;) {
+        size_t first = PQ_ARITY * index + 1;
+        if (first >= n)
+            break;
+
+        /* The children are adjacent, usually within one cache line */
+        size_t last = first + PQ_ARITY < n ? first + PQ_ARITY : n;
+        size_t best = first;
+        for (size_t c = first + 1; c < last; c++) {
+            if (P->cmp(d[c], d[best]) < 0)
+                best = c;
+        }
+
+        if (P->cmp(d[best], entry) >= 0)
+            break;
+
+        pq_place(P, d, index, d[best]);
+        index = best;
+    }
+
+    pq_place(P, d, index, entry);
+}
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+/*                              Init & Teardown                               */
+/******************************************************************************/
+
+pq_t pq_new(size_t limit,
+            pq_cmp_fn *cmp,
+            pq_index_fn *set_index,
+            uba_entry_free_fn *entry_free) {
+    assert(cmp);
+    return pq_heapify(uba_new(limit, false, entry_free), cmp, set_index);
+}
+
+pq_t pq_heapify(uba_t U, pq_cmp_fn *cmp, pq_index_fn *set_index) {
+    assert(U != NULL && !uba_raw(U) && !uba_paged(U) && cmp);
+    struct pq_Header *P = malloc(sizeof(*P));
+
+    P->heap = U;
+    P->cmp = cmp;
+    P->set_index = set_index;
+
+    size_t n = uba_size(U);
+    void **d = uba_data(U);
+
+    if (set_index) {
+        for (size_t i = 0; i < n; i++)
+            set_index(d[i], i);
+    }
+
+    /* Sift down every parent, last parent first */
+    for (size_t i = n > 1 ? (n - 2) / PQ_ARITY + 1 : 0; i > 0; i--)
+        pq_sift_down(P, i - 1);
+
+    return P;
+}
+
+void pq_free(pq_t P) {
+    assert(P != NULL);
+    uba_free(P->heap);
+    free(P);
+}
+
+/******************************************************************************/
+/*                                 Accessors                                  */
+/******************************************************************************/
+
+size_t pq_size(pq_t P) {
+    assert(P != NULL);
+    return uba_size(P->heap);
+}
+
+bool pq_empty(pq_t P) {
+    assert(P != NULL);
+    return uba_empty(P->heap);
+}
+
+void *pq_peek(pq_t P) {
+    assert(P != NULL && !pq_empty(P));
+    return uba_get(P->heap, 0);
+}
+
+/******************************************************************************/
+/*                                  Mutators                                  */
+/******************************************************************************/
+
+void pq_push(pq_t P, void *entry) {
+    assert(P != NULL && entry);
+    uba_push(P->heap, entry);
+    pq_sift_up(P, uba_size(P->heap) - 1);
+}
+
+void *pq_pop(pq_t P) {
+    assert(P != NULL && !pq_empty(P));
+    return pq_remove(P, 0);
+}
+
+void pq_update(pq_t P, size_t index) {
+    assert(P != NULL && index < pq_size(P));
+    void **d = uba_data(P->heap);
+
+    if (index > 0 && P->cmp(d[index], d[(index - 1) / PQ_ARITY]) < 0)
+        pq_sift_up(P, index);
+    else
+        pq_sift_down(P, index);
+}
+
+void *pq_remove(pq_t P, size_t index) {
+    assert(P != NULL && index < pq_size(P));
+    void **d = uba_data(P->heap);
+    void *entry = d[index];
+
+    /* Detach the last entry without freeing it and refill the hole with it */
+    void *last = uba_pop_take(P->heap);
+
+    if (index < uba_size(P->heap)) {
+        d[index] = last;
+        pq_update(P, index);
+    }
+
+    return entry;
+}
@@ -0,0 +1,125 @@
+#include "ds/reclaim.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+
+struct reclaim_Job {
+    struct reclaim_Job *next;
+    void *obj;
+    reclaim_step_fn *step;
+};
+
+/* FIFO of queued jobs, worked off by one thread */
+static struct {
+    pthread_once_t once;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t idle;
+
+    struct reclaim_Job *head;
+    struct reclaim_Job *tail;
+    bool busy;
+    bool stop;
+} reclaim = {
+    .once = PTHREAD_ONCE_INIT,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work = PTHREAD_COND_INITIALIZER,
+    .idle = PTHREAD_COND_INITIALIZER,
+};
+
+/******************************************************************************/
+/*                                  Helpers                                   */
+/******************************************************************************/
+
+/* Append J to the queue; the lock must be held */
+static void reclaim_enqueue(struct reclaim_Job *J) {
+    J->next = NULL;
+    if (reclaim.tail)
+        reclaim.tail->next = J;
+    else
+        reclaim.head = J;
+    reclaim.tail = J;
+}
+
+static void *reclaim_run(void *arg) {
+    (void)arg;
+
+    pthread_mutex_lock(&reclaim.lock);
+    for (;;) {
+        while (!reclaim.head && !reclaim.stop)
+            pthread_cond_wait(&reclaim.work, &reclaim.lock);
+        if (!reclaim.head)
+            break;
+
+        struct reclaim_Job *J = reclaim.head;
+        reclaim.head = J->next;
+        if (!reclaim.head)
+            reclaim.tail = NULL;
+        reclaim.busy = true;
+        pthread_mutex_unlock(&reclaim.lock);
+
+        bool done = J->step(J->obj, RECLAIM_BATCH);
+
+        pthread_mutex_lock(&reclaim.lock);
+        reclaim.busy = false;
+
+        /* An unfinished job goes to the back so queued jobs take turns */
+        if (done)
+            free(J);
+        else
+            reclaim_enqueue(J);
+        if (!reclaim.head)
+            pthread_cond_broadcast(&reclaim.idle);
+    }
+    pthread_mutex_unlock(&reclaim.lock);
+
+    return NULL;
+}
+
+/* Finish the queue and stop the thread so nothing is left behind at exit */
+static void reclaim_stop(void) {
+    pthread_mutex_lock(&reclaim.lock);
+    reclaim.stop = true;
+    pthread_cond_signal(&reclaim.work);
+    pthread_mutex_unlock(&reclaim.lock);
+
+    pthread_join(reclaim.thread, NULL);
+}
+
+static void reclaim_start(void) {
+    pthread_create(&reclaim.thread, NULL, &reclaim_run, NULL);
+    atexit(&reclaim_stop);
+}
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+
+void reclaim_defer(void *obj, reclaim_step_fn *step) {
+    assert(obj != NULL && step != NULL);
+    struct reclaim_Job *J = malloc(sizeof(*J));
+
+    J->obj = obj;
+    J->step = step;
+
+    pthread_once(&reclaim.once, &reclaim_start);
+
+    pthread_mutex_lock(&reclaim.lock);
+    reclaim_enqueue(J);
+    pthread_cond_signal(&reclaim.work);
+    pthread_mutex_unlock(&reclaim.lock);
+}
+
+void reclaim_drain(void) {
+    pthread_mutex_lock(&reclaim.lock);
+    while (reclaim.head || reclaim.busy)
+        pthread_cond_wait(&reclaim.idle, &reclaim.lock);
+    pthread_mutex_unlock(&reclaim.lock);
+}
@@ -0,0 +1,204 @@
+#include "ds/ring.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RING_RELAX() __builtin_ia32_pause()
+#else
+#define RING_RELAX() atomic_signal_fence(memory_order_seq_cst)
+#endif
+
+/******************************************************************************/
+/*                                  Helpers                                   */
+/******************************************************************************/
+
+static void ring_futex(atomic_uint *word, int op, unsigned val) {
+    syscall(SYS_futex, (unsigned *)word, op, val, NULL, NULL, 0);
+}
+
+/* Wake the consumer if it sleeps. The fence orders the caller's store of tail
+ * (or closed) before the load of sleeping; ring_sleep orders the same pair the
+ * other way round, so one of them always sees the other's store. */
+static void ring_wake(ring_t R) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&R->sleeping, memory_order_relaxed)) {
+        atomic_store_explicit(&R->sleeping, 0, memory_order_relaxed);
+        ring_futex(&R->sleeping, FUTEX_WAKE_PRIVATE, 1);
+    }
+}
+
+/* Sleep until the producer pushes past head or closes R */
+static void ring_sleep(ring_t R, size_t head) {
+    atomic_store_explicit(&R->sleeping, 1, memory_order_seq_cst);
+
+    if (atomic_load_explicit(&R->tail, memory_order_seq_cst) == head
+            && !atomic_load_explicit(&R->closed, memory_order_seq_cst))
+        ring_futex(&R->sleeping, FUTEX_WAIT_PRIVATE, 1);
+
+    atomic_store_explicit(&R->sleeping, 0, memory_order_relaxed);
+}
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+/*                            Init and Teardown                               */
+/******************************************************************************/
+
+ring_t ring_new(size_t capacity, ring_entry_free_fn *entry_free) {
+    assert(0 < capacity && capacity <= SIZE_MAX / 2 + 1);
+    struct ring_Header *R = aligned_alloc(_Alignof(struct ring_Header),
+                                          sizeof(*R));
+    size_t cap = 1;
+
+    while (cap < capacity)
+        cap <<= 1;
+
+    R->slot = malloc(sizeof(void *) * cap);
+    R->mask = cap - 1;
+    R->entry_free = entry_free;
+
+    atomic_init(&R->tail, 0);
+    R->head_cache = 0;
+    atomic_init(&R->closed, false);
+
+    atomic_init(&R->head, 0);
+    R->tail_cache = 0;
+
+    atomic_init(&R->sleeping, 0);
+
+    return R;
+}
+
+void ring_free(ring_t R) {
+    assert(R != NULL);
+    void *entry;
+
+    if (R->entry_free) {
+        while ((entry = ring_pop(R)))
+            R->entry_free(entry);
+    }
+
+    free(R->slot);
+    free(R);
+}
+
+/******************************************************************************/
+/*                                 Accessors                                  */
+/******************************************************************************/
+
+size_t ring_capacity(ring_t R) {
+    assert(R != NULL);
+    return R->mask + 1;
+}
+
+size_t ring_size(ring_t R) {
+    assert(R != NULL);
+
+    /* head first: tail only grows, so the difference cannot go negative */
+    size_t head = atomic_load_explicit(&R->head, memory_order_acquire);
+    return atomic_load_explicit(&R->tail, memory_order_acquire) - head;
+}
+
+bool ring_closed(ring_t R) {
+    assert(R != NULL);
+    return atomic_load_explicit(&R->closed, memory_order_acquire);
+}
+
+/******************************************************************************/
+/*                                  Producer                                  */
+/******************************************************************************/
+
+bool ring_push(ring_t R, void *entry) {
+    assert(R != NULL && entry != NULL);
+    return ring_push_n(R, &entry, 1) == 1;
+}
+
+size_t ring_push_n(ring_t R, void **entries, size_t n) {
+    assert(R != NULL && (entries != NULL || n == 0) && !ring_closed(R));
+    size_t tail = atomic_load_explicit(&R->tail, memory_order_relaxed);
+    size_t room = R->mask + 1 - (tail - R->head_cache);
+
+    if (room < n) {
+        R->head_cache = atomic_load_explicit(&R->head, memory_order_acquire);
+        room = R->mask + 1 - (tail - R->head_cache);
+    }
+    n = n < room ? n : room;
+
+    for (size_t i = 0; i < n; i++) {
+        assert(entries[i] != NULL);
+        R->slot[(tail + i) & R->mask] = entries[i];
+    }
+
+    /* One release store publishes the whole batch */
+    if (n > 0) {
+        atomic_store_explicit(&R->tail, tail + n, memory_order_release);
+        ring_wake(R);
+    }
+    return n;
+}
+
+void ring_close(ring_t R) {
+    assert(R != NULL);
+    atomic_store_explicit(&R->closed, true, memory_order_release);
+    ring_wake(R);
+}
+
+/******************************************************************************/
+/*                                  Consumer                                  */
+/******************************************************************************/
+
+void *ring_pop(ring_t R) {
+    assert(R != NULL);
+    void *entry;
+
+    return ring_pop_n(R, &entry, 1) ? entry : NULL;
+}
+
+size_t ring_pop_n(ring_t R, void **out, size_t n) {
+    assert(R != NULL && (out != NULL || n == 0));
+    size_t head = atomic_load_explicit(&R->head, memory_order_relaxed);
+    size_t avail = R->tail_cache - head;
+
+    if (avail < n) {
+        R->tail_cache = atomic_load_explicit(&R->tail, memory_order_acquire);
+        avail = R->tail_cache - head;
+    }
+    n = n < avail ? n : avail;
+
+    for (size_t i = 0; i < n; i++)
+        out[i] = R->slot[(head + i) & R->mask];
+
+    if (n > 0)
+        atomic_store_explicit(&R->head, head + n, memory_order_release);
+    return n;
+}
+
+size_t ring_pop_wait(ring_t R, void **out, size_t n) {
+    assert(R != NULL && out != NULL && 0 < n);
+    size_t got;
+
+    for (;;) {
+        for (int spin = 0; spin < RING_SPIN; spin++) {
+            if ((got = ring_pop_n(R, out, n)))
+                return got;
+            RING_RELAX();
+        }
+
+        /* Entries pushed before ring_close are visible once closed is */
+        if (ring_closed(R))
+            return ring_pop_n(R, out, n);
+
+        ring_sleep(R, atomic_load_explicit(&R->head, memory_order_relaxed));
+    }
+}
@@ -0,0 +1,424 @@
+#include "ds/seq.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+/*                                 Statistics                                 */
+/******************************************************************************/
+
+#ifdef DS_STATS
+/* Shared by every thread using sequences, so atomic (see ll.c) */
+static struct {
+    atomic_size_t to_chunked;
+    atomic_size_t to_array;
+    atomic_size_t entries_moved;
+} seq_global_stats;
+
+#define SEQ_GLOBAL_GET(field) \
+    atomic_load_explicit(&seq_global_stats.field, memory_order_relaxed)
+
+#define SEQ_STAT_ADD(S, field, n) \
+    ((S)->stats.field += (n), \
+     atomic_fetch_add_explicit(&seq_global_stats.field, (n), memory_order_relaxed))
+#else
+#define SEQ_STAT_ADD(S, field, n) ((void)0)
+#endif
+
+/******************************************************************************/
+/*                                   Chunks                                   */
+/******************************************************************************/
+
+/* Chunks emptied below this by removals merge with a neighbour */
+#define SEQ_CHUNK_MERGE (SEQ_CHUNK / 2)
+
+static struct seq_Chunk *seq_chunk_new(void) {
+    struct seq_Chunk *C = malloc(sizeof(*C));
+    if (!C)
+        abort();
+
+    C->next = C->prev = NULL;
+    C->count = 0;
+    return C;
+}
+
+/* Link C after prev, or at the head if prev is NULL */
+static void seq_chunk_link(seq_t S, struct seq_Chunk *C, struct seq_Chunk *prev) {
+    C->prev = prev;
+    C->next = prev ? prev->next : S->head;
+    if (C->next)
+        C->next->prev = C;
+    else
+        S->tail = C;
+    if (prev)
+        prev->next = C;
+    else
+        S->head = C;
+}
+
+static void seq_chunk_unlink(seq_t S, struct seq_Chunk *C) {
+    if (C->prev)
+        C->prev->next = C->next;
+    else
+        S->head = C->next;
+    if (C->next)
+        C->next->prev = C->prev;
+    else
+        S->tail = C->prev;
+}
+
+/* Move the entries of C's successor into C and free it */
+static void seq_chunk_merge_next(seq_t S, struct seq_Chunk *C) {
+    struct seq_Chunk *N = C->next;
+
+    memcpy(C->entry + C->count, N->entry, N->count * sizeof(void *));
+    C->count += N->count;
+    seq_chunk_unlink(S, N);
+    free(N);
+}
+
+/* Return the chunk holding index, or the tail for index == size, and store
+ * the index of its first entry in *base. Walks from the head, the tail or
+ * the cursor, whichever is closest, and leaves the cursor on the result. */
+static struct seq_Chunk *seq_find(seq_t S, size_t index, size_t *base) {
+    struct seq_Chunk *C = S->head;
+    size_t b = 0;
+
+    if (S->size - index < index) {
+        C = S->tail;
+        b = S->size - C->count;
+    }
+    if (S->cursor) {
+        size_t from_cursor = index > S->cursor_base ? index - S->cursor_base
+                                                     : S->cursor_base - index;
+        if (from_cursor < (index < S->size - index ? index : S->size - index)) {
+            C = S->cursor;
+            b = S->cursor_base;
+        }
+    }
+
+    while (index >= b + C->count && C->next) {
+        b += C->count;
+        C = C->next;
+    }
+    while (index < b) {
+        C = C->prev;
+        b -= C->count;
+    }
+
+    S->cursor = C;
+    S->cursor_base = b;
+    *base = b;
+    return C;
+}
+
+static void seq_chunked_insert(seq_t S, size_t index, void *entry) {
+    struct seq_Chunk *C;
+    size_t b, off;
+
+    if (!S->head)
+        seq_chunk_link(S, seq_chunk_new(), NULL);
+
+    C = seq_find(S, index, &b);
+    off = index - b;
+
+    if (C->count == SEQ_CHUNK && off == SEQ_CHUNK) {
+        /* Past the end of a full chunk: start the next one */
+        if (!C->next || C->next->count == SEQ_CHUNK)
+            seq_chunk_link(S, seq_chunk_new(), C);
+        b += C->count;
+        C = C->next;
+        off = 0;
+    } else if (C->count == SEQ_CHUNK) {
+        /* Split, moving the upper half to a new chunk */
+        struct seq_Chunk *N = seq_chunk_new();
+        size_t half = SEQ_CHUNK / 2;
+
+        memcpy(N->entry, C->entry + half, (SEQ_CHUNK - half) * sizeof(void *));
+        N->count = SEQ_CHUNK - half;
+        C->count = half;
+        seq_chunk_link(S, N, C);
+
+        if (off > half) {
+            b += half;
+            off -= half;
+            C = N;
+        }
+    }
+
+    memmove(C->entry + off + 1, C->entry + off, (C->count - off) * sizeof(void *));
+    C->entry[off] = entry;
+    C->count++;
+
+    S->cursor = C;
+    S->cursor_base = b;
+}
+
+static void *seq_chunked_take(seq_t S, size_t index) {
+    size_t b, off;
+    struct seq_Chunk *C = seq_find(S, index, &b);
+    void *entry;
+
+    off = index - b;
+    entry = C->entry[off];
+    memmove(C->entry + off, C->entry + off + 1, (C->count - off - 1) * sizeof(void *));
+    C->count--;
+
+    if (C->count == 0) {
+        seq_chunk_unlink(S, C);
+        free(C);
+        S->cursor = NULL;
+        return entry;
+    }
+
+    if (C->prev && C->prev->count + C->count <= SEQ_CHUNK_MERGE) {
+        C = C->prev;
+        b -= C->count;
+    }
+    if (C->next && C->count + C->next->count <= SEQ_CHUNK_MERGE)
+        seq_chunk_merge_next(S, C);
+
+    S->cursor = C;
+    S->cursor_base = b;
+    return entry;
+}
+
+/******************************************************************************/
+/*                                   Policy                                   */
+/******************************************************************************/
+
+/* Count one operation, mid if it inserted or removed away from both ends,
+ * and change layout at the end of a window if the mix calls for it */
+static void seq_note(seq_t S, bool mid) {
+    struct seq_Tuning *T = &S->tuning;
+
+    if (T->window == 0)
+        return;
+    S->window_mid += mid;
+    if (++S->window_ops < T->window)
+        return;
+
+    double share = (double)S->window_mid / S->window_ops;
+    S->window_ops = S->window_mid = 0;
+
+    if (S->layout == SEQ_ARRAY && S->size >= T->min_size && share >= T->to_chunked)
+        seq_convert(S, SEQ_CHUNKED);
+    else if (S->layout == SEQ_CHUNKED && (S->size < T->min_size || share <= T->to_array))
+        seq_convert(S, SEQ_ARRAY);
+}
+
+static bool seq_is_mid(seq_t S, size_t index) {
+    return index != 0 && index != S->size;
+}
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+/*                             Init and Teardown                              */
+/******************************************************************************/
+
+seq_t seq_new(seq_entry_free_fn *entry_free) {
+    struct seq_Header *S = calloc(1, sizeof(*S));
+    if (!S)
+        abort();
+
+    S->layout = SEQ_ARRAY;
+    S->entry_free = entry_free;
+    S->array = uba_new(16, false, entry_free);
+    S->tuning = SEQ_TUNING_DEFAULT;
+    return S;
+}
+
+void seq_free(seq_t S) {
+    assert(S != NULL);
+
+    if (S->layout == SEQ_ARRAY) {
+        uba_free(S->array);
+    } else {
+        struct seq_Chunk *C = S->head, *next;
+        for (; C; C = next) {
+            next = C->next;
+            if (S->entry_free) {
+                for (size_t i = 0; i < C->count; i++) {
+                    if (C->entry[i])
+                        S->entry_free(C->entry[i]);
+                }
+            }
+            free(C);
+        }
+    }
+    free(S);
+}
+
+void seq_set_tuning(seq_t S, struct seq_Tuning tuning) {
+    assert(S != NULL && 0 <= tuning.to_array && tuning.to_array <= tuning.to_chunked);
+
+    S->tuning = tuning;
+    S->window_ops = S->window_mid = 0;
+}
+
+void seq_convert(seq_t S, enum seq_layout layout) {
+    assert(S != NULL);
+
+    if (S->layout == layout)
+        return;
+
+    if (layout == SEQ_CHUNKED) {
+        size_t n, fill = SEQ_CHUNK / 4 * 3;
+        void **data = uba_steal_buffer(S->array, &n);
+
+        S->array = NULL;
+        for (size_t i = 0; i < n; i += fill) {
+            struct seq_Chunk *C = seq_chunk_new();
+            C->count = n - i < fill ? n - i : fill;
+            memcpy(C->entry, data + i, C->count * sizeof(void *));
+            seq_chunk_link(S, C, S->tail);
+        }
+        free(data);
+        S->cursor = NULL;
+        SEQ_STAT_ADD(S, to_chunked, 1);
+    } else {
+        uba_t A = uba_new(S->size + 1, false, S->entry_free);
+        void **out = uba_data(A);
+        struct seq_Chunk *C = S->head, *next;
+
+        for (; C; C = next) {
+            next = C->next;
+            memcpy(out, C->entry, C->count * sizeof(void *));
+            out += C->count;
+            free(C);
+        }
+        A->size = S->size;
+        S->array = A;
+        S->head = S->tail = S->cursor = NULL;
+        SEQ_STAT_ADD(S, to_array, 1);
+    }
+
+    S->layout = layout;
+    SEQ_STAT_ADD(S, entries_moved, S->size);
+}
+
+/******************************************************************************/
+/*                                 Accessors                                  */
+/******************************************************************************/
+
+size_t seq_size(seq_t S) {
+    assert(S != NULL);
+    return S->size;
+}
+
+bool seq_empty(seq_t S) {
+    assert(S != NULL);
+    return S->size == 0;
+}
+
+enum seq_layout seq_layout(seq_t S) {
+    assert(S != NULL);
+    return S->layout;
+}
+
+struct seq_Stats seq_stats(seq_t S) {
+    assert(S != NULL);
+#ifdef DS_STATS
+    return S->stats;
+#else
+    return (struct seq_Stats){0};
+#endif
+}
+
+struct seq_Stats seq_stats_global(void) {
+#ifdef DS_STATS
+    return (struct seq_Stats){
+        .to_chunked = SEQ_GLOBAL_GET(to_chunked),
+        .to_array = SEQ_GLOBAL_GET(to_array),
+        .entries_moved = SEQ_GLOBAL_GET(entries_moved),
+    };
+#else
+    return (struct seq_Stats){0};
+#endif
+}
+
+void *seq_get(seq_t S, size_t index) {
+    assert(S != NULL && index < S->size);
+    void *entry;
+
+    if (S->layout == SEQ_ARRAY) {
+        entry = uba_get(S->array, index);
+    } else {
+        size_t b;
+        struct seq_Chunk *C = seq_find(S, index, &b);
+        entry = C->entry[index - b];
+    }
+
+    seq_note(S, false);
+    return entry;
+}
+
+/******************************************************************************/
+/*                                 Modifiers                                  */
+/******************************************************************************/
+
+void seq_push(seq_t S, void *entry) {
+    seq_insert(S, S->size, entry);
+}
+
+void seq_pop(seq_t S) {
+    assert(S != NULL && S->size > 0);
+    seq_remove(S, S->size - 1);
+}
+
+void seq_insert(seq_t S, size_t index, void *entry) {
+    assert(S != NULL && index <= S->size);
+    bool mid = seq_is_mid(S, index);
+
+    if (S->layout == SEQ_ARRAY)
+        uba_insert(S->array, index, entry);
+    else
+        seq_chunked_insert(S, index, entry);
+    S->size++;
+
+    seq_note(S, mid);
+}
+
+void seq_remove(seq_t S, size_t index) {
+    void *entry = seq_take(S, index);
+
+    if (S->entry_free && entry)
+        S->entry_free(entry);
+}
+
+void *seq_take(seq_t S, size_t index) {
+    assert(S != NULL && index < S->size);
+    bool mid = index != 0 && index != S->size - 1;
+    void *entry;
+
+    if (S->layout == SEQ_ARRAY)
+        entry = uba_take(S->array, index);
+    else
+        entry = seq_chunked_take(S, index);
+    S->size--;
+
+    seq_note(S, mid);
+    return entry;
+}
+
+void seq_update(seq_t S, size_t index, void *entry) {
+    assert(S != NULL && index < S->size);
+
+    if (S->layout == SEQ_ARRAY) {
+        uba_update(S->array, index, entry);
+    } else {
+        size_t b;
+        struct seq_Chunk *C = seq_find(S, index, &b);
+        if (S->entry_free && C->entry[index - b])
+            S->entry_free(C->entry[index - b]);
+        C->entry[index - b] = entry;
+    }
+
+    seq_note(S, false);
+}
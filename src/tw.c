@@ -0,0 +1,237 @@
+#include "ds/tw.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+
+#define TW_MASK (TW_SLOTS - 1)
+#define TW_BATCH (TW_LEVELS * TW_SLOTS)
+
+/* Ticks ahead of clock the wheel can place a timer */
+#define TW_SPAN ((uint64_t)1 << (TW_BITS * TW_LEVELS))
+
+/******************************************************************************/
+/*                                  Helpers                                   */
+/******************************************************************************/
+
+static void tw_link(tw_t W, struct tw_Timer *T, uint32_t slot) {
+    struct tw_Timer **head = &W->slot[slot];
+
+    T->slot = slot;
+    T->prev = NULL;
+    T->next = *head;
+    if (*head)
+        (*head)->prev = T;
+    *head = T;
+
+    if (slot < TW_BATCH)
+        W->level_size[slot / TW_SLOTS]++;
+}
+
+static void tw_unlink(tw_t W, struct tw_Timer *T) {
+    if (T->prev)
+        T->prev->next = T->next;
+    else
+        W->slot[T->slot] = T->next;
+    if (T->next)
+        T->next->prev = T->prev;
+
+    if (T->slot < TW_BATCH)
+        W->level_size[T->slot / TW_SLOTS]--;
+}
+
+/* Link T into the slot covering its expiry as seen from clock: level l holds
+ * timers 2^(TW_BITS * l) to 2^(TW_BITS * (l + 1)) ticks away, in the slot
+ * their expiry falls in at that level's granularity */
+static void tw_place(tw_t W, struct tw_Timer *T) {
+    uint64_t expires = T->expires > W->clock ? T->expires : W->clock;
+    uint64_t delta = expires - W->clock;
+    uint32_t level = 0;
+
+    if (delta >= TW_SPAN) {
+        delta = TW_SPAN - 1;
+        expires = W->clock + delta;
+    }
+    while (delta >> (TW_BITS * (level + 1)))
+        level++;
+
+    tw_link(W, T, level * TW_SLOTS + ((expires >> (TW_BITS * level)) & TW_MASK));
+}
+
+/* Place every timer of slot again, now that clock reached its start */
+static void tw_cascade(tw_t W, uint32_t slot) {
+    struct tw_Timer *T = W->slot[slot], *next;
+
+    W->slot[slot] = NULL;
+    for (; T; T = next) {
+        next = T->next;
+        W->level_size[slot / TW_SLOTS]--;
+        tw_place(W, T);
+    }
+}
+
+/* Return the first tick after clock at which anything can happen: the next
+ * boundary of the lowest level holding timers, as the levels below it are
+ * empty until that level cascades into them */
+static uint64_t tw_next_tick(tw_t W) {
+    uint32_t level = 0;
+
+    while (level < TW_LEVELS - 1 && W->level_size[level] == 0)
+        level++;
+    if (level == 0)
+        return W->clock;
+
+    uint64_t mask = ((uint64_t)1 << (TW_BITS * level)) - 1;
+    return (W->clock & mask) ? (W->clock | mask) + 1 : W->clock;
+}
+
+/* Fire the timers of level 0's slot for clock, as one batch */
+static size_t tw_fire(tw_t W, uint32_t slot) {
+    struct tw_Timer *T = W->slot[slot];
+    size_t fired = 0;
+
+    W->slot[TW_BATCH] = T;
+    W->slot[slot] = NULL;
+    for (; T; T = T->next) {
+        T->slot = TW_BATCH;
+        W->level_size[0]--;
+    }
+
+    /* Callbacks may cancel timers further down the batch */
+    while ((T = W->slot[TW_BATCH])) {
+        tw_unlink(W, T);
+        T->pending = false;
+        W->size--;
+        T->fire(T->entry, T);
+        fired++;
+    }
+    return fired;
+}
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+/*                             Init and Teardown                              */
+/******************************************************************************/
+
+tw_t tw_new(uint64_t now) {
+    assert(now < UINT64_MAX - TW_SPAN);
+    struct tw_Header *W = calloc(1, sizeof(*W));
+    if (!W)
+        abort();
+
+    W->now = now;
+    W->clock = now + 1;
+    return W;
+}
+
+void tw_free(tw_t W) {
+    assert(W != NULL);
+
+    for (size_t i = 0; i < TW_BATCH; i++) {
+        for (struct tw_Timer *T = W->slot[i]; T; T = T->next)
+            T->pending = false;
+    }
+    free(W);
+}
+
+void tw_timer_init(struct tw_Timer *T, tw_fire_fn *fire, void *entry) {
+    assert(T != NULL && fire != NULL);
+
+    T->entry = entry;
+    T->next = T->prev = NULL;
+    T->expires = 0;
+    T->fire = fire;
+    T->slot = 0;
+    T->pending = false;
+}
+
+/******************************************************************************/
+/*                                 Accessors                                  */
+/******************************************************************************/
+
+uint64_t tw_now(tw_t W) {
+    assert(W != NULL);
+    return W->now;
+}
+
+size_t tw_size(tw_t W) {
+    assert(W != NULL);
+    return W->size;
+}
+
+bool tw_pending(struct tw_Timer *T) {
+    assert(T != NULL);
+    return T->pending;
+}
+
+/******************************************************************************/
+/*                                 Modifiers                                  */
+/******************************************************************************/
+
+void tw_schedule(tw_t W, struct tw_Timer *T, uint64_t expires) {
+    assert(W != NULL && T != NULL && T->fire != NULL && !T->pending);
+
+    T->expires = expires;
+    T->pending = true;
+    tw_place(W, T);
+    W->size++;
+}
+
+bool tw_cancel(tw_t W, struct tw_Timer *T) {
+    assert(W != NULL && T != NULL);
+
+    if (!T->pending)
+        return false;
+    tw_unlink(W, T);
+    T->pending = false;
+    W->size--;
+    return true;
+}
+
+void tw_reschedule(tw_t W, struct tw_Timer *T, uint64_t expires) {
+    tw_cancel(W, T);
+    tw_schedule(W, T, expires);
+}
+
+size_t tw_advance(tw_t W, uint64_t now) {
+    assert(W != NULL);
+    size_t fired = 0;
+
+    if (now <= W->now)
+        return 0;
+    assert(now < UINT64_MAX - TW_SPAN);
+
+    while (W->clock <= now) {
+        if (W->size == 0) {
+            W->clock = now + 1;
+            break;
+        }
+
+        uint64_t next = tw_next_tick(W);
+        if (next != W->clock) {
+            W->clock = next <= now ? next : now + 1;
+            continue;
+        }
+
+        /* At the start of each level's period, its current slot moves down */
+        uint64_t t = W->clock;
+        uint32_t index = t & TW_MASK;
+        for (uint32_t level = 1; level < TW_LEVELS && index == 0; level++) {
+            index = (t >> (TW_BITS * level)) & TW_MASK;
+            tw_cascade(W, level * TW_SLOTS + index);
+        }
+
+        /* Timers scheduled for t or earlier by the callbacks go to t + 1 */
+        W->clock++;
+        fired += tw_fire(W, t & TW_MASK);
+    }
+
+    W->now = now;
+    return fired;
+}
@@ -1,20 +1,269 @@
+#define _GNU_SOURCE     /* mremap */
+#ifndef DS_NO_INLINE
+#define DS_NO_INLINE    /* This file defines the out-of-line versions */
+#endif
 #include "ds/uba.h"
+#include "ds/reclaim.h"
 #include <limits.h>
 #include <stddef.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /******************************************************************************/
 /*                                  INTERNAL                                  */
+/******************************************************************************/
+/*                                 Statistics                                 */
+/******************************************************************************/
+
+#ifdef DS_STATS
+/* Shared by every thread using ubas, so atomic (see ll.c) */
+static struct {
+    atomic_size_t allocs;
+    atomic_size_t bytes;
+    atomic_size_t resizes;
+    atomic_size_t bytes_copied;
+} uba_global_stats;
+
+#define UBA_GLOBAL_ADD(field, n) \
+    atomic_fetch_add_explicit(&uba_global_stats.field, (n), memory_order_relaxed)
+#define UBA_GLOBAL_SUB(field, n) \
+    atomic_fetch_sub_explicit(&uba_global_stats.field, (n), memory_order_relaxed)
+#define UBA_GLOBAL_GET(field) \
+    atomic_load_explicit(&uba_global_stats.field, memory_order_relaxed)
+
+#define UBA_STAT_ADD(U, field, n) \
+    ((U)->stats.field += (n), UBA_GLOBAL_ADD(field, n))
+#define UBA_STAT_SUB(U, field, n) \
+    ((U)->stats.field -= (n), UBA_GLOBAL_SUB(field, n))
+#else
+#define UBA_STAT_ADD(U, field, n) ((void)0)
+#define UBA_STAT_SUB(U, field, n) ((void)0)
+#endif
+
+/******************************************************************************/
+/*                                   Pages                                    */
+/******************************************************************************/
+
+/* Paged ubas keep entries in fixed-size pages reached through a page table.
+ * Pages and tables are reference counted so snapshots can share them; the
+ * writer copies a table or page only when it is shared. */
+#define UBA_PAGE_SHIFT 9
+#define UBA_PAGE_ENTRIES ((size_t)1 << UBA_PAGE_SHIFT)
+#define UBA_PAGE_MASK (UBA_PAGE_ENTRIES - 1)
+
+struct uba_Page {
+    atomic_size_t refs;
+    void *slot[UBA_PAGE_ENTRIES];
+};
+
+struct uba_PageTable {
+    atomic_size_t refs;
+    size_t npages;
+    struct uba_Page *page[];
+};
+
+/* Entries removed from a paged uba while snapshots may still return them.
+ * Every snapshot starts an epoch and holds it; the uba holds its newest
+ * epoch and each epoch holds the next newer one. Entries removed during an
+ * epoch are freed when it drops its last reference, which is after every
+ * snapshot taken before their removal is released. */
+struct uba_Epoch {
+    atomic_size_t refs;
+    struct uba_Epoch *next;
+    uba_entry_free_fn *entry_free;
+
+    void **garbage;
+    size_t count;
+    size_t cap;
+};
+
+struct uba_Snapshot {
+    struct uba_PageTable *pages;
+    struct uba_Epoch *epoch;
+    size_t size;
+};
+
+static struct uba_Page *uba_page_new(void) {
+    struct uba_Page *P = calloc(1, sizeof(*P));
+    atomic_init(&P->refs, 1);
+    return P;
+}
+
+static void uba_page_release(struct uba_Page *P) {
+    if (atomic_fetch_sub_explicit(&P->refs, 1, memory_order_acq_rel) == 1)
+        free(P);
+}
+
+static void uba_table_release(struct uba_PageTable *T) {
+    if (atomic_fetch_sub_explicit(&T->refs, 1, memory_order_acq_rel) != 1)
+        return;
+
+    for (size_t i = 0; i < T->npages; i++)
+        uba_page_release(T->page[i]);
+    free(T);
+}
+
+static bool uba_shared(atomic_size_t *refs) {
+    return atomic_load_explicit(refs, memory_order_acquire) > 1;
+}
+
+static struct uba_Epoch *uba_epoch_new(uba_entry_free_fn *entry_free) {
+    struct uba_Epoch *E = calloc(1, sizeof(*E));
+    atomic_init(&E->refs, 1);
+    E->entry_free = entry_free;
+    return E;
+}
+
+/* Drop a reference to E, freeing its entries and passing on to newer epochs
+ * as they become unreferenced. May run on any thread releasing a snapshot. */
+static void uba_epoch_release(struct uba_Epoch *E) {
+    while (E && atomic_fetch_sub_explicit(&E->refs, 1, memory_order_acq_rel) == 1) {
+        struct uba_Epoch *next = E->next;
+
+        for (size_t i = 0; i < E->count; i++)
+            E->entry_free(E->garbage[i]);
+        free(E->garbage);
+        free(E);
+        E = next;
+    }
+}
+
+/* Keep entry until the snapshots of E's epoch and older ones are released */
+static void uba_epoch_defer(struct uba_Epoch *E, void *entry) {
+    if (E->count == E->cap) {
+        E->cap = E->cap ? E->cap * 2 : 16;
+        E->garbage = realloc(E->garbage, sizeof(void *) * E->cap);
+    }
+    E->garbage[E->count++] = entry;
+}
+
+/* Return a private table of npages pages sharing T's first pages */
+static struct uba_PageTable *uba_table_copy(struct uba_PageTable *T,
+                                            size_t npages) {
+    struct uba_PageTable *C = malloc(sizeof(*C)
+                                     + sizeof(struct uba_Page *) * npages);
+    size_t keep = !T ? 0 : T->npages < npages ? T->npages : npages;
+
+    atomic_init(&C->refs, 1);
+    C->npages = npages;
+
+    for (size_t i = 0; i < keep; i++) {
+        C->page[i] = T->page[i];
+        atomic_fetch_add_explicit(&C->page[i]->refs, 1, memory_order_relaxed);
+    }
+    for (size_t i = keep; i < npages; i++)
+        C->page[i] = uba_page_new();
+
+    return C;
+}
+
 /******************************************************************************/
 /*                                  Helpers                                   */
 /******************************************************************************/
 
-static void uba_resize_auto(uba_t U) {
+/* Read slot index of U's storage */
+static inline void *uba_at(uba_t U, size_t index) {
+    if (U->pages)
+        return U->pages->page[index >> UBA_PAGE_SHIFT]
+                   ->slot[index & UBA_PAGE_MASK];
+    return U->data[index];
+}
+
+/* Return a writable slot, first unsharing the page table and page it is in */
+static void **uba_slot(uba_t U, size_t index) {
+    if (!U->pages)
+        return &U->data[index];
+
+    if (uba_shared(&U->pages->refs)) {
+        struct uba_PageTable *T = uba_table_copy(U->pages, U->pages->npages);
+        uba_table_release(U->pages);
+        U->pages = T;
+        UBA_STAT_ADD(U, allocs, 1);
+    }
+
+    struct uba_Page **P = &U->pages->page[index >> UBA_PAGE_SHIFT];
+    if (uba_shared(&(*P)->refs)) {
+        struct uba_Page *C = uba_page_new();
+        memcpy(C->slot, (*P)->slot, sizeof(C->slot));
+        uba_page_release(*P);
+        *P = C;
+        UBA_STAT_ADD(U, allocs, 1);
+        UBA_STAT_ADD(U, bytes_copied, sizeof(C->slot));
+    }
+
+    return &(*P)->slot[index & UBA_PAGE_MASK];
+}
+
+/* Free an entry removed from U, or defer it while a snapshot may see it */
+static void uba_free_entry(uba_t U, void *entry) {
+    if (!U->entry_free || !entry)
+        return;
+
+    if (U->epoch && uba_shared(&U->epoch->refs))
+        uba_epoch_defer(U->epoch, entry);
+    else
+        U->entry_free(entry);
+}
+
+/* Make room after the size was raised by one; on failure the size is put
+ * back and 1 returned */
+static int uba_resize_auto(uba_t U) {
     assert(U != NULL);
 
-    if (uba_size(U) >= uba_limit(U))
-        uba_resize(U, uba_limit(U) * 2);
+    if (uba_size(U) >= uba_limit(U) && uba_resize(U, uba_limit(U) * 2)) {
+        U->size--;
+        return 1;
+    }
+    return 0;
+}
+
+static int uba_madvice(enum uba_advice advice) {
+    switch (advice) {
+        case UBA_ADVICE_SEQUENTIAL:
+            return MADV_SEQUENTIAL;
+        case UBA_ADVICE_RANDOM:
+            return MADV_RANDOM;
+        default:
+            return MADV_NORMAL;
+    }
+}
+
+/* Grow or shrink the backing file and its mapping to new_limit entries.
+ * Return 0, or 1 if the file cannot be resized, leaving U as it was. */
+static int uba_remap(uba_t U, size_t new_limit) {
+    assert(U != NULL && uba_mapped(U));
+
+    size_t old_len = sizeof(void *) * U->limit;
+    size_t new_len = sizeof(void *) * new_limit;
+    void *data;
+
+    /* A shrinking file can be cut first since entries past new_limit are
+     * unused, and shrinking a mapping in place does not fail */
+    if (ftruncate(U->fd, new_len) < 0)
+        return 1;
+
+    data = mremap(U->data, old_len, new_len, MREMAP_MAYMOVE);
+    if (data == MAP_FAILED) {
+        assert(new_len > old_len);
+
+        /* Best effort: a file longer than its mapping is harmless */
+        int rc = ftruncate(U->fd, old_len);
+        (void)rc;
+        return 1;
+    }
+
+    U->data = data;
+    U->limit = new_limit;
+    madvise(U->data, new_len, uba_madvice(U->advice));
+    return 0;
 }
 
 static bool uba_index_valid(uba_t U, size_t index) {
@@ -42,21 +291,286 @@ uba_t uba_new(size_t limit, bool raw, uba_entry_free_fn *entry_free) {
 
     U->entry_free = entry_free;
 
+    U->map = NULL;
+    U->map_len = 0;
+
+    U->fd = -1;
+    U->advice = UBA_ADVICE_NORMAL;
+
+    U->pages = NULL;
+    U->epoch = NULL;
+
+#ifdef DS_STATS
+    U->stats = (struct uba_Stats){0};
+#endif
+    UBA_STAT_ADD(U, allocs, 2);
+    UBA_STAT_ADD(U, bytes, sizeof(*U) + sizeof(void *) * U->limit);
+
     assert(U != NULL);
     return U;
 }
 
+uba_t uba_new_mapped(const char *path,
+                     size_t limit,
+                     bool raw,
+                     uba_entry_free_fn *entry_free) {
+    assert(path != NULL);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return NULL;
+
+    limit = limit <= 0 ? 1 : limit;
+    void *data = MAP_FAILED;
+    if (ftruncate(fd, sizeof(void *) * limit) == 0)
+        data = mmap(NULL, sizeof(void *) * limit, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+
+    if (data == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+
+    struct uba_Header *U = malloc(sizeof(*U));
+
+    U->raw = raw;
+    U->size = 0;
+    U->limit = limit;
+    U->data = data;
+
+    U->entry_free = entry_free;
+
+    U->map = NULL;
+    U->map_len = 0;
+
+    U->fd = fd;
+    U->advice = UBA_ADVICE_NORMAL;
+
+    U->pages = NULL;
+    U->epoch = NULL;
+
+#ifdef DS_STATS
+    U->stats = (struct uba_Stats){0};
+#endif
+    UBA_STAT_ADD(U, allocs, 1);
+    UBA_STAT_ADD(U, bytes, sizeof(*U));
+
+    assert(uba_mapped(U));
+    return U;
+}
+
+uba_t uba_new_paged(size_t limit, bool raw, uba_entry_free_fn *entry_free) {
+    struct uba_Header *U = uba_new(0, raw, entry_free);
+
+    free(U->data);
+    U->data = NULL;
+    UBA_STAT_SUB(U, bytes, sizeof(void *) * U->limit);
+
+    size_t npages = limit <= 0 ? 1 : (limit + UBA_PAGE_MASK) >> UBA_PAGE_SHIFT;
+    U->pages = uba_table_copy(NULL, npages);
+    U->limit = npages * UBA_PAGE_ENTRIES;
+
+    assert(uba_paged(U));
+    return U;
+}
+
 void uba_free(uba_t U) {
     assert(U != NULL);
     if (U->entry_free && !uba_raw(U)) {
-        for (size_t i = 0; i < uba_size(U); i++) {
-            if (U->data[i])
-                U->entry_free(U->data[i]);
+        for (size_t i = 0; i < uba_size(U); i++)
+            uba_free_entry(U, uba_at(U, i));
+    }
+    uba_epoch_release(U->epoch);
+
+#ifdef DS_STATS
+    UBA_GLOBAL_SUB(bytes, U->stats.bytes);
+#endif
+
+    if (U->map)
+        munmap(U->map, U->map_len);
+
+    if (uba_mapped(U)) {
+        munmap(U->data, sizeof(void *) * U->limit);
+        close(U->fd);
+    } else if (uba_paged(U)) {
+        uba_table_release(U->pages);
+    } else {
+        free(U->data);
+    }
+    free(U);
+}
+
+static bool uba_reclaim_step(void *U, size_t budget) {
+    return uba_free_step(U, budget);
+}
+
+void uba_free_async(uba_t U) {
+    assert(U != NULL);
+    reclaim_defer(U, &uba_reclaim_step);
+}
+
+bool uba_free_step(uba_t U, size_t budget) {
+    assert(U != NULL && 0 < budget);
+
+    if (U->entry_free && !uba_raw(U)) {
+        while (budget-- && U->size > 0) {
+            U->size--;
+            uba_free_entry(U, uba_at(U, U->size));
         }
+        if (U->size > 0)
+            return false;
     }
 
-    free(U->data);
-    free(U);
+    uba_free(U);
+    return true;
+}
+
+void uba_swap(uba_t A, uba_t B) {
+    assert(A != NULL && B != NULL);
+
+    /* Per-uba counters travel with the storage they describe */
+    struct uba_Header tmp = *A;
+    *A = *B;
+    *B = tmp;
+}
+
+/******************************************************************************/
+/*                                Persistence                                 */
+/******************************************************************************/
+
+/* File layout: uba_FileHeader followed by one record per entry, in index
+ * order. A record is the payload length and the payload padded to 8 bytes. The
+ * checksum covers the header fields before it and everything after the header.
+ * */
+#define UBA_FILE_MAGIC 0x31414255u  /* "UBA1" */
+#define UBA_FILE_VERSION 2
+
+struct uba_FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t count;
+    uint64_t checksum;
+};
+
+#define UBA_PAD8(n) (((n) + 7) & ~(size_t)7)
+
+/* FNV-1a over 64-bit words; len is always a multiple of 8 */
+static uint64_t uba_checksum(uint64_t h, const void *buf, size_t len) {
+    const unsigned char *p = buf;
+    uint64_t w;
+
+    for (size_t i = 0; i < len; i += 8) {
+        memcpy(&w, p + i, 8);
+        h = (h ^ w) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+/* Checksum of the header fields, where the one over the records starts */
+static uint64_t uba_checksum_header(const struct uba_FileHeader *hdr) {
+    return uba_checksum(0xcbf29ce484222325ull, hdr,
+                        offsetof(struct uba_FileHeader, checksum));
+}
+
+static bool uba_write(FILE *f, uint64_t *h, const void *buf, size_t len) {
+    *h = uba_checksum(*h, buf, len);
+    return fwrite(buf, 1, len, f) == len;
+}
+
+int uba_save(uba_t U, const char *path, uba_entry_serialize_fn *ser) {
+    assert(U != NULL && !uba_raw(U) && path && ser);
+
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        return 1;
+
+    struct uba_FileHeader hdr = {
+        .magic = UBA_FILE_MAGIC,
+        .version = UBA_FILE_VERSION,
+        .count = uba_size(U),
+    };
+    size_t cap = 64, len;
+    unsigned char *buf = malloc(cap);
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+
+    hdr.checksum = uba_checksum_header(&hdr);
+    for (size_t i = 0; ok && i < uba_size(U); i++) {
+        len = ser(uba_at(U, i), buf, cap);
+        if (len > cap) {
+            cap = UBA_PAD8(len);
+            buf = realloc(buf, cap);
+            len = ser(uba_at(U, i), buf, cap);
+        }
+        memset(buf + len, 0, UBA_PAD8(len) - len);
+
+        uint64_t len64 = len;
+        ok = uba_write(f, &hdr.checksum, &len64, sizeof(len64))
+             && uba_write(f, &hdr.checksum, buf, UBA_PAD8(len));
+    }
+
+    ok = ok && fseek(f, 0, SEEK_SET) == 0
+         && fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+
+    free(buf);
+    return fclose(f) == 0 && ok ? 0 : 1;
+}
+
+uba_t uba_load(const char *path,
+               uba_entry_deserialize_fn *deser,
+               uba_entry_free_fn *entry_free) {
+    assert(path && deser);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(struct uba_FileHeader)
+            || (st.st_size - sizeof(struct uba_FileHeader)) % 8) {
+        close(fd);
+        return NULL;
+    }
+
+    /* Private and writable so entries can be modified in place */
+    size_t map_len = st.st_size;
+    char *map = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    struct uba_FileHeader *hdr = (struct uba_FileHeader *)map;
+    char *p = map + sizeof(*hdr), *end = map + map_len;
+
+    if (hdr->magic != UBA_FILE_MAGIC || hdr->version != UBA_FILE_VERSION
+            || hdr->count > (size_t)(end - p) / 8
+            || uba_checksum(uba_checksum_header(hdr), p, end - p) != hdr->checksum) {
+        munmap(map, map_len);
+        return NULL;
+    }
+
+    uba_t U = uba_new(hdr->count + 1, false, entry_free);
+    U->map = map;
+    U->map_len = map_len;
+
+    for (uint64_t i = 0; i < hdr->count; i++) {
+        uint64_t len;
+
+        if ((size_t)(end - p) < sizeof(len)) {
+            uba_free(U);
+            return NULL;
+        }
+        memcpy(&len, p, sizeof(len));
+        p += sizeof(len);
+        if (len > (size_t)(end - p)) {
+            uba_free(U);
+            return NULL;
+        }
+
+        U->data[U->size++] = deser(p, len);
+        p += UBA_PAD8(len);
+    }
+
+    return U;
 }
 
 /******************************************************************************/
@@ -78,64 +592,154 @@ size_t uba_limit(uba_t U) {
     return U->limit;
 }
 
+bool uba_mapped(uba_t U) {
+    assert(U != NULL);
+    return U->fd >= 0;
+}
+
+void uba_advise(uba_t U, enum uba_advice advice) {
+    assert(U != NULL && uba_mapped(U));
+
+    U->advice = advice;
+    madvise(U->data, sizeof(void *) * U->limit, uba_madvice(advice));
+}
+
+int uba_sync(uba_t U) {
+    assert(U != NULL && uba_mapped(U));
+    return msync(U->data, sizeof(void *) * U->limit, MS_SYNC) == 0 ? 0 : 1;
+}
+
+bool uba_paged(uba_t U) {
+    assert(U != NULL);
+    return U->pages != NULL;
+}
+
 bool uba_empty(uba_t U) {
     assert(U != NULL && !uba_raw(U));
     return !uba_size(U);
 }
 
+struct uba_Stats uba_stats(uba_t U) {
+    assert(U != NULL);
+#ifdef DS_STATS
+    return U->stats;
+#else
+    return (struct uba_Stats){0};
+#endif
+}
+
+struct uba_Stats uba_stats_global(void) {
+#ifdef DS_STATS
+    return (struct uba_Stats){
+        .allocs = UBA_GLOBAL_GET(allocs),
+        .bytes = UBA_GLOBAL_GET(bytes),
+        .resizes = UBA_GLOBAL_GET(resizes),
+        .bytes_copied = UBA_GLOBAL_GET(bytes_copied),
+    };
+#else
+    return (struct uba_Stats){0};
+#endif
+}
+
+void uba_stats_dump(FILE *f) {
+    assert(f != NULL);
+    struct uba_Stats s = uba_stats_global();
+
+    fprintf(f, "uba: allocs=%zu bytes=%zu resizes=%zu bytes_copied=%zu\n",
+            s.allocs, s.bytes, s.resizes, s.bytes_copied);
+}
+
 /******************************************************************************/
 /*                             High-Level Access                              */
 /******************************************************************************/
 
-void uba_resize(uba_t U, size_t new_limit) {
+int uba_resize(uba_t U, size_t new_limit) {
     assert(U != NULL && uba_size(U) < new_limit && new_limit <= ULONG_MAX / 2);
 
-    U->limit = new_limit == 0 ? 1 : new_limit;
-    void **arr = malloc(sizeof(void *) * new_limit);
+    new_limit = new_limit == 0 ? 1 : new_limit;
+    UBA_STAT_ADD(U, resizes, 1);
+
+    /* File-backed data is paged by the OS and not counted in bytes */
+    if (uba_mapped(U))
+        return uba_remap(U, new_limit);
+
+    /* Only the page table is rebuilt; pages are carried over, not copied */
+    if (uba_paged(U)) {
+        size_t npages = (new_limit + UBA_PAGE_MASK) >> UBA_PAGE_SHIFT;
+        struct uba_PageTable *T = uba_table_copy(U->pages, npages);
+
+        uba_table_release(U->pages);
+        U->pages = T;
+        U->limit = npages * UBA_PAGE_ENTRIES;
+        UBA_STAT_ADD(U, allocs, 1);
+        return 0;
+    }
+
+    UBA_STAT_ADD(U, allocs, 1);
+    UBA_STAT_ADD(U, bytes_copied, sizeof(void *) * uba_size(U));
+    UBA_STAT_SUB(U, bytes, sizeof(void *) * U->limit);
+
+    U->limit = new_limit;
+    UBA_STAT_ADD(U, bytes, sizeof(void *) * U->limit);
+    void **arr = malloc(sizeof(void *) * U->limit);
     for (size_t i = 0; i < uba_size(U); i++) {
         arr[i] = U->data[i];
     }
 
     free(U->data);
     U->data = arr;
+    return 0;
 }
 
-void uba_push(uba_t U, void *entry) {
+int uba_push(uba_t U, void *entry) {
     assert(U != NULL && !uba_raw(U));
     U->size++;
-    uba_resize_auto(U);
+    if (uba_resize_auto(U))
+        return 1;
 
     uba_set(U, uba_size(U) - 1, entry);
+    return 0;
 }
 
 void uba_pop(uba_t U) {
     assert(U != NULL && !uba_raw(U));
+    uba_free_entry(U, uba_pop_take(U));
+}
+
+void *uba_pop_take(uba_t U) {
+    assert(U != NULL && !uba_raw(U) && uba_size(U) > 0);
     U->size--;
 
-    if (U->entry_free)
-        U->entry_free(U->data[U->size]);
+    void **slot = uba_slot(U, U->size);
+    void *entry = *slot;
+    *slot = NULL;
 
-    U->data[U->size] = NULL;
+    return entry;
 }
 
-void uba_insert(uba_t U, size_t index, void *entry) {
+int uba_insert(uba_t U, size_t index, void *entry) {
     assert(U != NULL && !uba_raw(U) && 0 <= index && index <= uba_size(U));
     U->size++;
-    uba_resize_auto(U);
+    if (uba_resize_auto(U))
+        return 1;
 
     for(size_t i = uba_size(U); i > index; i--) {
         uba_set(U, i, uba_get(U, i - 1));
     }
 
     uba_set(U, index, entry);
+    return 0;
 }
 
 void uba_remove(uba_t U, size_t index) {
     assert(U != NULL && !uba_raw(U) && uba_size(U) > 0
             && 0 <= index && index < uba_size(U));
+    uba_free_entry(U, uba_take(U, index));
+}
 
-    if (U->entry_free)
-        U->entry_free(U->data[index]);
+void *uba_take(uba_t U, size_t index) {
+    assert(U != NULL && !uba_raw(U) && index < uba_size(U));
+    void *entry = uba_at(U, index);
 
     for(size_t i = index; i < uba_size(U) - 1; i++) {
         uba_set(U, i, uba_get(U, i + 1));
@@ -144,20 +748,19 @@ void uba_remove(uba_t U, size_t index) {
     uba_set(U, uba_size(U), NULL);
 
     U->size--;
+    return entry;
 }
 
 void uba_update(uba_t U, size_t index, void *entry) {
     assert(U != NULL && !uba_raw(U) && 0 <= index && index < uba_size(U));
 
-    if (U->entry_free)
-        U->entry_free(U->data[index]);
-
+    uba_free_entry(U, uba_at(U, index));
     uba_set(U, index, entry);
 }
 
-void uba_shrink(uba_t U) {
+int uba_shrink(uba_t U) {
     assert(U != NULL);
-    uba_resize(U, uba_size(U) + 1);
+    return uba_resize(U, uba_size(U) + 1);
 }
 
 /******************************************************************************/
@@ -168,24 +771,80 @@ void *uba_get(uba_t U, size_t index) {
     assert(U != NULL && uba_index_valid(U, index)
             && ((!uba_raw(U) && index < uba_size(U))
               || (uba_raw(U) && index < uba_limit(U))));
-    return U->data[index];
+    return uba_at(U, index);
 }
 
 void uba_set(uba_t U, size_t index, void *entry) {
     assert(U != NULL && uba_index_valid(U, index));
-    U->data[index] = entry;
+    *uba_slot(U, index) = entry;
 }
 
 void uba_del(uba_t U, size_t index) {
     assert(U != NULL && uba_index_valid(U, index));
 
-    if (U->entry_free)
-        U->entry_free(U->data[index]);
-
-    U->data[index] = NULL;
+    uba_free_entry(U, uba_at(U, index));
+    *uba_slot(U, index) = NULL;
 }
 
 void *uba_data(uba_t U) {
-    assert(U != NULL);
+    assert(U != NULL && !uba_paged(U));
     return U->data;
 }
+
+void **uba_steal_buffer(uba_t U, size_t *size) {
+    assert(U != NULL && !uba_mapped(U) && !uba_paged(U) && U->map == NULL);
+    void **data = U->data;
+
+    if (size)
+        *size = uba_raw(U) ? uba_limit(U) : uba_size(U);
+
+#ifdef DS_STATS
+    UBA_GLOBAL_SUB(bytes, U->stats.bytes);
+#endif
+
+    free(U);
+    return data;
+}
+
+/******************************************************************************/
+/*                                 Snapshots                                  */
+/******************************************************************************/
+
+uba_snap_t uba_snapshot(uba_t U) {
+    assert(U != NULL && !uba_raw(U) && uba_paged(U));
+    struct uba_Snapshot *S = malloc(sizeof(*S));
+
+    atomic_fetch_add_explicit(&U->pages->refs, 1, memory_order_relaxed);
+    S->pages = U->pages;
+    S->size = uba_size(U);
+
+    /* Start a new epoch held by S and U; the previous one holds it too */
+    struct uba_Epoch *E = uba_epoch_new(U->entry_free);
+    atomic_fetch_add_explicit(&E->refs, 1, memory_order_relaxed);
+    if (U->epoch) {
+        atomic_fetch_add_explicit(&E->refs, 1, memory_order_relaxed);
+        U->epoch->next = E;
+        uba_epoch_release(U->epoch);
+    }
+    U->epoch = E;
+    S->epoch = E;
+
+    return S;
+}
+
+size_t uba_snap_size(uba_snap_t S) {
+    assert(S != NULL);
+    return S->size;
+}
+
+void *uba_snap_get(uba_snap_t S, size_t index) {
+    assert(S != NULL && index < S->size);
+    return S->pages->page[index >> UBA_PAGE_SHIFT]->slot[index & UBA_PAGE_MASK];
+}
+
+void uba_snap_release(uba_snap_t S) {
+    assert(S != NULL);
+    uba_table_release(S->pages);
+    uba_epoch_release(S->epoch);
+    free(S);
+}
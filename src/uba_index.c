@@ -0,0 +1,156 @@
+#include "ds/uba_index.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+
+/* Nodes four levels below k start at 16k, one cache line of them when node
+ * is 64-byte aligned */
+#define UBA_INDEX_AHEAD 16
+
+/******************************************************************************/
+/*                                  Helpers                                   */
+/******************************************************************************/
+
+/* Return the uba index of node k, or size for k == 0 (no entry above the key).
+ * In a perfect tree of depth levels, node k at level l is the in-order
+ * position p below; the m nodes of the partial last level sit at the even
+ * positions up to 2(m - 1), so each missing one before p shifts it down. */
+static size_t uba_index_to_rank(uba_index_t I, size_t k) {
+    if (k == 0)
+        return I->size;
+
+    unsigned level = 63 - __builtin_clzll(k);
+    size_t p = ((2 * (k - ((size_t)1 << level)) + 1) << (I->depth - 1 - level)) - 1;
+    size_t m = I->size - (((size_t)1 << (I->depth - 1)) - 1);
+
+    return p > 2 * m ? p - (p - 2 * m + 1) / 2 : p;
+}
+
+/* Undo the trailing right turns of a search that left the tree at k, giving
+ * the last node it went left at: the first one not below the key */
+static inline size_t uba_index_exit(size_t k) {
+    return k >> __builtin_ffsll(~k);
+}
+
+static inline size_t uba_index_step(uba_index_t I, size_t k, void *key) {
+    void *e = I->node[k];
+
+    __builtin_prefetch(I->node + UBA_INDEX_AHEAD * k);
+    if (I->cmp)
+        return 2 * k + (I->cmp(e, key) < 0);
+    return 2 * k + ((uintptr_t)e < (uintptr_t)key);
+}
+
+/* The last step, which only searches whose level depth - 1 node exists take.
+ * The others compare against node 1 and keep k. */
+static inline size_t uba_index_last_step(uba_index_t I, size_t k, void *key) {
+    bool inside = k <= I->size;
+    size_t next = uba_index_step(I, inside ? k : 1, key);
+
+    return inside ? next : k;
+}
+
+/* Return the node of the first entry not below key, 0 if there is none */
+static size_t uba_index_search(uba_index_t I, void *key) {
+    size_t k = 1;
+
+    if (I->size == 0)
+        return 0;
+
+    for (unsigned d = 1; d < I->depth; d++)
+        k = uba_index_step(I, k, key);
+    k = uba_index_last_step(I, k, key);
+
+    return uba_index_exit(k);
+}
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+/*                             Init and Teardown                              */
+/******************************************************************************/
+
+uba_index_t uba_build_index(uba_t U, uba_cmp_fn *cmp) {
+    assert(U != NULL && !uba_raw(U) && !uba_paged(U));
+    struct uba_Index *I = malloc(sizeof(*I));
+    size_t n = uba_size(U);
+    void **data = uba_data(U);
+
+    /* Round up for aligned_alloc, which wants a multiple of the alignment */
+    size_t bytes = ((n + 1) * sizeof(void *) + 63) & ~(size_t)63;
+    if (!I || !(I->node = aligned_alloc(64, bytes)))
+        abort();
+
+    I->size = n;
+    I->cmp = cmp;
+    I->depth = n ? 64 - __builtin_clzll(n) : 0;
+    I->node[0] = NULL;
+    for (size_t k = 1; k <= n; k++)
+        I->node[k] = data[uba_index_to_rank(I, k)];
+
+    return I;
+}
+
+void uba_index_free(uba_index_t I) {
+    assert(I != NULL);
+
+    free(I->node);
+    free(I);
+}
+
+/******************************************************************************/
+/*                                  Queries                                   */
+/******************************************************************************/
+
+size_t uba_index_size(uba_index_t I) {
+    assert(I != NULL);
+    return I->size;
+}
+
+size_t uba_index_rank(uba_index_t I, void *key) {
+    assert(I != NULL);
+    return uba_index_to_rank(I, uba_index_search(I, key));
+}
+
+void *uba_index_find(uba_index_t I, void *key) {
+    assert(I != NULL);
+    size_t k = uba_index_search(I, key);
+
+    if (k == 0)
+        return NULL;
+    if (I->cmp ? I->cmp(I->node[k], key) != 0 : I->node[k] != key)
+        return NULL;
+    return I->node[k];
+}
+
+void uba_index_rank_n(uba_index_t I, void **keys, size_t *ranks, size_t n) {
+    assert(I != NULL && (n == 0 || (keys != NULL && ranks != NULL)));
+    size_t k[UBA_INDEX_BATCH];
+
+    for (size_t base = 0; base < n; base += UBA_INDEX_BATCH) {
+        size_t batch = n - base < UBA_INDEX_BATCH ? n - base : UBA_INDEX_BATCH;
+        void **key = keys + base;
+
+        if (I->size == 0) {
+            for (size_t j = 0; j < batch; j++)
+                ranks[base + j] = 0;
+            continue;
+        }
+
+        for (size_t j = 0; j < batch; j++)
+            k[j] = 1;
+        for (unsigned d = 1; d < I->depth; d++) {
+            for (size_t j = 0; j < batch; j++)
+                k[j] = uba_index_step(I, k[j], key[j]);
+        }
+        for (size_t j = 0; j < batch; j++) {
+            k[j] = uba_index_last_step(I, k[j], key[j]);
+            ranks[base + j] = uba_index_to_rank(I, uba_index_exit(k[j]));
+        }
+    }
+}
@@ -0,0 +1,206 @@
+#include "ds/uba_par.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+
+/* Cache line size assumed when keeping per-chunk state apart */
+#define UBA_PAR_LINE 64
+
+/* Shared state of one parallel call; chunk callbacks get a pointer to it */
+struct uba_ParJob {
+    void **src;
+    void **dst;
+    union {
+        uba_visit_fn *visit;
+        uba_map_fn *map;
+        uba_fold_fn *fold;
+        uba_pred_fn *pred;
+    } fn;
+    void *context;
+
+    /* reduce: the identity followed by one accumulator per chunk, each
+     * stride bytes apart so chunks on different workers do not share a line */
+    unsigned char *partial;
+    size_t acc_size;
+    size_t stride;
+
+    /* filter: kept flag per entry, kept count then output offset per chunk */
+    bool *keep;
+    size_t *offset;
+};
+
+/******************************************************************************/
+/*                                  Helpers                                   */
+/******************************************************************************/
+
+static pool_t uba_par_pool(pool_t P) {
+    return P ? P : pool_default();
+}
+
+/* Number of entries the algorithms cover */
+static size_t uba_par_count(uba_t U) {
+    assert(U != NULL && !uba_paged(U));
+    return uba_raw(U) ? uba_limit(U) : uba_size(U);
+}
+
+static void uba_foreach_chunk(void *context, size_t begin, size_t end, size_t chunk) {
+    struct uba_ParJob *J = context;
+    (void)chunk;
+
+    for (size_t i = begin; i < end; i++)
+        J->fn.visit(J->src[i], i, J->context);
+}
+
+static void uba_map_chunk(void *context, size_t begin, size_t end, size_t chunk) {
+    struct uba_ParJob *J = context;
+    (void)chunk;
+
+    for (size_t i = begin; i < end; i++)
+        J->dst[i] = J->fn.map(J->src[i], J->context);
+}
+
+static void uba_reduce_chunk(void *context, size_t begin, size_t end, size_t chunk) {
+    struct uba_ParJob *J = context;
+    void *acc = J->partial + (chunk + 1) * J->stride;
+
+    /* Slot 0 of partial holds the identity */
+    memcpy(acc, J->partial, J->acc_size);
+    for (size_t i = begin; i < end; i++)
+        J->fn.fold(acc, J->src[i], J->context);
+}
+
+static void uba_filter_mark(void *context, size_t begin, size_t end, size_t chunk) {
+    struct uba_ParJob *J = context;
+    size_t kept = 0;
+
+    for (size_t i = begin; i < end; i++) {
+        J->keep[i] = J->fn.pred(J->src[i], J->context);
+        kept += J->keep[i];
+    }
+    J->offset[chunk] = kept;
+}
+
+static void uba_filter_copy(void *context, size_t begin, size_t end, size_t chunk) {
+    struct uba_ParJob *J = context;
+    void **out = J->dst + J->offset[chunk];
+
+    for (size_t i = begin; i < end; i++) {
+        if (J->keep[i])
+            *out++ = J->src[i];
+    }
+}
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+
+void uba_foreach_parallel(pool_t P, uba_t U, uba_visit_fn *fn, void *context) {
+    assert(U != NULL && fn != NULL);
+    size_t n = uba_par_count(U);
+    struct uba_ParJob J = { .src = uba_data(U), .fn.visit = fn, .context = context };
+
+    P = uba_par_pool(P);
+    pool_for(P, n, pool_grain(P, n), &uba_foreach_chunk, &J);
+}
+
+void uba_map_parallel(pool_t P, uba_t U, uba_map_fn *fn, void *context) {
+    assert(U != NULL && fn != NULL);
+    size_t n = uba_par_count(U);
+    struct uba_ParJob J = {
+        .src = uba_data(U), .dst = uba_data(U), .fn.map = fn, .context = context
+    };
+
+    P = uba_par_pool(P);
+    pool_for(P, n, pool_grain(P, n), &uba_map_chunk, &J);
+}
+
+uba_t uba_map_new_parallel(pool_t P,
+                           uba_t U,
+                           uba_map_fn *fn,
+                           void *context,
+                           uba_entry_free_fn *entry_free) {
+    assert(U != NULL && fn != NULL);
+    size_t n = uba_par_count(U);
+    uba_t R = uba_new(n + 1, false, entry_free);
+    struct uba_ParJob J = {
+        .src = uba_data(U), .dst = uba_data(R), .fn.map = fn, .context = context
+    };
+
+    P = uba_par_pool(P);
+    pool_for(P, n, pool_grain(P, n), &uba_map_chunk, &J);
+    R->size = n;
+
+    return R;
+}
+
+void uba_reduce_parallel(pool_t P,
+                         uba_t U,
+                         void *acc,
+                         size_t acc_size,
+                         uba_fold_fn *fold,
+                         uba_combine_fn *combine,
+                         void *context) {
+    assert(U != NULL && acc != NULL && 0 < acc_size
+            && fold != NULL && combine != NULL);
+    size_t n = uba_par_count(U);
+    P = uba_par_pool(P);
+    size_t grain = pool_grain(P, n);
+    size_t nchunks = (n + grain - 1) / grain;
+    size_t stride = (acc_size + UBA_PAR_LINE - 1) / UBA_PAR_LINE * UBA_PAR_LINE;
+    struct uba_ParJob J = {
+        .src = uba_data(U), .fn.fold = fold, .context = context,
+        .partial = aligned_alloc(UBA_PAR_LINE, (nchunks + 1) * stride),
+        .acc_size = acc_size, .stride = stride
+    };
+
+    memcpy(J.partial, acc, acc_size);
+    pool_for(P, n, grain, &uba_reduce_chunk, &J);
+
+    for (size_t c = 0; c < nchunks; c++)
+        combine(acc, J.partial + (c + 1) * stride, context);
+
+    free(J.partial);
+}
+
+uba_t uba_filter_parallel(pool_t P,
+                          uba_t U,
+                          uba_pred_fn *pred,
+                          void *context,
+                          uba_entry_free_fn *entry_free) {
+    assert(U != NULL && pred != NULL);
+    size_t n = uba_par_count(U);
+    P = uba_par_pool(P);
+    size_t grain = pool_grain(P, n);
+    size_t nchunks = (n + grain - 1) / grain;
+    struct uba_ParJob J = {
+        .src = uba_data(U), .fn.pred = pred, .context = context,
+        .offset = malloc((nchunks + 1) * sizeof(size_t)),
+        .keep = malloc(n + 1)
+    };
+
+    /* Mark kept entries and count them per chunk, turn the counts into output
+     * offsets, then let every chunk copy its entries into place */
+    pool_for(P, n, grain, &uba_filter_mark, &J);
+
+    size_t total = 0;
+    for (size_t c = 0; c < nchunks; c++) {
+        size_t kept = J.offset[c];
+        J.offset[c] = total;
+        total += kept;
+    }
+
+    uba_t R = uba_new(total + 1, false, entry_free);
+    J.dst = uba_data(R);
+    pool_for(P, n, grain, &uba_filter_copy, &J);
+    R->size = total;
+
+    free(J.offset);
+    free(J.keep);
+    return R;
+}
@@ -0,0 +1,273 @@
+#include "ds/uba_set.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define UBA_SET_AVX2
+#endif
+
+/******************************************************************************/
+/*                                  INTERNAL                                  */
+/******************************************************************************/
+/*                                  Helpers                                   */
+/******************************************************************************/
+
+/* cmp, or the entries compared as unsigned integers when cmp is NULL */
+static inline int uba_set_cmp(uba_cmp_fn *cmp, void *e1, void *e2) {
+    if (cmp)
+        return cmp(e1, e2);
+    return (uintptr_t)e1 < (uintptr_t)e2 ? -1 : (uintptr_t)e1 > (uintptr_t)e2;
+}
+
+static bool uba_set_skewed(size_t na, size_t nb) {
+    return na / UBA_SET_GALLOP >= nb || nb / UBA_SET_GALLOP >= na;
+}
+
+/* Return the first index in [lo, n) whose entry is not below key (above key
+ * if upper), probing lo + 1, lo + 3, lo + 7, ... before a binary search, so
+ * the cost is logarithmic in the distance skipped rather than in n */
+static size_t uba_gallop(void **e, size_t lo, size_t n, void *key,
+                         uba_cmp_fn *cmp, bool upper) {
+    size_t hi = lo, step = 1;
+
+#define UBA_SET_BEFORE(x) \
+    (upper ? uba_set_cmp(cmp, (x), key) <= 0 : uba_set_cmp(cmp, (x), key) < 0)
+
+    while (hi < n && UBA_SET_BEFORE(e[hi])) {
+        lo = hi + 1;
+        hi += step;
+        step <<= 1;
+    }
+    hi = hi < n ? hi : n;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (UBA_SET_BEFORE(e[mid]))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+#undef UBA_SET_BEFORE
+    return lo;
+}
+
+/* Make room for up to most more entries in R and return where they go */
+static void **uba_set_out(uba_t R, size_t most) {
+    if (uba_size(R) + most >= uba_limit(R))
+        uba_resize(R, uba_size(R) + most + 1);
+    return (void **)uba_data(R) + uba_size(R);
+}
+
+static void uba_set_done(uba_t R, void **end) {
+    R->size = end - (void **)uba_data(R);
+}
+
+static void **uba_set_copy(void **out, void **e, size_t n) {
+    memcpy(out, e, n * sizeof(void *));
+    return out + n;
+}
+
+static void uba_set_check(uba_t R, uba_t A, uba_t B) {
+    assert(A != NULL && B != NULL && R != NULL && R != A && R != B);
+    assert(!uba_raw(A) && !uba_raw(B) && !uba_raw(R));
+    assert(!uba_paged(A) && !uba_paged(B) && !uba_paged(R));
+    (void)R, (void)A, (void)B;
+}
+
+/******************************************************************************/
+/*                                    SIMD                                    */
+/******************************************************************************/
+
+#ifdef UBA_SET_AVX2
+/* Intersect 4x4 blocks of integer entries: every entry of a's block is
+ * compared with every rotation of b's block, then the block with the smaller
+ * last entry (or both) moves on. Stops when either side has fewer than four
+ * entries left and leaves the positions in *i and *j. */
+__attribute__((target("avx2")))
+static void **uba_intersect_avx2(void **a, size_t na, size_t *i,
+                                 void **b, size_t nb, size_t *j,
+                                 void **out) {
+    size_t x = *i, y = *j;
+
+    while (x + 4 <= na && y + 4 <= nb) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + x));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + y));
+
+        __m256i eq = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi64(va, vb),
+                            _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x39))),
+            _mm256_or_si256(_mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x4e)),
+                            _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x93))));
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+
+        for (int k = 0; k < 4; k++) {
+            if (mask & (1 << k))
+                *out++ = a[x + k];
+        }
+
+        uintptr_t amax = (uintptr_t)a[x + 3], bmax = (uintptr_t)b[y + 3];
+        x += amax <= bmax ? 4 : 0;
+        y += bmax <= amax ? 4 : 0;
+    }
+
+    *i = x;
+    *j = y;
+    return out;
+}
+#endif
+
+/******************************************************************************/
+/*                                  EXTERNAL                                  */
+/******************************************************************************/
+
+void uba_merge(uba_t R, uba_t A, uba_t B, uba_cmp_fn *cmp) {
+    uba_set_check(R, A, B);
+    size_t na = uba_size(A), nb = uba_size(B), i = 0, j = 0, k;
+    void **a = uba_data(A), **b = uba_data(B);
+    void **out = uba_set_out(R, na + nb);
+
+    if (uba_set_skewed(na, nb) && na < nb) {
+        /* Entries of B below each entry of A go first */
+        for (; i < na; i++, j = k) {
+            k = uba_gallop(b, j, nb, a[i], cmp, false);
+            out = uba_set_copy(out, b + j, k - j);
+            *out++ = a[i];
+        }
+    } else if (uba_set_skewed(na, nb)) {
+        /* Entries of A up to each entry of B go first */
+        for (; j < nb; j++, i = k) {
+            k = uba_gallop(a, i, na, b[j], cmp, true);
+            out = uba_set_copy(out, a + i, k - i);
+            *out++ = b[j];
+        }
+    } else {
+        while (i < na && j < nb) {
+            if (uba_set_cmp(cmp, b[j], a[i]) < 0)
+                *out++ = b[j++];
+            else
+                *out++ = a[i++];
+        }
+    }
+
+    out = uba_set_copy(out, a + i, na - i);
+    out = uba_set_copy(out, b + j, nb - j);
+    uba_set_done(R, out);
+}
+
+void uba_union(uba_t R, uba_t A, uba_t B, uba_cmp_fn *cmp) {
+    uba_set_check(R, A, B);
+    size_t na = uba_size(A), nb = uba_size(B), i = 0, j = 0, k;
+    void **a = uba_data(A), **b = uba_data(B);
+    void **out = uba_set_out(R, na + nb);
+    int c;
+
+    if (uba_set_skewed(na, nb) && na < nb) {
+        for (; i < na; i++) {
+            k = uba_gallop(b, j, nb, a[i], cmp, false);
+            out = uba_set_copy(out, b + j, k - j);
+            *out++ = a[i];
+            j = k + (k < nb && uba_set_cmp(cmp, b[k], a[i]) == 0);
+        }
+    } else if (uba_set_skewed(na, nb)) {
+        /* An entry of A equal to b[j] is copied with the next run of A */
+        for (; j < nb; j++) {
+            k = uba_gallop(a, i, na, b[j], cmp, false);
+            out = uba_set_copy(out, a + i, k - i);
+            i = k;
+            if (k == na || uba_set_cmp(cmp, a[k], b[j]) != 0)
+                *out++ = b[j];
+        }
+    } else {
+        while (i < na && j < nb) {
+            c = uba_set_cmp(cmp, a[i], b[j]);
+            if (c <= 0) {
+                *out++ = a[i++];
+                j += c == 0;
+            } else {
+                *out++ = b[j++];
+            }
+        }
+    }
+
+    out = uba_set_copy(out, a + i, na - i);
+    out = uba_set_copy(out, b + j, nb - j);
+    uba_set_done(R, out);
+}
+
+void uba_intersect(uba_t R, uba_t A, uba_t B, uba_cmp_fn *cmp) {
+    uba_set_check(R, A, B);
+    size_t na = uba_size(A), nb = uba_size(B), i = 0, j = 0;
+    void **a = uba_data(A), **b = uba_data(B);
+    void **out = uba_set_out(R, na < nb ? na : nb);
+    int c;
+
+    if (uba_set_skewed(na, nb) && na < nb) {
+        for (; i < na && j < nb; i++) {
+            j = uba_gallop(b, j, nb, a[i], cmp, false);
+            if (j < nb && uba_set_cmp(cmp, b[j], a[i]) == 0) {
+                *out++ = a[i];
+                j++;
+            }
+        }
+    } else if (uba_set_skewed(na, nb)) {
+        for (; j < nb && i < na; j++) {
+            i = uba_gallop(a, i, na, b[j], cmp, false);
+            if (i < na && uba_set_cmp(cmp, a[i], b[j]) == 0)
+                *out++ = a[i++];
+        }
+    } else {
+#ifdef UBA_SET_AVX2
+        if (!cmp && sizeof(void *) == 8 && __builtin_cpu_supports("avx2"))
+            out = uba_intersect_avx2(a, na, &i, b, nb, &j, out);
+#endif
+        while (i < na && j < nb) {
+            c = uba_set_cmp(cmp, a[i], b[j]);
+            if (c == 0)
+                *out++ = a[i];
+            i += c <= 0;
+            j += c >= 0;
+        }
+    }
+
+    uba_set_done(R, out);
+}
+
+void uba_difference(uba_t R, uba_t A, uba_t B, uba_cmp_fn *cmp) {
+    uba_set_check(R, A, B);
+    size_t na = uba_size(A), nb = uba_size(B), i = 0, j = 0, k;
+    void **a = uba_data(A), **b = uba_data(B);
+    void **out = uba_set_out(R, na);
+    int c;
+
+    if (uba_set_skewed(na, nb) && na < nb) {
+        for (; i < na; i++) {
+            j = uba_gallop(b, j, nb, a[i], cmp, false);
+            if (j < nb && uba_set_cmp(cmp, b[j], a[i]) == 0)
+                j++;
+            else
+                *out++ = a[i];
+        }
+    } else if (uba_set_skewed(na, nb)) {
+        for (; j < nb && i < na; j++) {
+            k = uba_gallop(a, i, na, b[j], cmp, false);
+            out = uba_set_copy(out, a + i, k - i);
+            i = k + (k < na && uba_set_cmp(cmp, a[k], b[j]) == 0);
+        }
+    } else {
+        while (i < na && j < nb) {
+            c = uba_set_cmp(cmp, a[i], b[j]);
+            if (c < 0)
+                *out++ = a[i];
+            i += c <= 0;
+            j += c >= 0;
+        }
+    }
+
+    out = uba_set_copy(out, a + i, na - i);
+    uba_set_done(R, out);
+}
@@ -0,0 +1,188 @@
+#include "ds/bpt.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define KEYS 5000
+
+struct entry {
+    int key;
+    int val;
+};
+
+void *entry_new(int k, int v) {
+    struct entry *tmp = malloc(sizeof(*tmp));
+    tmp->key = k;
+    tmp->val = v;
+
+    return tmp;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return *(int*)k1 < *(int*)k2 ? -1 : *(int*)k1 > *(int*)k2;
+}
+
+void *entry_key(void *entry) {
+    return &((struct entry*)entry)->key;
+}
+
+void entry_free(void *entry) {
+    free(entry);
+}
+
+/* Check T against the reference set through full scans in both directions */
+void check(bpt_t T, bool *present) {
+    struct bpt_Cursor C;
+    struct entry *e;
+    size_t count = 0;
+    int prev = -1;
+
+    bpt_range(T, &C, NULL, NULL, false);
+    while ((e = bpt_next(&C))) {
+        assert(e->key > prev && present[e->key]);
+        prev = e->key;
+        count++;
+    }
+    assert(count == bpt_size(T));
+
+    prev = KEYS;
+    bpt_range(T, &C, NULL, NULL, true);
+    while ((e = bpt_next(&C))) {
+        assert(e->key < prev);
+        prev = e->key;
+        count--;
+    }
+    assert(count == 0);
+
+    for (int k = 0; k < KEYS; k++) {
+        e = bpt_get(T, &k);
+        assert(present[k] ? e && e->key == k : e == NULL);
+    }
+}
+
+void random_test() {
+    bpt_t T = bpt_new(&key_cmp, &entry_key, &entry_free);
+    bool present[KEYS] = {0};
+    assert(bpt_empty(T));
+    check(T, present);
+
+    srand(2);
+    for (int round = 0; round < 4; round++) {
+        /* Grow */
+        for (int i = 0; i < 2 * KEYS; i++) {
+            int k = rand() % KEYS;
+            struct entry *e = entry_new(k, i);
+
+            if (bpt_insert(T, e) == 0) {
+                assert(!present[k]);
+                present[k] = true;
+            } else {
+                assert(present[k]);
+                free(e);
+            }
+        }
+        check(T, present);
+
+        /* Shrink */
+        for (int i = 0; i < 2 * KEYS; i++) {
+            int k = rand() % KEYS;
+            assert(bpt_del(T, &k) == !present[k]);
+            present[k] = false;
+        }
+        check(T, present);
+    }
+
+    for (int k = 0; k < KEYS; k++) {
+        if (present[k])
+            assert(bpt_del(T, &k) == 0);
+    }
+    assert(bpt_empty(T));
+    assert(T->height == 1);
+
+    bpt_free(T);
+}
+
+void range_test() {
+    bpt_t T = bpt_new(&key_cmp, &entry_key, &entry_free);
+
+    /* Even keys only */
+    for (int k = 0; k < 1000; k += 2)
+        bpt_insert(T, entry_new(k, k));
+
+    struct bpt_Cursor C;
+    struct entry *e;
+    int lo = 101, hi = 300, expect = 102;
+
+    bpt_range(T, &C, &lo, &hi, false);
+    while ((e = bpt_next(&C))) {
+        assert(e->key == expect);
+        expect += 2;
+    }
+    assert(expect == 302);
+
+    expect = 300;
+    bpt_range(T, &C, &lo, &hi, true);
+    while ((e = bpt_next(&C))) {
+        assert(e->key == expect);
+        expect -= 2;
+    }
+    assert(expect == 100);
+
+    lo = 2000;
+    bpt_range(T, &C, &lo, NULL, false);
+    assert(bpt_next(&C) == NULL);
+    hi = -5;
+    bpt_range(T, &C, NULL, &hi, true);
+    assert(bpt_next(&C) == NULL);
+
+    int k = 500;
+    struct entry *old = bpt_update(T, &k, entry_new(500, 7), false);
+    assert(old && old->val == 500);
+    free(old);
+    assert(((struct entry *)bpt_get(T, &k))->val == 7);
+    k = 501;
+    struct entry missing = { 501, 0 };
+    assert(bpt_update(T, &k, &missing, true) == NULL);
+
+    bpt_free(T);
+}
+
+void bulk_load_test() {
+    for (int n = 0; n < 3000; n = n * 3 + 1) {
+        uba_t U = uba_new(n, false, NULL);
+        bool present[KEYS] = {0};
+
+        for (int k = 0; k < n; k++) {
+            uba_push(U, entry_new(k, k));
+            present[k] = true;
+        }
+
+        bpt_t T = bpt_from_uba(U, &key_cmp, &entry_key, &entry_free);
+        uba_free(U);
+        assert(bpt_size(T) == (size_t)n);
+        check(T, present);
+
+        /* The loaded tree must stay valid under mutation */
+        for (int k = 0; k < n; k += 3) {
+            assert(bpt_del(T, &k) == 0);
+            present[k] = false;
+        }
+        for (int k = n; k < n + 100; k++) {
+            assert(bpt_insert(T, entry_new(k, k)) == 0);
+            present[k] = true;
+        }
+        check(T, present);
+
+        bpt_free(T);
+    }
+}
+
+int main() {
+    puts("random test");
+    random_test();
+    puts("range test");
+    range_test();
+    puts("bulk load test");
+    bulk_load_test();
+    return 0;
+}
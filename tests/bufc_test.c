@@ -0,0 +1,174 @@
+#include "ds/bufc.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+int released;
+
+void counting_release(void *data) {
+    released++;
+    free(data);
+}
+
+char *dup_str(const char *s) {
+    char *tmp = malloc(strlen(s));
+    memcpy(tmp, s, strlen(s));
+    return tmp;
+}
+
+void append(bufc_t B, const char *s) {
+    bufc_append(B, dup_str(s), strlen(s), &counting_release);
+}
+
+/* Assert that B holds exactly the bytes of s */
+void check(bufc_t B, const char *s) {
+    char buf[256];
+    size_t len = strlen(s);
+
+    assert(bufc_len(B) == len);
+    assert(bufc_peek(B, 0, buf, sizeof(buf)) == len);
+    assert(memcmp(buf, s, len) == 0);
+}
+
+void build_test() {
+    released = 0;
+    bufc_t B = bufc_new();
+    assert(bufc_len(B) == 0 && bufc_views(B) == 0);
+
+    append(B, "world");
+    bufc_prepend(B, dup_str("hello "), 6, &counting_release);
+    bufc_append(B, "!", 1, NULL);
+    check(B, "hello world!");
+    assert(bufc_views(B) == 3);
+
+    /* Small copies share one segment */
+    bufc_t H = bufc_new();
+    bufc_append_copy(H, "GET ", 4);
+    bufc_append_copy(H, "/ ", 2);
+    bufc_append_copy(H, "HTTP/1.1", 8);
+    check(H, "GET / HTTP/1.1");
+    assert(bufc_views(H) == 1);
+
+    bufc_concat(H, B);
+    assert(bufc_len(B) == 0 && bufc_views(B) == 0);
+    check(H, "GET / HTTP/1.1hello world!");
+    assert(bufc_views(H) == 4);
+
+    char part[5];
+    assert(bufc_peek(H, 12, part, 5) == 5 && memcmp(part, ".1hel", 5) == 0);
+    assert(bufc_peek(H, 24, part, 5) == 2);
+
+    struct iovec iov[8];
+    assert(bufc_iovec(H, iov, 8) == 4);
+    assert(bufc_iovec(H, iov, 2) == 2);
+    assert(iov[1].iov_len == 6 && memcmp(iov[1].iov_base, "hello ", 6) == 0);
+
+    bufc_free(B);
+    bufc_free(H);
+    assert(released == 2);
+}
+
+void split_test() {
+    released = 0;
+    bufc_t B = bufc_new();
+    append(B, "abc");
+    append(B, "defg");
+    append(B, "hij");
+
+    /* Splitting inside a view shares its segment */
+    bufc_t A = bufc_split(B, 5);
+    check(A, "abcde");
+    check(B, "fghij");
+    assert(bufc_views(A) == 2 && bufc_views(B) == 2);
+
+    bufc_t S = bufc_slice(B, 1, 3);
+    check(S, "ghi");
+    check(B, "fghij");
+
+    bufc_free(A);
+    assert(released == 1);
+    bufc_free(B);
+    assert(released == 1);
+    bufc_free(S);
+    assert(released == 3);
+
+    /* A shared segment takes no copies into its slack */
+    B = bufc_new();
+    bufc_append_copy(B, "xy", 2);
+    S = bufc_slice(B, 0, 2);
+    bufc_append_copy(B, "z", 1);
+    assert(bufc_views(B) == 2);
+    check(B, "xyz");
+    check(S, "xy");
+    bufc_free(B);
+    bufc_free(S);
+
+    B = bufc_new();
+    append(B, "abc");
+    A = bufc_split(B, 3);
+    assert(bufc_len(B) == 0 && bufc_views(A) == 1);
+    bufc_free(A);
+    A = bufc_split(B, 0);
+    assert(bufc_len(A) == 0);
+    bufc_free(A);
+    bufc_free(B);
+}
+
+void consume_test() {
+    released = 0;
+    bufc_t B = bufc_new();
+    append(B, "abc");
+    append(B, "defg");
+    append(B, "hij");
+
+    bufc_consume(B, 2);
+    check(B, "cdefghij");
+    assert(released == 0);
+    bufc_consume(B, 5);
+    check(B, "hij");
+    assert(released == 2 && bufc_views(B) == 1);
+    bufc_consume(B, 3);
+    assert(bufc_len(B) == 0 && released == 3);
+
+    bufc_free(B);
+}
+
+void io_test() {
+    int fds[2];
+    assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    bufc_t out = bufc_new();
+    bufc_append_copy(out, "head:", 5);
+    append(out, "body");
+    bufc_append(out, ";tail", 5, NULL);
+
+    while (bufc_len(out) > 0)
+        assert(bufc_writev(out, fds[0]) > 0);
+    assert(bufc_views(out) == 0);
+
+    /* The first read leaves slack behind for the second */
+    bufc_t in = bufc_new();
+    assert(bufc_readv(in, fds[1], 4) == 4);
+    assert(bufc_readv(in, fds[1], 100) == 10);
+    check(in, "head:body;tail");
+    assert(bufc_views(in) == 1);
+
+    close(fds[0]);
+    assert(bufc_readv(in, fds[1], 100) == 0);
+    close(fds[1]);
+
+    bufc_free(out);
+    bufc_free(in);
+}
+
+int main() {
+    build_test();
+    split_test();
+    consume_test();
+    io_test();
+
+    return 0;
+}
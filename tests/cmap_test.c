@@ -0,0 +1,169 @@
+#include "ds/cmap.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define KEYS 20000
+#define THREADS 8
+
+struct entry {
+    int key;
+    int val;
+};
+
+void *entry_new(int k, int v) {
+    struct entry *tmp = malloc(sizeof(*tmp));
+    tmp->key = k;
+    tmp->val = v;
+
+    return tmp;
+}
+
+uint64_t key_hash(void *key) {
+    return *(int *)key;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return *(int *)k1 < *(int *)k2 ? -1 : *(int *)k1 > *(int *)k2;
+}
+
+void *entry_key(void *entry) {
+    return &((struct entry *)entry)->key;
+}
+
+void entry_free(void *entry) {
+    free(entry);
+}
+
+enum ll_traversalAction count_proc(void *entry, void *context) {
+    (void)entry;
+    (*(size_t *)context)++;
+    return LL_TRAVERSAL_CONTINUE;
+}
+
+enum ll_traversalAction drop_odd(void *entry, void *context) {
+    (void)context;
+    return ((struct entry *)entry)->key % 2 ? LL_TRAVERSAL_DELETE
+                                            : LL_TRAVERSAL_CONTINUE;
+}
+
+enum ll_traversalAction bump(void *entry, void *context) {
+    ((struct entry *)entry)->val += *(int *)context;
+    return LL_TRAVERSAL_CONTINUE;
+}
+
+void single_thread_test() {
+    /* One shard so its table grows through many incremental migrations */
+    cmap_t M = cmap_new(1, &key_hash, &key_cmp, &entry_key, &entry_free);
+    bool present[KEYS] = {0};
+    size_t size = 0;
+    assert(cmap_size(M) == 0);
+
+    srand(3);
+    for (int i = 0; i < 4 * KEYS; i++) {
+        int k = rand() % KEYS;
+
+        if (rand() % 3) {
+            struct entry *e = entry_new(k, i);
+            if (cmap_insert(M, e) == 0) {
+                assert(!present[k]);
+                present[k] = true;
+                size++;
+            } else {
+                assert(present[k]);
+                free(e);
+            }
+        } else {
+            assert(cmap_del(M, &k) == !present[k]);
+            size -= present[k];
+            present[k] = false;
+        }
+    }
+    assert(cmap_size(M) == size);
+
+    for (int k = 0; k < KEYS; k++) {
+        struct entry *e = cmap_get(M, &k);
+        assert(present[k] ? e && e->key == k : e == NULL);
+    }
+
+    size_t count = 0;
+    cmap_traverse(M, &count_proc, &count);
+    assert(count == size);
+
+    cmap_traverse(M, &drop_odd, NULL);
+    for (int k = 0; k < KEYS; k++)
+        assert((cmap_get(M, &k) != NULL) == (present[k] && k % 2 == 0));
+
+    int k = 0;
+    if (cmap_get(M, &k) == NULL)
+        cmap_insert(M, entry_new(0, 0));
+    struct entry *old = cmap_update(M, &k, entry_new(0, 5), false);
+    assert(old && old->key == 0);
+    free(old);
+    int delta = 2;
+    assert(cmap_visit(M, &k, &bump, &delta) == 0);
+    assert(((struct entry *)cmap_get(M, &k))->val == 7);
+    k = 1;
+    struct entry missing = { 1, 0 };
+    assert(cmap_update(M, &k, &missing, true) == NULL);
+    assert(cmap_visit(M, &k, &bump, &delta) == 1);
+
+    cmap_free(M);
+}
+
+struct worker {
+    cmap_t M;
+    int id;
+};
+
+/* Each thread owns the keys congruent to its id and checks its own view while
+ * the others hammer the same shards */
+void *worker_run(void *arg) {
+    struct worker *W = arg;
+    int delta = 1;
+
+    for (int k = W->id; k < KEYS; k += THREADS)
+        assert(cmap_insert(W->M, entry_new(k, 0)) == 0);
+    for (int k = W->id; k < KEYS; k += THREADS) {
+        assert(cmap_visit(W->M, &k, &bump, &delta) == 0);
+        struct entry *e = cmap_get(W->M, &k);
+        assert(e && e->key == k && e->val == 1);
+    }
+    for (int k = W->id; k < KEYS; k += 2 * THREADS)
+        assert(cmap_del(W->M, &k) == 0);
+
+    return NULL;
+}
+
+void multi_thread_test() {
+    cmap_t M = cmap_new(4, &key_hash, &key_cmp, &entry_key, &entry_free);
+    pthread_t threads[THREADS];
+    struct worker workers[THREADS];
+
+    for (int i = 0; i < THREADS; i++) {
+        workers[i] = (struct worker){ M, i };
+        pthread_create(&threads[i], NULL, &worker_run, &workers[i]);
+    }
+    for (int i = 0; i < THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    size_t size = 0;
+    for (int k = 0; k < KEYS; k++) {
+        bool deleted = k % (2 * THREADS) < THREADS;
+        assert((cmap_get(M, &k) == NULL) == deleted);
+        size += !deleted;
+    }
+    assert(cmap_size(M) == size);
+
+    cmap_free(M);
+}
+
+int main() {
+    puts("single thread test");
+    single_thread_test();
+    puts("multi thread test");
+    multi_thread_test();
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "ds/filter.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define KEYS 10000
+
+void bloom_test_fn() {
+    bloom_t B = bloom_new(KEYS, 10);
+
+    for (uint64_t k = 0; k < KEYS; k++)
+        bloom_add(B, k);
+
+    /* No false negatives */
+    for (uint64_t k = 0; k < KEYS; k++)
+        assert(bloom_test(B, k));
+
+    size_t fp = 0;
+    for (uint64_t k = KEYS; k < 11 * KEYS; k++)
+        fp += bloom_test(B, k);
+    printf("bloom false positives: %.3f%%\n", fp * 100.0 / (10 * KEYS));
+    assert(fp < 10 * KEYS / 20);
+
+    bloom_clear(B);
+    assert(!bloom_test(B, 1) && !bloom_test(B, 2));
+    bloom_free(B);
+}
+
+void cuckoo_test_fn() {
+    cuckoo_t C = cuckoo_new(KEYS);
+    assert(cuckoo_size(C) == 0);
+
+    for (uint64_t k = 0; k < KEYS; k++)
+        assert(cuckoo_add(C, k) == 0);
+    assert(cuckoo_size(C) == KEYS);
+
+    for (uint64_t k = 0; k < KEYS; k++)
+        assert(cuckoo_test(C, k));
+
+    size_t fp = 0;
+    for (uint64_t k = KEYS; k < 11 * KEYS; k++)
+        fp += cuckoo_test(C, k);
+    printf("cuckoo false positives: %.3f%%\n", fp * 100.0 / (10 * KEYS));
+    assert(fp < 10 * KEYS / 100);
+
+    /* Deleting half keeps the other half */
+    for (uint64_t k = 0; k < KEYS; k += 2)
+        assert(cuckoo_del(C, k) == 0);
+    assert(cuckoo_size(C) == KEYS / 2);
+    for (uint64_t k = 1; k < KEYS; k += 2)
+        assert(cuckoo_test(C, k));
+
+    /* Duplicates are counted */
+    assert(cuckoo_add(C, 1) == 0);
+    assert(cuckoo_del(C, 1) == 0 && cuckoo_test(C, 1));
+    cuckoo_free(C);
+
+    /* Fill until full; every added key must still be found */
+    C = cuckoo_new(100);
+    uint64_t k = 0;
+    while (cuckoo_add(C, k) == 0)
+        k++;
+    assert(k >= 100);
+    for (uint64_t i = 0; i < k; i++)
+        assert(cuckoo_test(C, i));
+    cuckoo_free(C);
+}
+
+int main() {
+    puts("bloom test");
+    bloom_test_fn();
+    puts("cuckoo test");
+    cuckoo_test_fn();
+    return 0;
+}
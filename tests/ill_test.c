@@ -0,0 +1,167 @@
+#include "ds/ill.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+struct entry {
+    int key;
+    int val;
+};
+
+void *entry_new(int k, int v) {
+    struct entry *tmp = malloc(sizeof(*tmp));
+    tmp->key = k;
+    tmp->val = v;
+
+    return tmp;
+}
+
+int key_cmp(void *k1, void *k2) {
+    return *(int*)k1 < *(int*)k2 ? -1 : *(int*)k1 > *(int*)k2;
+}
+
+void *entry_key(void *entry) {
+    return &((struct entry*)entry)->key;
+}
+
+void entry_free(void *entry) {
+    free(entry);
+}
+
+void check_keys(ill_t L, const int *keys, int n) {
+    assert(ill_size(L) == (size_t)n);
+    for (int i = 0; i < n; i++) {
+        assert(((struct entry *)ill_at(L, i))->key == keys[i]);
+        assert(((struct entry *)ill_at(L, i - n))->key == keys[i]);
+    }
+}
+
+void insertion_test() {
+    ill_t L = ill_new(&key_cmp, &entry_key, &entry_free);
+    assert(ill_empty(L));
+
+    ill_insert(L, entry_new(1, 0));
+    ill_insert(L, entry_new(0, 0));
+    ill_insert_tail(L, entry_new(3, 0));
+    ill_insert_at(L, entry_new(2, 0), 2);
+    ill_insert_at(L, entry_new(-1, 0), -4);
+    check_keys(L, (int[]){-1, 0, 1, 2, 3}, 5);
+
+    /* Grow well past the initial array */
+    for (int i = 4; i < 100; i++)
+        ill_insert_tail(L, entry_new(i, i));
+    assert(ill_size(L) == 101);
+    assert(((struct entry *)ill_at(L, -1))->key == 99);
+
+    int k = 50;
+    assert(((struct entry *)ill_get(L, &k))->val == 50);
+
+    ill_free(L);
+}
+
+void deletion_test() {
+    ill_t L = ill_new(&key_cmp, &entry_key, &entry_free);
+    for (int i = 0; i < 10; i++)
+        ill_insert_tail(L, entry_new(i, i));
+
+    int k = 5;
+    assert(ill_del(L, &k) == 0 && ill_del(L, &k) == 1);
+    assert(ill_get(L, &k) == NULL);
+    ill_del_head(L);
+    ill_del_tail(L);
+    ill_del_at(L, 1);
+    ill_del_at(L, -2);
+    check_keys(L, (int[]){1, 3, 4, 6, 8}, 5);
+
+    /* Freed slots are reused before the array grows */
+    uint32_t used = L->used;
+    for (int i = 0; i < 5; i++)
+        ill_insert(L, entry_new(20 + i, 0));
+    assert(L->used == used);
+
+    struct entry *e = ill_take_head(L);
+    assert(e->key == 24);
+    free(e);
+    e = ill_take_at(L, -1);
+    assert(e->key == 8);
+    free(e);
+
+    k = 3;
+    e = ill_update(L, &k, entry_new(3, 33), false);
+    assert(e && e->val == 3);
+    free(e);
+    assert(ill_update_at(L, 0, entry_new(24, 1), true) == NULL);
+    assert(((struct entry *)ill_get(L, &k))->val == 33);
+
+    while (!ill_empty(L))
+        ill_del_tail(L);
+    ill_free(L);
+}
+
+enum ll_traversalAction odd_proc(void *entry, void *context) {
+    int *sum = context;
+    int key = ((struct entry *)entry)->key;
+
+    *sum += key;
+    if (key == 7)
+        return LL_TRAVERSAL_STOP;
+    return key % 2 ? LL_TRAVERSAL_DELETE : LL_TRAVERSAL_CONTINUE;
+}
+
+void traversal_test() {
+    ill_t L = ill_new(&key_cmp, &entry_key, &entry_free);
+    for (int i = 0; i < 10; i++)
+        ill_insert_tail(L, entry_new(i, i));
+
+    int sum = 0;
+    ill_traverse(L, &odd_proc, &sum);
+    assert(sum == 0 + 1 + 2 + 3 + 4 + 5 + 6 + 7);
+    check_keys(L, (int[]){0, 2, 4, 6, 7, 8, 9}, 7);
+
+    sum = 0;
+    ill_traverse_rev(L, &odd_proc, &sum);
+    assert(sum == 9 + 8 + 7);
+    check_keys(L, (int[]){0, 2, 4, 6, 7, 8}, 6);
+
+    ill_free(L);
+}
+
+void copy_test() {
+    ill_t L = ill_new(&key_cmp, &entry_key, &entry_free);
+    for (int i = 0; i < 50; i++)
+        ill_insert_tail(L, entry_new(i, i));
+    for (int i = 0; i < 50; i += 2)
+        ill_del(L, &i);
+
+    ill_t C = ill_copy(L, NULL);
+    for (int i = 0; i < 25; i++)
+        assert(ill_at(C, i) == ill_at(L, i));
+    ill_free(C);
+
+    /* Shrinking packs the nodes in list order into a right-sized array */
+    ill_insert(L, entry_new(-1, 0));
+    ill_shrink(L);
+    assert(L->limit == 27 && L->used == 27 && L->free == 0);
+    for (uint32_t i = 1; i < 27; i++)
+        assert(L->nodes[i].next == (i + 1) % 27);
+    assert(((struct entry *)ill_at(L, 0))->key == -1);
+    assert(((struct entry *)ill_at(L, 25))->key == 49);
+    ill_insert_tail(L, entry_new(50, 0));
+
+    ill_t E = ill_new(&key_cmp, &entry_key, &entry_free);
+    ill_shrink(E);
+    assert(ill_empty(E));
+    ill_insert(E, entry_new(0, 0));
+    ill_free(E);
+
+    ill_free(L);
+}
+
+int main() {
+    insertion_test();
+    deletion_test();
+    traversal_test();
+    copy_test();
+
+    return 0;
+}
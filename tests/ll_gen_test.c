@@ -0,0 +1,170 @@
+#include "ds/ll_gen.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+struct pair {
+    int key;
+    int val;
+};
+
+static inline int pair_key(const struct pair *p) {
+    return p->key;
+}
+
+static inline int int_cmp(int k1, int k2) {
+    return k1 < k2 ? -1 : k1 > k2;
+}
+
+LL_DEFINE(pl, struct pair, int, pair_key, int_cmp)
+
+/* Entries owning memory, keyed by string */
+struct named {
+    char *name;
+    int val;
+};
+
+#define named_key(e) ((const char *)(e)->name)
+
+LL_DEFINE(nl, struct named, const char *, named_key, strcmp)
+
+static void named_free(struct named *e) {
+    free(e->name);
+}
+
+static struct named named_new(const char *name, int val) {
+    return (struct named){ .name = strdup(name), .val = val };
+}
+
+static struct pair P(int k, int v) {
+    return (struct pair){ k, v };
+}
+
+enum ll_traversalAction print_proc(struct pair *e, void *context) {
+    (void)context;
+    printf("---<%d, %d>", e->key, e->val);
+    return LL_TRAVERSAL_CONTINUE;
+}
+
+void print_list(pl_t L) {
+    printf("<HEAD>");
+    pl_traverse(L, &print_proc, NULL);
+    printf("---<TAIL>\n");
+}
+
+enum ll_traversalAction del_odd_proc(struct pair *e, void *context) {
+    if (e->key % 2) {
+        (*(int *)context)++;
+        return LL_TRAVERSAL_DELETE;
+    }
+    return LL_TRAVERSAL_CONTINUE;
+}
+
+enum ll_traversalAction stop_proc(struct pair *e, void *context) {
+    *(int *)context = e->key;
+    return LL_TRAVERSAL_STOP;
+}
+
+void insertion_test() {
+    pl_t L = pl_new(NULL);
+    assert(pl_empty(L) && pl_size(L) == 0);
+
+    pl_insert_at(L, P(1, 1), 0);
+    pl_insert(L, P(11, 2));
+    pl_insert_tail(L, P(12, 3));
+    pl_insert(L, P(8, 4));
+    pl_insert_at(L, P(4, 5), 4);
+    pl_insert_at(L, P(20, 6), 2);
+    pl_insert_at(L, P(30, 7), -1);
+    print_list(L);
+
+    int expect[] = { 8, 11, 20, 1, 12, 30, 4 };
+    assert(pl_size(L) == 7);
+    for (int i = 0; i < 7; i++) {
+        assert(pl_at(L, i)->key == expect[i]);
+        assert(pl_at(L, i - 7)->key == expect[i]);
+    }
+
+    pl_free(L);
+}
+
+void deletion_test() {
+    pl_t L = pl_new(NULL);
+    for (int i = 0; i < 10; i++)
+        pl_insert_tail(L, P(i, i * 10));
+    pl_insert_tail(L, P(3, 333));
+
+    pl_del_head(L);
+    pl_del_tail(L);
+    pl_del_at(L, 1);
+    pl_del_at(L, -1);
+    assert(pl_size(L) == 7);
+    assert(pl_at(L, 0)->key == 1 && pl_at(L, 1)->key == 3);
+    assert(pl_at(L, -1)->key == 8);
+
+    pl_insert_tail(L, P(3, 333));
+    assert(pl_del_rev(L, 3) == 0);
+    assert(pl_get(L, 3)->val == 30);
+    assert(pl_del(L, 3) == 0 && pl_get(L, 3) == NULL);
+    assert(pl_del(L, 3) == 1);
+
+    int count = 0;
+    pl_traverse(L, &del_odd_proc, &count);
+    assert(count == 3 && pl_size(L) == 3);
+
+    int first = -1;
+    pl_traverse_rev(L, &stop_proc, &first);
+    assert(first == 8);
+    print_list(L);
+
+    pl_free(L);
+}
+
+void update_test() {
+    pl_t L = pl_new(NULL);
+    for (int i = 0; i < 4; i++)
+        pl_insert_tail(L, P(i, i));
+
+    struct pair old;
+    assert(pl_update(L, 2, P(2, 200), &old) == 0 && old.val == 2);
+    assert(pl_update(L, 9, P(9, 9), &old) == 1);
+    pl_update_at(L, -1, P(3, 300), NULL);
+    assert(pl_get(L, 2)->val == 200 && pl_at(L, 3)->val == 300);
+
+    /* Entries are stored by value and can be modified in place */
+    pl_get(L, 0)->val = 42;
+    assert(pl_at(L, 0)->val == 42);
+
+    pl_free(L);
+}
+
+void free_test() {
+    nl_t L = nl_new(&named_free);
+
+    nl_insert(L, named_new("alpha", 1));
+    nl_insert_tail(L, named_new("beta", 2));
+    nl_insert_tail(L, named_new("gamma", 3));
+
+    assert(nl_get(L, "beta")->val == 2);
+    assert(nl_get(L, "delta") == NULL);
+
+    nl_update(L, "beta", named_new("beta", 20), NULL);
+    assert(nl_get(L, "beta")->val == 20);
+    assert(nl_del(L, "alpha") == 0);
+    assert(nl_size(L) == 2);
+
+    nl_free(L);
+}
+
+int main() {
+    puts("Insertion test");
+    insertion_test();
+    puts("Deletion test");
+    deletion_test();
+    puts("Update test");
+    update_test();
+    puts("Free test");
+    free_test();
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "ds/ll.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+struct Item {
+    int key;
+    static int live;
+
+    explicit Item(int k) : key(k) { live++; }
+    ~Item() { live--; }
+};
+
+int Item::live = 0;
+
+using by_key = ds::member_key<Item, int, &Item::key>;
+
+static_assert(!std::is_copy_constructible<ds::ll<Item>>::value, "ll copies");
+static_assert(std::is_nothrow_move_constructible<ds::ll<Item>>::value, "ll moves");
+
+void order_test() {
+    Item items[5] = { Item(3), Item(1), Item(4), Item(1), Item(5) };
+    ds::ll<Item, by_key> L;
+
+    for (Item &it : items)
+        L.push_back(&it);
+    L.push_front(&items[4]);
+    assert(L.size() == 6 && L.front() == &items[4] && L.back() == &items[4]);
+    L.pop_front();
+
+    /* Bidirectional iteration through <algorithm> */
+    assert(std::distance(L.begin(), L.end()) == 5);
+    std::reverse(L.begin(), L.end());
+    assert(L.front() == &items[4] && L.back() == &items[0]);
+
+    auto it = std::find_if(L.begin(), L.end(), [](Item *e) { return e->key == 4; });
+    assert(it != L.end() && *it == &items[2]);
+
+    int keys[5], n = 0;
+    for (auto r = std::make_reverse_iterator(L.end()); r != std::make_reverse_iterator(L.begin()); ++r)
+        keys[n++] = (*r)->key;
+    assert(keys[0] == 3 && keys[4] == 5);
+
+    /* Lookups through the key policy */
+    assert(L.get(4) == &items[2] && L.get(9) == nullptr);
+    assert(L.find(1) != L.end() && (*L.find(1))->key == 1);
+
+    /* The C functions see the same keys through handle() */
+    int four = 4, nine = 9;
+    assert(ll_get(L.handle(), &four) == &items[2] && ll_get(L.handle(), &nine) == nullptr);
+
+    /* insert and erase at iterators */
+    it = L.insert(L.find(4), &items[0]);
+    assert(*it == &items[0] && *std::next(it) == &items[2] && L.size() == 6);
+    it = L.erase(it);
+    assert(*it == &items[2] && L.size() == 5);
+    L.insert(L.end(), &items[1]);
+    assert(L.back() == &items[1]);
+    while (L.find(1) != L.end())
+        L.erase(L.find(1));
+    assert(L.size() == 3);
+
+    /* Moving leaves the source empty-handed, clone shares the entries */
+    ds::ll<Item, by_key> M = std::move(L);
+    assert(M.size() == 3 && M.handle() != nullptr);
+    ds::ll<Item, by_key> C = M.clone();
+    assert(C.size() == 3 && std::equal(C.begin(), C.end(), M.begin()));
+    L = std::move(C);
+    L.clear();
+    assert(L.empty() && M.size() == 3);
+
+    /* Entries can be written through iterators */
+    *M.begin() = &items[1];
+    std::iter_swap(M.begin(), std::next(M.begin()));
+    assert(*std::next(M.begin()) == &items[1] && M.get(1) == &items[1]);
+    assert(ll_del(M.handle(), &four) == 0 && M.size() == 2 && M.get(4) == nullptr);
+
+    /* ptr_key lists take the entry itself as the C key */
+    ds::ll<Item> P;
+    P.push_back(&items[3]);
+    assert(ll_get(P.handle(), &items[3]) == &items[3] && ll_get(P.handle(), &items[0]) == nullptr);
+}
+
+void ownership_test() {
+    {
+        ds::ll<Item, ds::ptr_key<Item>, ds::delete_entry<Item>> L;
+        for (int i = 0; i < 100; i++)
+            L.push_back(new Item(i));
+        assert(Item::live == 100);
+
+        L.pop_back();
+        L.erase(L.begin());
+        assert(Item::live == 98);
+
+        ds::ll<Item, ds::ptr_key<Item>, ds::delete_entry<Item>> M(std::move(L));
+        assert(M.size() == 98 && Item::live == 98);
+        M.pop_front();
+        assert(Item::live == 97);
+    }
+    assert(Item::live == 0);
+}
+
+int main() {
+    order_test();
+    ownership_test();
+
+    return 0;
+}
@@ -1,5 +1,7 @@
 #include "ds/ll.h"
+#include "ds/reclaim.h"
 #include <assert.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 
@@ -213,6 +215,401 @@ ll_t traversal_test() {
     return L;
 }
 
+size_t entry_serialize(void *entry, void *buf, size_t len) {
+    if (len >= sizeof(struct entry))
+        *(struct entry *)buf = *(struct entry *)entry;
+    return sizeof(struct entry);
+}
+
+void *entry_deserialize(void *payload, size_t len) {
+    assert(len == sizeof(struct entry));
+    return payload;
+}
+
+void persistence_test() {
+    ll_t L = insertion_test();
+    assert(ll_save(L, "ll_test.bin", &entry_serialize) == 0);
+
+    ll_t M = ll_load("ll_test.bin", &entry_deserialize, &key_cmp, &entry_key,
+                     NULL);
+    assert(M != NULL && ll_size(M) == ll_size(L));
+    for (int i = 0; i < (int)ll_size(L); i++) {
+        struct entry *a = ll_at(L, i), *b = ll_at(M, i);
+        assert(a->key == b->key && a->val == b->val);
+    }
+    print_list(M);
+
+    /* Mapped nodes and heap nodes mix freely */
+    ll_del_head(M);
+    struct entry *e = entry_new(50, 50);
+    ll_insert_at(M, e, 1);
+    ll_del_at(M, 1);
+    free(e);
+    int k = 12;
+    ll_del(M, &k);
+    print_list(M);
+
+    ll_free(M);
+
+    /* A bad count is caught like a bad payload */
+    FILE *f = fopen("ll_test.bin", "r+b");
+    fseek(f, 16, SEEK_SET);
+    fputc(0x7f, f);
+    fclose(f);
+    assert(ll_load("ll_test.bin", &entry_deserialize, &key_cmp, &entry_key,
+                   NULL) == NULL);
+
+    assert(ll_save(L, "ll_test.bin", &entry_serialize) == 0);
+    ll_free(L);
+    f = fopen("ll_test.bin", "r+b");
+    fseek(f, -1, SEEK_END);
+    fputc(0x7f, f);
+    fclose(f);
+    assert(ll_load("ll_test.bin", &entry_deserialize, &key_cmp, &entry_key,
+                   NULL) == NULL);
+    remove("ll_test.bin");
+}
+
+uint64_t key_hash(void *key) {
+    return *(int *)key;
+}
+
+void filter_test() {
+    ll_t L = init_test();
+    for (int i = 0; i < 1000; i++)
+        ll_insert_tail(L, entry_new(i, i));
+
+    ll_set_filter(L, &key_hash);
+    assert(L->filter != NULL);
+
+    for (int i = 0; i < 2000; i += 100) {
+        struct entry *e = ll_get(L, &i);
+        assert(i < 1000 ? e && e->key == i : e == NULL);
+    }
+
+    /* Filter follows inserts, deletes and updates */
+    ll_insert(L, entry_new(5000, 0));
+    int k = 5000;
+    assert(ll_get(L, &k) != NULL);
+    assert(ll_del(L, &k) == 0 && ll_get(L, &k) == NULL);
+    assert(ll_del(L, &k) == 1);
+
+    k = 10;
+    ll_update(L, &k, entry_new(6000, 0), true);
+    assert(ll_get(L, &k) == NULL);
+    k = 6000;
+    assert(ll_get(L, &k) != NULL);
+    struct entry missing = { 7000, 0 };
+    assert(ll_update(L, &missing.key, &missing, true) == NULL);
+
+    for (int i = 0; i < 3000; i++)
+        ll_insert(L, entry_new(10000 + i, i));
+    for (int i = 0; i < 3000; i++)
+        assert(ll_get(L, &(int){10000 + i}) != NULL);
+
+    ll_set_filter(L, NULL);
+    assert(L->filter == NULL && ll_get(L, &k) != NULL);
+    ll_free(L);
+}
+
+/* Deliberately weak so distinct keys share fingerprints */
+uint64_t weak_hash(void *key) {
+    return *(int *)key % 16;
+}
+
+void fingerprint_test() {
+    ll_t L = ll_new_hashed(&key_cmp, &entry_key, &entry_free, &weak_hash);
+    for (int i = 0; i < 200; i++)
+        ll_insert_tail(L, entry_new(i, i));
+
+    for (int i = -50; i < 250; i++) {
+        struct entry *e = ll_get(L, &i);
+        assert(0 <= i && i < 200 ? e && e->key == i : e == NULL);
+    }
+
+#ifdef DS_STATS
+    /* Only the 1 in 16 nodes with a matching fingerprint reach key_cmp */
+    struct ll_Stats before = ll_stats(L);
+    int k = 199;
+    ll_get(L, &k);
+    assert(ll_stats(L).key_cmps - before.key_cmps == 13);
+#endif
+
+    /* Fingerprints follow updates, deletes and a compaction */
+    int k2 = 20;
+    ll_update(L, &k2, entry_new(1000, 0), true);
+    assert(ll_get(L, &k2) == NULL);
+    k2 = 1000;
+    assert(ll_get(L, &k2) != NULL);
+    assert(ll_del(L, &k2) == 0 && ll_get(L, &k2) == NULL);
+    k2 = 21;
+    assert(ll_del_rev(L, &k2) == 0 && ll_del_rev(L, &k2) == 1);
+    ll_compact(L);
+    k2 = 150;
+    assert(((struct entry *)ll_get(L, &k2))->val == 150);
+
+    /* A filter with a different hash replaces the fingerprint hash */
+    ll_set_filter(L, &key_hash);
+    assert(((struct entry *)ll_get(L, &k2))->val == 150);
+    ll_set_filter(L, NULL);
+    assert(L->key_hash == &key_hash && ll_get(L, &k2) != NULL);
+
+    ll_free(L);
+}
+
+/* Check that the keys of L read keys[0..n) from the head */
+void check_order(ll_t L, const int *keys, int n) {
+    assert((int)ll_size(L) == n);
+    for (int i = 0; i < n; i++)
+        assert(((struct entry *)ll_at(L, i))->key == keys[i]);
+}
+
+ll_t reorg_list(enum ll_reorg reorg) {
+    ll_t L = init_test();
+    ll_set_reorg(L, reorg);
+    for (int i = 0; i < 5; i++)
+        ll_insert_tail(L, entry_new(i, i));
+    return L;
+}
+
+void reorg_test() {
+    int k;
+
+    ll_t L = reorg_list(LL_REORG_NONE);
+    k = 3;
+    ll_get(L, &k);
+    check_order(L, (int[]){0, 1, 2, 3, 4}, 5);
+    ll_free(L);
+
+    L = reorg_list(LL_REORG_MOVE_TO_FRONT);
+    k = 3;
+    ll_get(L, &k);
+    check_order(L, (int[]){3, 0, 1, 2, 4}, 5);
+    k = 4;
+    ll_update(L, &k, entry_new(4, 40), true);
+    check_order(L, (int[]){4, 3, 0, 1, 2}, 5);
+    k = 4;
+    ll_get(L, &k);
+    check_order(L, (int[]){4, 3, 0, 1, 2}, 5);
+    ll_free(L);
+
+    L = reorg_list(LL_REORG_TRANSPOSE);
+    k = 3;
+    ll_get(L, &k);
+    check_order(L, (int[]){0, 1, 3, 2, 4}, 5);
+    ll_get(L, &k);
+    ll_get(L, &k);
+    ll_get(L, &k);
+    check_order(L, (int[]){3, 0, 1, 2, 4}, 5);
+    ll_free(L);
+
+    L = reorg_list(LL_REORG_COUNT);
+    k = 2;
+    ll_get(L, &k);
+    check_order(L, (int[]){2, 0, 1, 3, 4}, 5);
+    k = 4;
+    ll_get(L, &k);
+    check_order(L, (int[]){2, 4, 0, 1, 3}, 5);
+    ll_get(L, &k);
+    check_order(L, (int[]){4, 2, 0, 1, 3}, 5);
+    /* Ties keep their order */
+    k = 1;
+    ll_get(L, &k);
+    check_order(L, (int[]){4, 2, 1, 0, 3}, 5);
+    ll_compact(L);
+    ll_get(L, &k);
+    check_order(L, (int[]){4, 1, 2, 0, 3}, 5);
+    ll_get(L, &k);
+    check_order(L, (int[]){1, 4, 2, 0, 3}, 5);
+    ll_free(L);
+
+    /* Switching a populated hashed list over starts counting from zero */
+    L = ll_new_hashed(&key_cmp, &entry_key, &entry_free, &weak_hash);
+    ll_set_reorg(L, LL_REORG_MOVE_TO_FRONT);
+    for (int i = 0; i < 5; i++)
+        ll_insert_tail(L, entry_new(i, i));
+    k = 3;
+    ll_get(L, &k);
+    ll_set_reorg(L, LL_REORG_COUNT);
+    k = 4;
+    ll_get(L, &k);
+    check_order(L, (int[]){4, 3, 0, 1, 2}, 5);
+    k = 0;
+    ll_get(L, &k);
+    check_order(L, (int[]){4, 0, 3, 1, 2}, 5);
+    ll_free(L);
+}
+
+void compact_test() {
+    ll_t L = init_test();
+    ll_compact(L);
+    assert(ll_empty(L));
+
+    /* Scatter nodes with positional churn, compacting in between so heap
+     * nodes and block nodes mix */
+    srand(5);
+    int expect[1000], n = 0;
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 300; i++) {
+            int at = rand() % (n + 1);
+            if (at == n)
+                ll_insert_tail(L, entry_new(round * 1000 + i, 0));
+            else
+                ll_insert_at(L, entry_new(round * 1000 + i, 0), at);
+            for (int j = n; j > at; j--)
+                expect[j] = expect[j - 1];
+            expect[at] = round * 1000 + i;
+            n++;
+        }
+        for (int i = 0; i < 100; i++) {
+            int at = rand() % n;
+            ll_del_at(L, at);
+            for (int j = at; j < n - 1; j++)
+                expect[j] = expect[j + 1];
+            n--;
+        }
+
+        ll_compact(L);
+        assert((int)ll_size(L) == n);
+        for (int i = 0; i < n; i++)
+            assert(((struct entry *)ll_at(L, i))->key == expect[i]);
+        for (int i = 1; i <= n; i++)
+            assert(((struct entry *)ll_at(L, -i))->key == expect[n - i]);
+        assert(L->block != NULL && (void *)L->head.next == L->block);
+    }
+
+    ll_del_head(L);
+    ll_insert(L, entry_new(-1, 0));
+    int k = -1;
+    assert(ll_get(L, &k) != NULL);
+
+    ll_free(L);
+}
+
+void deferred_free_test() {
+    ll_t L = init_test();
+    for (int i = 0; i < 100; i++)
+        ll_insert_tail(L, entry_new(i, i));
+    ll_compact(L);
+    for (int i = 100; i < 150; i++)
+        ll_insert_tail(L, entry_new(i, i));
+
+    /* Steps free from the head, across block and heap nodes */
+    int steps = 0;
+    while (!ll_free_step(L, 16)) {
+        steps++;
+        assert(ll_size(L) == 150 - (size_t)steps * 16);
+        assert(((struct entry *)ll_at(L, 0))->key == steps * 16);
+    }
+    assert(steps == 150 / 16);
+
+    L = init_test();
+    assert(ll_free_step(L, 1));
+
+    for (int round = 0; round < 4; round++) {
+        L = init_test();
+        ll_set_filter(L, &key_hash);
+        for (int i = 0; i < 5000; i++)
+            ll_insert(L, entry_new(i, i));
+        ll_free_async(L);
+    }
+    reclaim_drain();
+}
+
+void ownership_test() {
+    ll_t A = init_test();
+    ll_t B = init_test();
+    ll_set_filter(A, &key_hash);
+    for (int i = 0; i < 10; i++)
+        ll_insert_tail(A, entry_new(i, i));
+
+    /* Entries move between lists without being freed or copied */
+    struct entry *head = ll_take_head(A);
+    struct entry *tail = ll_take_at(A, -1);
+    struct entry *mid = ll_take_at(A, 3);
+    assert(head->key == 0 && tail->key == 9 && mid->key == 4);
+    assert(ll_size(A) == 7);
+
+    int k = 4;
+    assert(ll_get(A, &k) == NULL);
+    ll_insert_tail(B, head);
+    ll_insert_tail(B, mid);
+    ll_insert_tail(B, tail);
+    assert(ll_get(B, &k) == mid);
+
+    ll_swap(A, B);
+    assert(ll_size(A) == 3 && ll_size(B) == 7);
+    assert(ll_get(A, &k) == mid && ll_get(B, &k) == NULL);
+    k = 5;
+    assert(ll_get(B, &k) != NULL && ll_get(A, &k) == NULL);
+
+    ll_free(A);
+    ll_free(B);
+}
+
+struct owner {
+    int id;
+    struct ll_Header items;
+};
+
+void embedded_test() {
+    struct owner O = { .id = 1 };
+    ll_init(&O.items, &key_cmp, &entry_key, &entry_free);
+    assert(ll_empty(&O.items));
+
+    for (int i = 0; i < 5; i++)
+        ll_insert_tail(&O.items, entry_new(i, i));
+    int k = 3;
+    assert(((struct entry *)ll_get(&O.items, &k))->val == 3);
+
+    /* Swapping relinks the nodes to the sentinels of their new header */
+    ll_t L = init_test();
+    ll_swap(L, &O.items);
+    assert(ll_empty(&O.items) && ll_size(L) == 5);
+    ll_insert(&O.items, entry_new(-1, 0));
+    ll_del_tail(L);
+    ll_swap(L, &O.items);
+    assert(ll_size(&O.items) == 4 && ll_size(L) == 1);
+    assert(((struct entry *)ll_at(&O.items, -1))->key == 3);
+
+    ll_fini(&O.items);
+    ll_init(&O.items, &key_cmp, &entry_key, NULL);
+    ll_fini(&O.items);
+    ll_free(L);
+}
+
+void stats_test() {
+#ifdef DS_STATS
+    ll_t L = init_test();
+    struct ll_Stats s = ll_stats(L);
+    assert(s.allocs == 1 && s.nodes_visited == 0 && s.key_cmps == 0);
+
+    for (int i = 0; i < 4; i++)
+        ll_insert_tail(L, entry_new(i, i));
+
+    s = ll_stats(L);
+    assert(s.allocs == 5);
+
+    int k = 3;
+    ll_get(L, &k);
+    s = ll_stats(L);
+    assert(s.key_cmps == 4 && s.nodes_visited == 4);
+
+    ll_at(L, -2);
+    s = ll_stats(L);
+    assert(s.nodes_visited == 6);
+
+    k = 100;
+    ll_insert_at(L, entry_new(100, 0), 1);
+    ll_traverse(L, &del_proc, &k);
+    s = ll_stats(L);
+    assert(s.traversal_dels == 1);
+
+    ll_stats_dump(stdout);
+    ll_free(L);
+#endif
+}
+
 int main() {
     puts("Init / free test");
     ll_free(init_test());
@@ -224,5 +621,23 @@ int main() {
     ll_free(get_test());
     puts("traversal test");
     ll_free(traversal_test());
+    puts("persistence test");
+    persistence_test();
+    puts("filter test");
+    filter_test();
+    puts("fingerprint test");
+    fingerprint_test();
+    puts("reorg test");
+    reorg_test();
+    puts("compact test");
+    compact_test();
+    puts("deferred free test");
+    deferred_free_test();
+    puts("ownership test");
+    ownership_test();
+    puts("embedded test");
+    embedded_test();
+    puts("stats test");
+    stats_test();
     return 0;
 }
@@ -0,0 +1,89 @@
+#include "ds/pool.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define N 100000
+
+struct job {
+    atomic_int hits[N];
+    atomic_size_t chunks;
+    size_t grain;
+    size_t n;
+};
+
+void mark(void *context, size_t begin, size_t end, size_t chunk) {
+    struct job *J = context;
+    assert(begin < end && end <= J->n);
+    assert(begin == chunk * J->grain);
+    assert(end == (begin + J->grain < J->n ? begin + J->grain : J->n));
+
+    /* Uneven work so idle threads have something to steal */
+    if (chunk % 7 == 0 && end - begin > 1) {
+        volatile size_t spin = 0;
+        while (spin < 20000)
+            spin++;
+    }
+
+    for (size_t i = begin; i < end; i++)
+        atomic_fetch_add(&J->hits[i], 1);
+    atomic_fetch_add(&J->chunks, 1);
+}
+
+void run(pool_t P, struct job *J, size_t n, size_t grain) {
+    for (size_t i = 0; i < n; i++)
+        atomic_store(&J->hits[i], 0);
+    atomic_store(&J->chunks, 0);
+    J->n = n;
+    J->grain = grain;
+
+    pool_for(P, n, grain, &mark, J);
+
+    for (size_t i = 0; i < n; i++)
+        assert(atomic_load(&J->hits[i]) == 1);
+    assert(atomic_load(&J->chunks) == (n + grain - 1) / grain);
+}
+
+void for_test() {
+    struct job *J = malloc(sizeof(*J));
+
+    for (size_t threads = 1; threads <= 8; threads *= 2) {
+        pool_t P = pool_new(threads);
+        assert(pool_threads(P) == threads);
+
+        /* Reusing a pool across many jobs must not lose or repeat chunks */
+        for (int round = 0; round < 5; round++) {
+            run(P, J, N, 1000);
+            run(P, J, N / 10, 1);
+            run(P, J, 1, 1);
+            run(P, J, 0, 1);
+            run(P, J, 997, pool_grain(P, 997));
+        }
+        pool_free(P);
+    }
+
+    free(J);
+}
+
+void grain_test() {
+    pool_t P = pool_new(4);
+
+    assert(pool_grain(P, 0) == POOL_MIN_GRAIN);
+    assert(pool_grain(P, 100) == POOL_MIN_GRAIN);
+    size_t n = 4 * POOL_CHUNKS_PER_THREAD * POOL_MIN_GRAIN * 10;
+    assert(pool_grain(P, n) == POOL_MIN_GRAIN * 10);
+
+    pool_free(P);
+
+    assert(pool_default() == pool_default());
+    assert(pool_threads(pool_default()) >= 1);
+}
+
+int main() {
+    puts("for test");
+    for_test();
+    puts("grain test");
+    grain_test();
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include "ds/pq.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+struct task {
+    int prio;
+    size_t index;
+};
+
+void *mkint(int num) {
+    void *tmp = malloc(sizeof(int));
+    *(int *)tmp = num;
+    return tmp;
+}
+
+void entry_free_fn(void *entry) {
+    free(entry);
+}
+
+int int_cmp(void *e1, void *e2) {
+    return *(int *)e1 < *(int *)e2 ? -1 : *(int *)e1 > *(int *)e2;
+}
+
+int task_cmp(void *e1, void *e2) {
+    return int_cmp(&((struct task *)e1)->prio, &((struct task *)e2)->prio);
+}
+
+void task_index(void *entry, size_t index) {
+    ((struct task *)entry)->index = index;
+}
+
+void push_pop_test() {
+    pq_t P = pq_new(0, &int_cmp, NULL, &entry_free_fn);
+    assert(pq_empty(P));
+
+    srand(1);
+    for (int i = 0; i < 1000; i++)
+        pq_push(P, mkint(rand() % 500));
+    assert(pq_size(P) == 1000);
+
+    int prev = -1;
+    for (int i = 0; i < 990; i++) {
+        int *e = pq_pop(P);
+        assert(*e >= prev);
+        prev = *e;
+        free(e);
+    }
+    assert(pq_size(P) == 10 && *(int *)pq_peek(P) >= prev);
+
+    /* Remaining entries are freed with the queue */
+    pq_free(P);
+}
+
+void heapify_test() {
+    uba_t U = uba_new(0, false, &entry_free_fn);
+    for (int i = 0; i < 257; i++)
+        uba_push(U, mkint((i * 37) % 257));
+
+    pq_t P = pq_heapify(U, &int_cmp, NULL);
+    assert(pq_size(P) == 257);
+
+    for (int i = 0; i < 257; i++) {
+        int *e = pq_pop(P);
+        assert(*e == i);
+        free(e);
+    }
+    assert(pq_empty(P));
+    pq_free(P);
+}
+
+void handle_test() {
+    struct task tasks[100];
+    pq_t P = pq_new(4, &task_cmp, &task_index, NULL);
+
+    for (int i = 0; i < 100; i++) {
+        tasks[i].prio = 1000 + i;
+        pq_push(P, &tasks[i]);
+    }
+    for (int i = 0; i < 100; i++)
+        assert(uba_get(P->heap, tasks[i].index) == &tasks[i]);
+
+    /* Decrease-key */
+    tasks[70].prio = 1;
+    pq_update(P, tasks[70].index);
+    assert(pq_peek(P) == &tasks[70]);
+
+    /* Increase-key */
+    tasks[70].prio = 5000;
+    pq_update(P, tasks[70].index);
+    assert(pq_peek(P) == &tasks[0]);
+
+    assert(pq_remove(P, tasks[50].index) == &tasks[50]);
+    assert(pq_remove(P, tasks[99].index) == &tasks[99]);
+    assert(pq_size(P) == 98);
+
+    int prev = 0;
+    while (!pq_empty(P)) {
+        struct task *t = pq_pop(P);
+        assert(t != &tasks[50] && t != &tasks[99] && t->prio >= prev);
+        prev = t->prio;
+    }
+    assert(prev == 5000);
+
+    pq_free(P);
+}
+
+int main() {
+    puts("push/pop test");
+    push_pop_test();
+    puts("heapify test");
+    heapify_test();
+    puts("handle test");
+    handle_test();
+    return 0;
+}
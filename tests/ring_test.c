@@ -0,0 +1,120 @@
+#include "ds/ring.h"
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define N 200000
+
+/* Entries are small integers cast to pointers; 0 is never pushed */
+#define ENTRY(i) ((void *)(uintptr_t)(i))
+#define VALUE(e) ((size_t)(uintptr_t)(e))
+
+void *mkint(int num) {
+    int *tmp = malloc(sizeof(int));
+    *tmp = num;
+    return tmp;
+}
+
+void basic_test() {
+    ring_t R = ring_new(5, NULL);
+    assert(ring_capacity(R) == 8 && ring_size(R) == 0);
+    assert(ring_pop(R) == NULL);
+
+    /* Wrap around the slot array several times */
+    size_t next = 1, expect = 1;
+    for (int round = 0; round < 10; round++) {
+        while (ring_push(R, ENTRY(next)))
+            next++;
+        assert(ring_size(R) == 8);
+
+        for (int i = 0; i < 5; i++)
+            assert(VALUE(ring_pop(R)) == expect++);
+        assert(ring_size(R) == 3);
+    }
+    while (ring_pop(R))
+        expect++;
+    assert(expect == next && ring_size(R) == 0);
+
+    ring_free(R);
+}
+
+void batch_test() {
+    ring_t R = ring_new(16, NULL);
+    void *in[40], *out[40];
+    for (size_t i = 0; i < 40; i++)
+        in[i] = ENTRY(i + 1);
+
+    /* Batches are cut short at the capacity and at the entries available */
+    assert(ring_push_n(R, in, 40) == 16);
+    assert(ring_push_n(R, in + 16, 4) == 0);
+    assert(ring_pop_n(R, out, 10) == 10);
+    assert(ring_push_n(R, in + 16, 24) == 10);
+    assert(ring_pop_n(R, out + 10, 40) == 16);
+    assert(ring_pop_n(R, out, 40) == 0);
+
+    for (size_t i = 0; i < 26; i++)
+        assert(VALUE(out[i]) == i + 1);
+
+    ring_free(R);
+}
+
+void free_test() {
+    ring_t R = ring_new(8, &free);
+    for (int i = 0; i < 6; i++)
+        ring_push(R, mkint(i));
+    free(ring_pop(R));
+    ring_free(R);
+}
+
+void *consume(void *arg) {
+    ring_t R = arg;
+    void *out[32];
+    size_t expect = 1, got;
+
+    while ((got = ring_pop_wait(R, out, 32))) {
+        for (size_t i = 0; i < got; i++)
+            assert(VALUE(out[i]) == expect++);
+    }
+    assert(ring_closed(R) && expect == N + 1);
+    return NULL;
+}
+
+void threaded_test() {
+    /* Small ring so both sides hit full and empty and the consumer sleeps */
+    ring_t R = ring_new(64, NULL);
+    pthread_t consumer;
+    pthread_create(&consumer, NULL, &consume, R);
+
+    void *batch[7];
+    size_t next = 1;
+    while (next <= N) {
+        size_t n = 0;
+        while (n < 7 && next + n <= N) {
+            batch[n] = ENTRY(next + n);
+            n++;
+        }
+
+        /* The ring has no blocking push; yield while it is full */
+        size_t done = 0;
+        while ((done += ring_push_n(R, batch + done, n - done)) < n)
+            sched_yield();
+        next += n;
+    }
+    ring_close(R);
+
+    pthread_join(consumer, NULL);
+    assert(ring_size(R) == 0);
+    ring_free(R);
+}
+
+int main() {
+    basic_test();
+    batch_test();
+    free_test();
+    threaded_test();
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include "ds/seq.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define ENTRY(i) ((void *)(uintptr_t)(i))
+#define MAX 5000
+
+int freed;
+
+void counting_free(void *entry) {
+    (void)entry;
+    freed++;
+}
+
+/* Reference copy of the sequence */
+uintptr_t model[MAX];
+size_t model_size;
+
+void check(seq_t S) {
+    assert(seq_size(S) == model_size && seq_empty(S) == (model_size == 0));
+    for (size_t i = 0; i < model_size; i++)
+        assert(seq_get(S, i) == ENTRY(model[i]));
+}
+
+void model_insert(size_t index, uintptr_t v) {
+    for (size_t i = model_size; i > index; i--)
+        model[i] = model[i - 1];
+    model[index] = v;
+    model_size++;
+}
+
+void model_remove(size_t index) {
+    for (size_t i = index; i + 1 < model_size; i++)
+        model[i] = model[i + 1];
+    model_size--;
+}
+
+void layout_test() {
+    seq_t S = seq_new(NULL);
+    struct seq_Tuning fixed = { 0, 0, 1, 0 };
+    seq_set_tuning(S, fixed);
+    model_size = 0;
+
+    /* Both layouts behave the same, across splits and merges of chunks */
+    for (int round = 0; round < 4; round++) {
+        seq_convert(S, round % 2 ? SEQ_ARRAY : SEQ_CHUNKED);
+        assert(seq_layout(S) == (round % 2 ? SEQ_ARRAY : SEQ_CHUNKED));
+
+        for (int i = 0; i < 3 * SEQ_CHUNK; i++) {
+            size_t index = rand() % (model_size + 1);
+            seq_insert(S, index, ENTRY(round * 10000 + i));
+            model_insert(index, round * 10000 + i);
+        }
+        check(S);
+
+        for (int i = 0; i < 2 * SEQ_CHUNK; i++) {
+            size_t index = rand() % model_size;
+            assert(seq_take(S, index) == ENTRY(model[index]));
+            model_remove(index);
+        }
+        check(S);
+
+        seq_update(S, 0, ENTRY(7));
+        model[0] = 7;
+        seq_push(S, ENTRY(8));
+        model_insert(model_size, 8);
+        check(S);
+    }
+
+    /* Emptying a chunked sequence and filling it again */
+    seq_convert(S, SEQ_CHUNKED);
+    while (!seq_empty(S))
+        seq_pop(S);
+    model_size = 0;
+    for (int i = 0; i < 2 * SEQ_CHUNK + 1; i++) {
+        seq_push(S, ENTRY(i));
+        model_insert(model_size, i);
+    }
+    check(S);
+
+    /* Walking backwards moves the cursor back */
+    for (size_t i = model_size; i-- > 0;)
+        assert(seq_get(S, i) == ENTRY(model[i]));
+
+    seq_free(S);
+}
+
+void adaptive_test() {
+    seq_t S = seq_new(&counting_free);
+    struct seq_Tuning tuning = { 64, 128, 0.25, 0.05 };
+    seq_set_tuning(S, tuning);
+    model_size = 0;
+    freed = 0;
+
+    /* Appends and index reads keep it an array */
+    for (int i = 1; i <= 1000; i++) {
+        seq_push(S, ENTRY(i));
+        model_insert(model_size, i);
+    }
+    check(S);
+    assert(seq_layout(S) == SEQ_ARRAY);
+
+    /* Middle inserts take over: it converts within a window */
+    for (int i = 0; i < 64; i++) {
+        size_t index = 1 + rand() % (model_size - 1);
+        seq_insert(S, index, ENTRY(5000 + i));
+        model_insert(index, 5000 + i);
+    }
+    assert(seq_layout(S) == SEQ_CHUNKED);
+    check(S);
+
+    /* Mostly reads again: back to an array. check() itself is such a window. */
+    check(S);
+    assert(seq_layout(S) == SEQ_ARRAY);
+
+    /* Shrinking below min_size returns to an array as well */
+    seq_convert(S, SEQ_CHUNKED);
+    size_t removed = 0;
+    while (seq_size(S) > 100) {
+        seq_remove(S, seq_size(S) / 2);
+        model_remove(model_size / 2);
+        removed++;
+    }
+    for (int i = 0; i < 64; i++)
+        seq_get(S, 0);
+    assert(seq_layout(S) == SEQ_ARRAY && freed == (int)removed);
+    check(S);
+
+#ifdef DS_STATS
+    struct seq_Stats st = seq_stats(S);
+    assert(st.to_chunked == 2 && st.to_array == 2);
+    assert(st.entries_moved > 0);
+    assert(seq_stats_global().to_chunked >= 2);
+#else
+    assert(seq_stats(S).to_chunked == 0);
+#endif
+
+    /* A zero window never converts */
+    tuning.window = 0;
+    seq_set_tuning(S, tuning);
+    for (int i = 1; i <= 1000; i++)
+        seq_insert(S, 1, ENTRY(i));
+    assert(seq_layout(S) == SEQ_ARRAY);
+
+    size_t size = seq_size(S);
+    freed = 0;
+    seq_free(S);
+    assert(freed == (int)size);
+}
+
+int main() {
+    srand(49);
+    layout_test();
+    adaptive_test();
+
+    return 0;
+}
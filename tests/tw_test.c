@@ -0,0 +1,175 @@
+#include "ds/tw.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define NTIMERS 2000
+
+struct conn {
+    struct tw_Timer timer;
+    uint64_t due;       /* When the timer should fire, 0 if disarmed */
+    int fired;
+};
+
+struct conn conns[NTIMERS];
+uint64_t prev_now, target;
+size_t fired;
+
+void on_expire(void *entry, struct tw_Timer *T) {
+    struct conn *C = entry;
+
+    assert(T == &C->timer && !tw_pending(T));
+    assert(C->due != 0);
+    /* Fired by the first advance reaching its expiry */
+    assert(prev_now < C->due && C->due <= target);
+    C->due = 0;
+    C->fired++;
+    fired++;
+}
+
+/* Schedule C for expires and record when it should fire */
+void arm(tw_t W, struct conn *C, uint64_t expires) {
+    tw_reschedule(W, &C->timer, expires);
+    C->due = expires > tw_now(W) ? expires : tw_now(W) + 1;
+    C->fired = 0;
+}
+
+void advance(tw_t W, uint64_t now) {
+    size_t expect = 0;
+
+    for (size_t i = 0; i < NTIMERS; i++)
+        expect += conns[i].due != 0 && conns[i].due <= now;
+
+    prev_now = tw_now(W);
+    target = now;
+    fired = 0;
+    assert(tw_advance(W, now) == expect && fired == expect);
+    assert(tw_now(W) == now);
+
+    size_t pending = 0;
+    for (size_t i = 0; i < NTIMERS; i++) {
+        assert(tw_pending(&conns[i].timer) == (conns[i].due != 0));
+        pending += conns[i].due != 0;
+    }
+    assert(tw_size(W) == pending);
+}
+
+void basic_test() {
+    tw_t W = tw_new(100);
+    assert(tw_now(W) == 100 && tw_size(W) == 0);
+
+    for (size_t i = 0; i < NTIMERS; i++) {
+        tw_timer_init(&conns[i].timer, &on_expire, &conns[i]);
+        conns[i].due = 0;
+    }
+
+    arm(W, &conns[0], 101);
+    arm(W, &conns[1], 356);
+    arm(W, &conns[2], 70000);
+    arm(W, &conns[3], 50);          /* Already past */
+    arm(W, &conns[4], 100 + ((uint64_t)1 << 40));   /* Beyond the wheel */
+    assert(tw_size(W) == 5);
+
+    advance(W, 100);
+    advance(W, 101);
+    assert(conns[0].fired == 1 && conns[3].fired == 1);
+    advance(W, 355);
+    advance(W, 356);
+    assert(conns[1].fired == 1);
+
+    assert(tw_cancel(W, &conns[2].timer) && !tw_cancel(W, &conns[2].timer));
+    conns[2].due = 0;
+    advance(W, 80000);
+    assert(conns[2].fired == 0);
+
+    advance(W, 100 + ((uint64_t)1 << 40) - 1);
+    advance(W, 100 + ((uint64_t)1 << 40));
+    assert(conns[4].fired == 1 && tw_size(W) == 0);
+
+    tw_free(W);
+}
+
+void random_test() {
+    uint64_t start = (uint64_t)1 << 33;
+    tw_t W = tw_new(start);
+
+    for (size_t i = 0; i < NTIMERS; i++) {
+        tw_timer_init(&conns[i].timer, &on_expire, &conns[i]);
+        conns[i].due = 0;
+    }
+
+    /* Delays of every level, past times and jumps that skip levels */
+    uint64_t delays[] = { 0, 1, 255, 256, 300, 65535, 65536, 1 << 20,
+                          (uint64_t)1 << 24, (uint64_t)1 << 31, (uint64_t)1 << 33 };
+    uint64_t steps[] = { 1, 7, 256, 1000, 70000, 1 << 24, (uint64_t)1 << 32 };
+
+    for (int round = 0; round < 400; round++) {
+        for (int k = 0; k < 50; k++) {
+            struct conn *C = &conns[rand() % NTIMERS];
+            int op = rand() % 4;
+            if (op == 0) {
+                tw_cancel(W, &C->timer);
+                C->due = 0;
+            } else {
+                uint64_t d = delays[rand() % 11];
+                uint64_t e = tw_now(W) + (d ? rand() % (2 * d) : 0);
+                if (op == 1 && tw_now(W) > 10)
+                    e = tw_now(W) - rand() % 10;
+                arm(W, C, e);
+            }
+        }
+        uint64_t s = steps[rand() % 7];
+        advance(W, tw_now(W) + 1 + rand() % s);
+    }
+
+    tw_free(W);
+    for (size_t i = 0; i < NTIMERS; i++)
+        assert(!tw_pending(&conns[i].timer));
+}
+
+/* Callbacks that rearm themselves and cancel timers later in their batch */
+struct tw_Timer chain[4];
+int chain_fired[4];
+tw_t chain_wheel;
+
+void chain_fire(void *entry, struct tw_Timer *T) {
+    int i = (int)(intptr_t)entry;
+
+    chain_fired[i]++;
+    if (i == 0)
+        assert(tw_cancel(chain_wheel, &chain[1]));
+    if (i == 2 && chain_fired[2] < 3)
+        tw_schedule(chain_wheel, T, tw_now(chain_wheel));
+}
+
+void callback_test() {
+    chain_wheel = tw_new(0);
+    for (int i = 0; i < 4; i++)
+        tw_timer_init(&chain[i], &chain_fire, (void *)(intptr_t)i);
+
+    /* Slots are LIFO, so chain[0] fires first */
+    tw_schedule(chain_wheel, &chain[1], 10);
+    tw_schedule(chain_wheel, &chain[0], 10);
+    tw_schedule(chain_wheel, &chain[2], 5);
+    tw_schedule(chain_wheel, &chain[3], 30);
+
+    /* chain[2] fires at 5 and rearms in the past twice, firing at 6 and 7 */
+    assert(tw_advance(chain_wheel, 10) == 4);
+    assert(chain_fired[0] == 1 && chain_fired[1] == 0 && chain_fired[2] == 3);
+    assert(!tw_pending(&chain[1]));
+    assert(tw_advance(chain_wheel, 20) == 0);
+    assert(tw_size(chain_wheel) == 1 && tw_pending(&chain[3]));
+
+    tw_free(chain_wheel);
+    assert(!tw_pending(&chain[3]));
+}
+
+int main() {
+    srand(47);
+    basic_test();
+    random_test();
+    callback_test();
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "ds/uba.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+struct Item {
+    int key;
+    static int live;
+
+    Item(int k = 0) : key(k) { live++; }
+    ~Item() { live--; }
+};
+
+int Item::live = 0;
+
+static_assert(!std::is_copy_constructible<ds::uba<Item>>::value, "uba copies");
+static_assert(std::is_nothrow_move_constructible<ds::uba<Item>>::value, "uba moves");
+static_assert(std::is_same<std::iterator_traits<ds::uba<Item>::iterator>::iterator_category,
+                           std::random_access_iterator_tag>::value, "uba iterators");
+
+void order_test() {
+    Item items[100];
+    ds::uba<Item> U(4);
+
+    for (int i = 0; i < 100; i++) {
+        items[i].key = (i * 37) % 100;
+        U.push_back(&items[i]);
+    }
+    assert(U.size() == 100 && U.capacity() > 100);
+    assert(U[1] == &items[1] && U.back() == &items[99]);
+
+    /* Random access iteration through <algorithm> */
+    std::sort(U.begin(), U.end(), [](Item *a, Item *b) { return a->key < b->key; });
+    for (int i = 0; i < 100; i++)
+        assert(U[i]->key == i);
+    auto it = std::lower_bound(U.begin(), U.end(), 42,
+                               [](Item *e, int k) { return e->key < k; });
+    assert(it - U.begin() == 42);
+    assert(std::accumulate(U.begin(), U.end(), 0,
+                           [](int s, Item *e) { return s + e->key; }) == 4950);
+
+    /* insert and erase at iterators */
+    it = U.insert(U.begin() + 10, &items[0]);
+    assert(*it == &items[0] && U.size() == 101 && U[11]->key == 10);
+    it = U.erase(it);
+    assert((*it)->key == 10 && U.size() == 100);
+    U.pop_back();
+    U[0] = &items[0];
+    assert(U.size() == 99 && U.front() == &items[0]);
+
+    /* Moving leaves the source empty-handed, clone shares the entries */
+    ds::uba<Item> M = std::move(U);
+    assert(M.size() == 99);
+    const ds::uba<Item> C = M.clone();
+    assert(std::equal(C.begin(), C.end(), M.begin(), M.end()));
+    std::iter_swap(M.begin(), M.begin() + 1);
+    assert(M[0] == C[1] && M[1] == C[0] && C.begin()[1] == M[0]);
+    U = M.clone();
+    U.clear();
+    assert(U.empty());
+
+    U.reserve(1000);
+    assert(U.capacity() > 1000);
+}
+
+void ownership_test() {
+    {
+        ds::uba<Item, ds::delete_entry<Item>> U;
+        for (int i = 0; i < 100; i++)
+            U.push_back(new Item(i));
+        assert(Item::live == 100);
+
+        U.pop_back();
+        U.erase(U.begin());
+        assert(Item::live == 98);
+
+        ds::uba<Item, ds::delete_entry<Item>> M;
+        M = std::move(U);
+        assert(M.size() == 98 && Item::live == 98);
+    }
+    assert(Item::live == 0);
+}
+
+int main() {
+    order_test();
+    ownership_test();
+
+    return 0;
+}
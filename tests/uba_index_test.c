@@ -0,0 +1,107 @@
+#include "ds/uba_index.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define ENTRY(i) ((void *)(uintptr_t)(i))
+
+int int_cmp(void *e1, void *e2) {
+    return *(int *)e1 - *(int *)e2;
+}
+
+/* Every size up to a few full levels, so each shape of partial last level
+ * is built and searched */
+void shape_test() {
+    for (size_t n = 0; n <= 300; n++) {
+        uba_t U = uba_new(n + 1, false, NULL);
+        for (size_t i = 0; i < n; i++)
+            uba_push(U, ENTRY(10 * (i + 1)));
+
+        uba_index_t I = uba_build_index(U, NULL);
+        assert(uba_index_size(I) == n);
+
+        for (size_t key = 0; key <= 10 * n + 11; key++) {
+            size_t want = key <= 10 ? 0 : (key - 1) / 10;
+            want = want < n ? want : n;
+            assert(uba_index_rank(I, ENTRY(key)) == want);
+
+            void *e = uba_index_find(I, ENTRY(key));
+            assert(e == (key % 10 == 0 && key && key <= 10 * n ? ENTRY(key) : NULL));
+        }
+
+        uba_index_free(I);
+        uba_free(U);
+    }
+}
+
+void cmp_test() {
+    size_t n = 5000;
+    int *vals = malloc(n * sizeof(int));
+    uba_t U = uba_new(n, false, NULL);
+
+    /* Ascending, with duplicates: rank finds the first of them */
+    for (size_t i = 0; i < n; i++) {
+        vals[i] = (int)(i / 3) * 2;
+        uba_push(U, &vals[i]);
+    }
+
+    uba_index_t I = uba_build_index(U, &int_cmp);
+    uba_free(U);    /* The index keeps its own copy of the order */
+
+    for (int key = -1; key <= (int)(n / 3) * 2 + 2; key++) {
+        size_t want = key < 0 ? 0 : (size_t)(key + 1) / 2 * 3;
+        want = want < n ? want : n;
+        assert(uba_index_rank(I, &key) == want);
+
+        int *e = uba_index_find(I, &key);
+        if (key >= 0 && key % 2 == 0 && want < n)
+            assert(e == &vals[want]);
+        else
+            assert(e == NULL);
+    }
+
+    uba_index_free(I);
+    free(vals);
+}
+
+void batch_test() {
+    size_t n = 100000, nkeys = 1001;
+    uba_t U = uba_new(n, false, NULL);
+    uintptr_t v = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        v += 1 + rand() % 8;
+        uba_push(U, ENTRY(v));
+    }
+    uba_index_t I = uba_build_index(U, NULL);
+
+    void **keys = malloc(nkeys * sizeof(void *));
+    size_t *ranks = malloc(nkeys * sizeof(size_t));
+    for (size_t i = 0; i < nkeys; i++)
+        keys[i] = ENTRY(rand() % (v + 10));
+
+    uba_index_rank_n(I, keys, ranks, nkeys);
+    for (size_t i = 0; i < nkeys; i++) {
+        size_t r = ranks[i];
+        assert(r == uba_index_rank(I, keys[i]));
+        assert(r == n || (uintptr_t)uba_get(U, r) >= (uintptr_t)keys[i]);
+        assert(r == 0 || (uintptr_t)uba_get(U, r - 1) < (uintptr_t)keys[i]);
+    }
+
+    uba_index_rank_n(I, keys, ranks, 0);
+
+    free(keys);
+    free(ranks);
+    uba_index_free(I);
+    uba_free(U);
+}
+
+int main() {
+    srand(48);
+    shape_test();
+    cmp_test();
+    batch_test();
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "ds/uba_par.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define N 50000
+
+static int vals[N];
+
+struct sum {
+    long total;
+    size_t count;
+};
+
+void visit(void *entry, size_t index, void *context) {
+    atomic_int *seen = context;
+    assert(*(int *)entry == vals[index]);
+    atomic_fetch_add(&seen[index], 1);
+}
+
+void *twice(void *entry, void *context) {
+    (void)context;
+    int *tmp = malloc(sizeof(int));
+    *tmp = 2 * *(int *)entry;
+    return tmp;
+}
+
+void *bump(void *entry, void *context) {
+    *(int *)entry += *(int *)context;
+    return entry;
+}
+
+void fold(void *acc, void *entry, void *context) {
+    (void)context;
+    ((struct sum *)acc)->total += *(int *)entry;
+    ((struct sum *)acc)->count++;
+}
+
+void combine(void *acc, void *other, void *context) {
+    (void)context;
+    ((struct sum *)acc)->total += ((struct sum *)other)->total;
+    ((struct sum *)acc)->count += ((struct sum *)other)->count;
+}
+
+/* Track the last index seen: chunks must fold consecutive entries and be
+ * combined in index order */
+void fold_order(void *acc, void *entry, void *context) {
+    (void)context;
+    uintptr_t *last = acc;
+    assert(*last == UINTPTR_MAX || *last + 1 == (uintptr_t)entry);
+    *last = (uintptr_t)entry;
+}
+
+void combine_order(void *acc, void *other, void *context) {
+    (void)context;
+    uintptr_t *a = acc, *b = other;
+    assert(*b == UINTPTR_MAX || *a == UINTPTR_MAX || *a < *b);
+    if (*b != UINTPTR_MAX)
+        *a = *b;
+}
+
+bool is_even(void *entry, void *context) {
+    (void)context;
+    return *(int *)entry % 2 == 0;
+}
+
+void entry_free(void *entry) {
+    free(entry);
+}
+
+void algorithms_test(pool_t P, size_t n) {
+    uba_t U = uba_new(n, false, NULL);
+    for (size_t i = 0; i < n; i++) {
+        vals[i] = rand() % 1000;
+        uba_push(U, &vals[i]);
+    }
+
+    atomic_int *seen = calloc(n + 1, sizeof(*seen));
+    uba_foreach_parallel(P, U, &visit, seen);
+    for (size_t i = 0; i < n; i++)
+        assert(atomic_load(&seen[i]) == 1);
+    free(seen);
+
+    uba_t D = uba_map_new_parallel(P, U, &twice, NULL, &entry_free);
+    assert(uba_size(D) == n);
+    for (size_t i = 0; i < n; i++)
+        assert(*(int *)uba_get(D, i) == 2 * vals[i]);
+    uba_free(D);
+
+    long expect = 0;
+    for (size_t i = 0; i < n; i++)
+        expect += vals[i] + 3;
+    int delta = 3;
+    uba_map_parallel(P, U, &bump, &delta);
+
+    struct sum s = { 0, 0 };
+    uba_reduce_parallel(P, U, &s, sizeof(s), &fold, &combine, NULL);
+    assert(s.total == expect && s.count == n);
+
+    uba_t E = uba_filter_parallel(P, U, &is_even, NULL, NULL);
+    size_t j = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (vals[i] % 2 == 0)
+            assert(uba_get(E, j++) == &vals[i]);
+    }
+    assert(uba_size(E) == j);
+    uba_free(E);
+
+    uba_free(U);
+}
+
+void order_test(pool_t P) {
+    uba_t U = uba_new(N, false, NULL);
+    for (uintptr_t i = 0; i < N; i++)
+        uba_push(U, (void *)i);
+
+    uintptr_t last = UINTPTR_MAX;
+    uba_reduce_parallel(P, U, &last, sizeof(last), &fold_order, &combine_order, NULL);
+    assert(last == N - 1);
+
+    uba_free(U);
+}
+
+int main() {
+    srand(4);
+    for (size_t threads = 1; threads <= 4; threads *= 2) {
+        pool_t P = pool_new(threads);
+        printf("algorithms test, %zu threads\n", threads);
+        algorithms_test(P, N);
+        algorithms_test(P, 1);
+        algorithms_test(P, 0);
+        order_test(P);
+        pool_free(P);
+    }
+
+    puts("default pool test");
+    algorithms_test(NULL, N);
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "ds/uba_set.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define ENTRY(i) ((void *)(uintptr_t)(i))
+#define RANGE 4096
+
+int int_cmp(void *e1, void *e2) {
+    return *(int *)e1 - *(int *)e2;
+}
+
+/* Fill U with the members of in, ascending, as integers or as pointers into
+ * ints (which must hold RANGE slots) */
+void fill(uba_t U, bool *in, int *ints) {
+    for (int v = 0; v < RANGE; v++) {
+        if (!in[v])
+            continue;
+        if (ints) {
+            ints[v] = v;
+            uba_push(U, &ints[v]);
+        } else {
+            uba_push(U, ENTRY(v));
+        }
+    }
+}
+
+/* Assert that R holds exactly the members of want */
+void check(uba_t R, bool *want, bool ints) {
+    size_t k = 0;
+
+    for (int v = 0; v < RANGE; v++) {
+        if (!want[v])
+            continue;
+        assert(k < uba_size(R));
+        void *e = uba_get(R, k++);
+        assert(ints ? *(int *)e == v : e == ENTRY(v));
+    }
+    assert(k == uba_size(R));
+}
+
+/* Random sets of about na and nb members of [0, RANGE) */
+void one_case(size_t na, size_t nb, bool ints) {
+    bool in_a[RANGE] = { 0 }, in_b[RANGE] = { 0 }, want[RANGE];
+    int *va = ints ? malloc(RANGE * sizeof(int)) : NULL;
+    int *vb = ints ? malloc(RANGE * sizeof(int)) : NULL;
+    uba_cmp_fn *cmp = ints ? &int_cmp : NULL;
+
+    for (size_t i = 0; i < na; i++)
+        in_a[rand() % RANGE] = true;
+    for (size_t i = 0; i < nb; i++)
+        in_b[rand() % RANGE] = true;
+
+    uba_t A = uba_new(8, false, NULL);
+    uba_t B = uba_new(8, false, NULL);
+    fill(A, in_a, va);
+    fill(B, in_b, vb);
+
+    for (int v = 0; v < RANGE; v++)
+        want[v] = in_a[v] || in_b[v];
+    uba_t R = uba_new(1, false, NULL);
+    uba_union(R, A, B, cmp);
+    check(R, want, ints);
+
+    for (int v = 0; v < RANGE; v++)
+        want[v] = in_a[v] && in_b[v];
+    uba_t I = uba_new(1, false, NULL);
+    uba_intersect(I, A, B, cmp);
+    check(I, want, ints);
+    uba_free(I);
+
+    /* A preallocated R is written in place */
+    for (int v = 0; v < RANGE; v++)
+        want[v] = in_a[v] && !in_b[v];
+    uba_t D = uba_new(uba_size(A) + 1, false, NULL);
+    void *data = uba_data(D);
+    uba_difference(D, A, B, cmp);
+    check(D, want, ints);
+    assert(uba_data(D) == data);
+    uba_free(D);
+
+    /* merge keeps every entry, A's first among equals */
+    uba_t M = uba_new(1, false, NULL);
+    uba_merge(M, A, B, cmp);
+    assert(uba_size(M) == uba_size(A) + uba_size(B));
+    size_t k = 0;
+    for (int v = 0; v < RANGE; v++) {
+        if (in_a[v]) {
+            void *e = uba_get(M, k++);
+            assert(ints ? e == &va[v] : e == ENTRY(v));
+        }
+        if (in_b[v]) {
+            void *e = uba_get(M, k++);
+            assert(ints ? e == &vb[v] : e == ENTRY(v));
+        }
+    }
+
+    /* union and intersect take A's entry when both have it */
+    if (ints) {
+        for (size_t i = 0; i < uba_size(R); i++) {
+            int v = *(int *)uba_get(R, i);
+            if (in_a[v])
+                assert(uba_get(R, i) == &va[v]);
+        }
+    }
+
+    uba_free(M);
+    uba_free(R);
+    uba_free(A);
+    uba_free(B);
+    free(va);
+    free(vb);
+}
+
+void append_test() {
+    uba_t A = uba_new(4, false, NULL);
+    uba_t B = uba_new(4, false, NULL);
+    uba_t R = uba_new(4, false, NULL);
+
+    for (int i = 1; i <= 5; i++)
+        uba_push(A, ENTRY(i * 2));
+    for (int i = 1; i <= 5; i++)
+        uba_push(B, ENTRY(i * 3));
+
+    uba_push(R, ENTRY(99));
+    uba_intersect(R, A, B, NULL);
+    assert(uba_size(R) == 2);
+    assert(uba_get(R, 0) == ENTRY(99) && uba_get(R, 1) == ENTRY(6));
+
+    uba_difference(R, A, B, NULL);
+    void *diff[] = { ENTRY(2), ENTRY(4), ENTRY(8), ENTRY(10) };
+    assert(uba_size(R) == 6);
+    for (size_t i = 0; i < 4; i++)
+        assert(uba_get(R, 2 + i) == diff[i]);
+
+    /* Empty inputs */
+    uba_t E = uba_new(1, false, NULL);
+    uba_union(R, E, A, NULL);
+    assert(uba_size(R) == 11);
+    uba_intersect(R, A, E, NULL);
+    uba_difference(R, E, A, NULL);
+    assert(uba_size(R) == 11);
+
+    uba_free(E);
+    uba_free(A);
+    uba_free(B);
+    uba_free(R);
+}
+
+int main() {
+    srand(46);
+    append_test();
+
+    /* Balanced sizes take the linear (and for integers the SIMD) path,
+     * skewed ones the galloping path on either side */
+    size_t sizes[][2] = {
+        { 0, 0 }, { 1, 1 }, { 3, 5 }, { 100, 100 }, { 2000, 2000 },
+        { 3000, 1000 }, { 4000, 4000 }, { 10, 3000 }, { 3000, 10 },
+        { 1, 4000 }, { 4000, 1 }, { 200, 4000 }, { 4000, 200 },
+    };
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (int rep = 0; rep < 4; rep++) {
+            one_case(sizes[i][0], sizes[i][1], false);
+            one_case(sizes[i][0], sizes[i][1], true);
+        }
+    }
+
+    return 0;
+}
@@ -1,7 +1,11 @@
 #include "ds/uba.h"
+#include "ds/reclaim.h"
+#include <stdatomic.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <signal.h>
+#include <sys/resource.h>
 
 void *mkint(int num) {
     void *tmp = malloc (sizeof(int));
@@ -151,10 +155,271 @@ void low_mutation_test() {
     return;
 }
 
+size_t int_serialize(void *entry, void *buf, size_t len) {
+    if (len >= sizeof(int))
+        *(int *)buf = *(int *)entry;
+    return sizeof(int);
+}
+
+void *int_deserialize(void *payload, size_t len) {
+    assert(len == sizeof(int));
+    return payload;
+}
+
+void persistence_test() {
+    uba_t u = uba_new(0, false, &entry_free_fn);
+    for (int i = 0; i < 100; i++)
+        uba_push(u, mkint(i));
+
+    assert(uba_save(u, "uba_test.bin", &int_serialize) == 0);
+    uba_free(u);
+
+    u = uba_load("uba_test.bin", &int_deserialize, NULL);
+    assert(u != NULL && uba_size(u) == 100);
+    for (int i = 0; i < 100; i++)
+        assert(*(int *)uba_get(u, i) == i);
+
+    /* Loaded ubas stay mutable */
+    uba_push(u, uba_get(u, 0));
+    assert(uba_size(u) == 101);
+    uba_free(u);
+
+    /* Corrupt a payload and expect the checksum to catch it */
+    FILE *f = fopen("uba_test.bin", "r+b");
+    fseek(f, -4, SEEK_END);
+    fputc(0x7f, f);
+    fclose(f);
+    assert(uba_load("uba_test.bin", &int_deserialize, NULL) == NULL);
+
+    /* And a bad count in the header */
+    f = fopen("uba_test.bin", "r+b");
+    fseek(f, -4, SEEK_END);
+    fputc(0, f);
+    fseek(f, 8, SEEK_SET);
+    fputc(99, f);
+    fclose(f);
+    assert(uba_load("uba_test.bin", &int_deserialize, NULL) == NULL);
+
+    remove("uba_test.bin");
+    assert(uba_load("uba_test.bin", &int_deserialize, NULL) == NULL);
+}
+
+void mapped_test() {
+    uba_t u = uba_new_mapped("uba_mapped.bin", 0, false, NULL);
+    assert(u != NULL && uba_mapped(u) && uba_size(u) == 0);
+    uba_advise(u, UBA_ADVICE_SEQUENTIAL);
+
+    for (size_t i = 0; i < 10000; i++)
+        uba_push(u, (void *)(i + 1));
+    assert(uba_size(u) == 10000 && uba_limit(u) == 16384);
+
+    uba_insert(u, 0, (void *)0);
+    uba_remove(u, 1);
+    uba_update(u, 0, (void *)1);
+    uba_advise(u, UBA_ADVICE_RANDOM);
+    for (size_t i = 0; i < 10000; i++)
+        assert(uba_get(u, i) == (void *)(i + 1));
+
+    assert(uba_sync(u) == 0);
+    FILE *f = fopen("uba_mapped.bin", "rb");
+    fseek(f, 0, SEEK_END);
+    assert(ftell(f) == (long)(sizeof(void *) * uba_limit(u)));
+    fclose(f);
+
+    assert(uba_shrink(u) == 0);
+    assert(uba_limit(u) == 10001 && uba_get(u, 9999) == (void *)10000);
+
+    /* A file that cannot grow fails the push and leaves the uba as it was */
+    struct rlimit old, lim;
+    getrlimit(RLIMIT_FSIZE, &old);
+    lim = old;
+    lim.rlim_cur = sizeof(void *) * uba_limit(u);
+    signal(SIGXFSZ, SIG_IGN);
+    setrlimit(RLIMIT_FSIZE, &lim);
+    assert(uba_push(u, (void *)10001) == 1);
+    assert(uba_insert(u, 0, (void *)10001) == 1);
+    assert(uba_size(u) == 10000 && uba_limit(u) == 10001);
+    assert(uba_get(u, 0) == (void *)1 && uba_get(u, 9999) == (void *)10000);
+    setrlimit(RLIMIT_FSIZE, &old);
+    signal(SIGXFSZ, SIG_DFL);
+    assert(uba_push(u, (void *)10001) == 0 && uba_size(u) == 10001);
+
+    uba_free(u);
+    remove("uba_mapped.bin");
+    assert(uba_new_mapped("/nonexistent/dir/uba.bin", 0, false, NULL) == NULL);
+}
+
+void snapshot_test() {
+    uba_t u = uba_new_paged(0, false, NULL);
+    assert(uba_paged(u) && uba_size(u) == 0);
+
+    for (size_t i = 0; i < 2000; i++)
+        uba_push(u, (void *)i);
+
+    uba_snap_t s1 = uba_snapshot(u);
+    assert(uba_snap_size(s1) == 2000);
+
+    uba_update(u, 5, (void *)5000);
+    uba_push(u, (void *)2000);
+    uba_remove(u, 0);
+
+    uba_snap_t s2 = uba_snapshot(u);
+    uba_update(u, 1999, (void *)7000);
+    uba_insert(u, 0, (void *)0);
+
+    for (size_t i = 0; i < 2000; i++)
+        assert(uba_snap_get(s1, i) == (void *)i);
+    uba_snap_release(s1);
+
+    assert(uba_snap_size(s2) == 2000);
+    assert(uba_snap_get(s2, 4) == (void *)5000);
+    assert(uba_snap_get(s2, 1999) == (void *)2000);
+
+    assert(uba_get(u, 0) == (void *)0 && uba_get(u, 5) == (void *)5000);
+    assert(uba_get(u, 2000) == (void *)7000);
+
+    /* Snapshots may outlive the uba */
+    uba_free(u);
+    assert(uba_snap_get(s2, 0) == (void *)1);
+    uba_snap_release(s2);
+
+    u = uba_new_paged(0, false, &entry_free_fn);
+    uba_push(u, mkint(1));
+    uba_push(u, mkint(2));
+    uba_snap_t s3 = uba_snapshot(u);
+    uba_pop(u);
+    assert(uba_size(u) == 1 && *(int *)uba_snap_get(s3, 0) == 1);
+    uba_snap_release(s3);
+    uba_free(u);
+
+    /* Entries replaced or removed under a snapshot stay readable through it,
+     * whichever order the snapshots and the uba go away in */
+    u = uba_new_paged(0, false, &entry_free_fn);
+    for (int i = 0; i < 1000; i++)
+        uba_push(u, mkint(i));
+    s1 = uba_snapshot(u);
+    for (int i = 0; i < 1000; i++)
+        uba_update(u, i, mkint(-i));
+    s2 = uba_snapshot(u);
+    while (uba_size(u) > 500)
+        uba_pop(u);
+    uba_remove(u, 0);
+    uba_update(u, 1, mkint(7));
+    s3 = uba_snapshot(u);
+    uba_free(u);
+
+    for (int i = 0; i < 1000; i++) {
+        assert(*(int *)uba_snap_get(s1, i) == i);
+        assert(*(int *)uba_snap_get(s2, i) == -i);
+    }
+    uba_snap_release(s2);
+    for (int i = 0; i < 1000; i++)
+        assert(*(int *)uba_snap_get(s1, i) == i);
+    assert(*(int *)uba_snap_get(s3, 0) == -1 && *(int *)uba_snap_get(s3, 1) == 7);
+    uba_snap_release(s1);
+    assert(*(int *)uba_snap_get(s3, 498) == -499);
+    uba_snap_release(s3);
+}
+
+void stats_test() {
+#ifdef DS_STATS
+    uba_t u = uba_new(1, false, &entry_free_fn);
+    struct uba_Stats s = uba_stats(u);
+    assert(s.allocs == 2 && s.resizes == 0);
+
+    for (int i = 0; i < 4; i++)
+        uba_push(u, mkint(i));
+
+    s = uba_stats(u);
+    assert(s.resizes == 3 && s.allocs == 5);
+    assert(s.bytes_copied == sizeof(void *) * (1 + 2 + 4));
+    assert(s.bytes == sizeof(struct uba_Header) + sizeof(void *) * 8);
+
+    uba_stats_dump(stdout);
+    uba_free(u);
+#endif
+}
+
+static atomic_size_t freed;
+
+void counting_free(void *entry) {
+    atomic_fetch_add(&freed, 1);
+    free(entry);
+}
+
+void deferred_free_test() {
+    uba_t U = uba_new(0, false, &counting_free);
+    for (int i = 0; i < 1000; i++)
+        uba_push(U, mkint(i));
+
+    /* Bounded steps free from the back and finally U itself */
+    int steps = 0;
+    while (!uba_free_step(U, 64)) {
+        steps++;
+        assert(atomic_load(&freed) == (size_t)steps * 64);
+        assert(uba_size(U) == 1000 - (size_t)steps * 64);
+    }
+    assert(steps == 1000 / 64 && atomic_load(&freed) == 1000);
+
+    /* Raw ubas own no entries */
+    U = uba_new(10, true, &counting_free);
+    assert(uba_free_step(U, 1));
+
+    atomic_store(&freed, 0);
+    for (int round = 0; round < 4; round++) {
+        U = uba_new(0, false, &counting_free);
+        for (int i = 0; i < 10000; i++)
+            uba_push(U, mkint(i));
+        uba_free_async(U);
+    }
+    reclaim_drain();
+    assert(atomic_load(&freed) == 40000);
+}
+
+void ownership_test() {
+    atomic_store(&freed, 0);
+    uba_t A = uba_new(0, false, &counting_free);
+    uba_t B = uba_new(0, false, &counting_free);
+    for (int i = 0; i < 10; i++)
+        uba_push(A, mkint(i));
+
+    /* Moving entries between ubas frees nothing */
+    uba_push(B, uba_pop_take(A));
+    uba_push(B, uba_take(A, 0));
+    uba_push(B, uba_take(A, 3));
+    assert(atomic_load(&freed) == 0);
+    assert(uba_size(A) == 7 && uba_size(B) == 3);
+    assert(*(int *)uba_get(B, 0) == 9 && *(int *)uba_get(B, 1) == 0
+            && *(int *)uba_get(B, 2) == 4);
+    int rest[] = {1, 2, 3, 5, 6, 7, 8};
+    for (int i = 0; i < 7; i++)
+        assert(*(int *)uba_get(A, i) == rest[i]);
+
+    uba_swap(A, B);
+    assert(uba_size(A) == 3 && uba_size(B) == 7);
+    assert(*(int *)uba_get(A, 0) == 9 && *(int *)uba_get(B, 0) == 1);
+
+    size_t n;
+    void **data = uba_steal_buffer(B, &n);
+    assert(n == 7 && *(int *)data[6] == 8 && atomic_load(&freed) == 0);
+    for (size_t i = 0; i < n; i++)
+        free(data[i]);
+    free(data);
+
+    uba_free(A);
+    assert(atomic_load(&freed) == 3);
+}
+
 int main() {
     lifespan_test();
     high_mutation_test();
     low_mutation_test();
+    persistence_test();
+    mapped_test();
+    snapshot_test();
+    stats_test();
+    deferred_free_test();
+    ownership_test();
 
     return 0;
 }